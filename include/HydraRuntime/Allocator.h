@@ -0,0 +1,120 @@
+#pragma once
+
+#include <HydraRuntime/Core.h>
+
+#include <type_traits>
+
+namespace Hydra
+{
+  namespace Runtime
+  {
+    /// \brief Makes 'allocator' the current allocator of the calling thread until the scope ends. Scopes can be nested.
+    ///
+    /// Everything that allocates through Core on this thread in the meantime uses this allocator,
+    /// so this is typically used together with an ArenaAllocator for short-lived, per-thread data.
+    class ScopedThreadAllocator
+    {
+    public:
+      ScopedThreadAllocator(IAllocator* allocator);
+      ~ScopedThreadAllocator();
+
+      ScopedThreadAllocator(const ScopedThreadAllocator&) = delete;
+      void operator=(const ScopedThreadAllocator&) = delete;
+
+    private:
+      IAllocator* m_previousAllocator = nullptr;
+    };
+
+    /// \brief Hands out memory from large chunks by bumping a pointer. Individual deallocations are ignored, all memory is released at once by Reset().
+    ///
+    /// Meant to be used per thread (it is not thread-safe) and per frame, e.g. with a ScopedThreadAllocator around the work of one frame and a Reset() afterwards.
+    class ArenaAllocator : public IAllocator
+    {
+    public:
+      /// \brief The chunks are allocated from 'parentAllocator', or from the allocator that is current at construction time if it is nullptr.
+      ArenaAllocator(size_t chunkSize = 64 * 1024, IAllocator* parentAllocator = nullptr);
+      ~ArenaAllocator();
+
+      ArenaAllocator(const ArenaAllocator&) = delete;
+      void operator=(const ArenaAllocator&) = delete;
+
+      virtual void* Allocate(size_t numBytes, size_t alignment) override;
+      virtual void Deallocate(void* ptr, size_t numBytes, size_t alignment) override;
+
+      /// \brief Invalidates all allocations. The chunks are kept and reused by later allocations.
+      void Reset();
+
+      /// \brief Returns how many bytes were handed out since the last Reset(), including alignment padding.
+      size_t GetNumUsedBytes() const { return m_numUsedBytes; }
+
+      /// \brief Returns how many bytes the chunks occupy in the parent allocator.
+      size_t GetNumReservedBytes() const { return m_numReservedBytes; }
+
+    private:
+      struct Chunk
+      {
+        Chunk* m_next = nullptr;
+        size_t m_size = 0;
+      };
+
+      IAllocator* m_parentAllocator = nullptr;
+      size_t m_chunkSize = 0;
+      Chunk* m_firstChunk = nullptr;
+      Chunk* m_currentChunk = nullptr;
+      size_t m_currentOffset = 0;
+      size_t m_numUsedBytes = 0;
+      size_t m_numReservedBytes = 0;
+    };
+
+    /// \brief Allocator for STL containers that allocates through Core and accounts the memory to 'Tag'.
+    ///
+    /// The allocator that is current at construction time is remembered, so containers can safely outlive a ScopedThreadAllocator.
+    template <typename T, MemoryTag Tag = MemoryTag::Other>
+    class StlAllocator
+    {
+    public:
+      using value_type = T;
+
+      template <typename U>
+      struct rebind
+      {
+        using other = StlAllocator<U, Tag>;
+      };
+
+      StlAllocator()
+        : m_allocator(Core::GetAllocator())
+      {
+      }
+
+      template <typename U>
+      StlAllocator(const StlAllocator<U, Tag>& other)
+        : m_allocator(other.m_allocator)
+      {
+      }
+
+      T* allocate(size_t count)
+      {
+        MemoryTracking::OnAllocate(Tag, count * sizeof(T));
+        return static_cast<T*>(m_allocator->Allocate(count * sizeof(T), alignof(T)));
+      }
+
+      void deallocate(T* ptr, size_t count)
+      {
+        MemoryTracking::OnDeallocate(Tag, count * sizeof(T));
+        m_allocator->Deallocate(ptr, count * sizeof(T), alignof(T));
+      }
+
+      template <typename U>
+      bool operator==(const StlAllocator<U, Tag>& other) const
+      {
+        return m_allocator == other.m_allocator;
+      }
+
+    private:
+      template <typename U, MemoryTag OtherTag>
+      friend class StlAllocator;
+
+      IAllocator* m_allocator = nullptr;
+    };
+  } // namespace Runtime
+} // namespace Hydra
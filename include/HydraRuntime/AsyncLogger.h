@@ -0,0 +1,92 @@
+#pragma once
+
+#include <HydraRuntime/Logger.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace Hydra
+{
+  namespace Runtime
+  {
+    /// \brief A logger that queues messages in a bounded lock-free ring buffer and forwards them to another logger on a background thread.
+    ///
+    /// Messages logged through Log are not formatted by the calling thread. Only the format string pointer and a copy of the arguments
+    /// (including the contents of %s strings) are queued and the formatting happens on the background thread.
+    /// Therefore format strings must be string literals, or otherwise outlive the AsyncLogger.
+    ///
+    /// When the queue is full, messages are dropped instead of blocking the caller. See GetNumDroppedMessages().
+    /// The target logger is only ever called from the background thread, so it doesn't need to be thread-safe.
+    class AsyncLogger : public ILoggingInterface
+    {
+    public:
+      enum
+      {
+        MAX_MESSAGE_LENGTH = 1024, // the same limit as for messages formatted by Log
+      };
+
+      /// \brief 'capacity' is the maximum number of queued messages and is rounded up to a power of two.
+      AsyncLogger(ILoggingInterface* target, uint32_t capacity = 1024);
+
+      /// \brief Forwards all queued messages and stops the background thread.
+      ~AsyncLogger();
+
+      AsyncLogger(const AsyncLogger&) = delete;
+      void operator=(const AsyncLogger&) = delete;
+
+      virtual void LogInfo(const char* message) override;
+      virtual void LogWarning(const char* message) override;
+      virtual void LogError(const char* message) override;
+      virtual bool LogDeferred(LogLevel level, const char* formatStr, va_list args) override;
+
+      /// \brief The level of the target at construction, so that messages it would drop aren't queued in the first place.
+      ///
+      /// The level is read once, to not call the target from other threads. The background thread still filters by the current level.
+      virtual LogLevel GetLogLevel() const override;
+
+      /// \brief Blocks until all messages that were queued before the call have been forwarded.
+      void Flush();
+
+      /// \brief Returns how many messages were dropped, because the queue was full.
+      uint64_t GetNumDroppedMessages() const { return m_numDroppedMessages.load(std::memory_order_relaxed); }
+
+    private:
+      enum
+      {
+        PAYLOAD_SIZE = 480,
+      };
+
+      struct Message
+      {
+        std::atomic<uint64_t> m_sequence = 0;
+        LogLevel m_level = LogLevel::Info;
+        bool m_isFormatted = false; // whether m_payload already is the final text
+        uint16_t m_payloadSize = 0;
+        const char* m_formatStr = nullptr;
+        alignas(8) uint8_t m_payload[PAYLOAD_SIZE];
+      };
+
+      Message* BeginEnqueue();
+      void EndEnqueue(Message* message);
+      void EnqueueText(LogLevel level, const char* text);
+
+      void ConsumerThread();
+      void ForwardMessage(const Message& message);
+
+      ILoggingInterface* m_target = nullptr;
+      const LogLevel m_targetLogLevel = LogLevel::None;
+
+      std::unique_ptr<Message[]> m_messages;
+      uint64_t m_capacityMask = 0;
+
+      alignas(64) std::atomic<uint64_t> m_enqueuePosition = 0;
+      alignas(64) std::atomic<uint64_t> m_dequeuePosition = 0;
+      std::atomic<uint64_t> m_numQueuedMessages = 0;
+      std::atomic<uint64_t> m_numDroppedMessages = 0;
+      std::atomic<bool> m_stop = false;
+
+      std::thread m_thread;
+    };
+  } // namespace Runtime
+} // namespace Hydra
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <bit>
 #include <cassert>
+#include <cstring>
 
 namespace Hydra
 {
@@ -75,7 +76,7 @@ namespace Hydra
 
     private:
       static BlockType* AllocateBlocks(uint32_t numBlocks);
-      static void DeallocateBlocks(BlockType* blocks);
+      static void DeallocateBlocks(BlockType* blocks, uint32_t numBlocks);
       static void CopyBlocks(BlockType* dest, const BlockType* src, uint32_t numBlocks);
       static void ClearBlocks(BlockType* blocks, uint32_t numBlocks);
 
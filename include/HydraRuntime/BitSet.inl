@@ -101,15 +101,28 @@ namespace Hydra::Runtime
   // static
   inline BitSet::BlockType* BitSet::AllocateBlocks(uint32_t numBlocks)
   {
-    BlockType* blocks = (BlockType*)Core::Allocate(numBlocks * sizeof(BlockType));
-    ClearBlocks(blocks, numBlocks);
-    return blocks;
+    // the first block stores the allocator, so that the memory is returned to it, even if the current allocator changed in the meantime
+    static_assert(sizeof(IAllocator*) <= sizeof(BlockType));
+
+    MemoryTracking::OnAllocate(MemoryTag::BitSet, (numBlocks + 1) * sizeof(BlockType));
+
+    IAllocator* allocator = Core::GetAllocator();
+    BlockType* blocks = (BlockType*)allocator->Allocate((numBlocks + 1) * sizeof(BlockType), alignof(BlockType));
+    memcpy(blocks, &allocator, sizeof(IAllocator*));
+
+    ClearBlocks(blocks + 1, numBlocks);
+    return blocks + 1;
   }
 
   // static
-  inline void BitSet::DeallocateBlocks(BlockType* blocks)
+  inline void BitSet::DeallocateBlocks(BlockType* blocks, uint32_t numBlocks)
   {
-    Core::Deallocate(blocks);
+    IAllocator* allocator = nullptr;
+    memcpy(&allocator, blocks - 1, sizeof(IAllocator*));
+
+    MemoryTracking::OnDeallocate(MemoryTag::BitSet, (numBlocks + 1) * sizeof(BlockType));
+
+    allocator->Deallocate(blocks - 1, (numBlocks + 1) * sizeof(BlockType), alignof(BlockType));
   }
 
   // static
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <HydraRuntime/MemoryTracking.h>
+
+#include <atomic>
 #include <cstddef>
 #include <stdint.h>
 
@@ -7,24 +10,84 @@ namespace Hydra
 {
   namespace Runtime
   {
+    /// \brief Interface for custom memory allocators. See Core::SetAllocator() and ScopedThreadAllocator.
+    ///
+    /// Deallocate() always receives the same size and alignment that were passed to Allocate().
+    class IAllocator
+    {
+    public:
+      virtual ~IAllocator() = default;
+
+      virtual void* Allocate(size_t numBytes, size_t alignment) = 0;
+      virtual void Deallocate(void* ptr, size_t numBytes, size_t alignment) = 0;
+    };
+
     class Core
     {
     public:
       using AllocateFunc = void* (*)(size_t numBytes);
       using DeallocateFunc = void (*)(void* ptr);
       using HashFunc = uint32_t (*)(const void* ptr, size_t numBytes);
+      using Hash64Func = uint64_t (*)(const void* ptr, size_t numBytes, uint64_t seed);
+
+      static constexpr size_t DEFAULT_ALIGNMENT = alignof(std::max_align_t);
+
+      /// \brief Allocates through GetAllocator() and accounts the memory to 'tag'. The memory has to be freed while the same allocator is still the current one.
+      static void* Allocate(size_t numBytes, size_t alignment = DEFAULT_ALIGNMENT, MemoryTag tag = MemoryTag::Other)
+      {
+        MemoryTracking::OnAllocate(tag, numBytes);
+        return GetAllocator()->Allocate(numBytes, alignment);
+      }
+
+      static void Deallocate(void* ptr, size_t numBytes, size_t alignment = DEFAULT_ALIGNMENT, MemoryTag tag = MemoryTag::Other)
+      {
+        MemoryTracking::OnDeallocate(tag, numBytes);
+        GetAllocator()->Deallocate(ptr, numBytes, alignment);
+      }
 
-      static void* Allocate(size_t numBytes) { return s_allocateFunc(numBytes); }
-      static void Deallocate(void* ptr) { s_deallocateFunc(ptr); }
-      static uint32_t Hash(const void* ptr, size_t numBytes) { return s_hashFunc(ptr, numBytes); }
+      /// \brief Hashes the data with the current HashFunc. Used for all selection and set hashes.
+      static uint32_t Hash(const void* ptr, size_t numBytes) { return s_hashFunc.load(std::memory_order_relaxed)(ptr, numBytes); }
 
+      /// \brief Hashes the data with the current Hash64Func. Different seeds give independent hashes of the same data.
+      static uint64_t Hash64(const void* ptr, size_t numBytes, uint64_t seed = 0) { return s_hash64Func.load(std::memory_order_relaxed)(ptr, numBytes, seed); }
+
+      /// \brief The default 64 bit hash, processing 16 bytes per step (48 for longer inputs).
+      static uint64_t DefaultHash64(const void* ptr, size_t numBytes, uint64_t seed);
+
+      /// \brief The default 32 bit hash, DefaultHash64() with seed 0, folded to 32 bits.
+      static uint32_t DefaultHash(const void* ptr, size_t numBytes);
+
+      /// \brief MurmurHash3_x86_32, which was the default hash before. Can be passed to SetCustomFunctions() to keep hashes stable.
+      static uint32_t MurmurHash3(const void* ptr, size_t numBytes);
+
+      /// \brief Returns the allocator of the current thread (see ScopedThreadAllocator) or, if there is none, the global allocator.
+      ///
+      /// Objects that may outlive a thread allocator, such as BitSet and StlAllocator, remember which allocator they got their memory from.
+      static IAllocator* GetAllocator();
+
+      /// \brief Replaces the global allocator for all threads. Passing nullptr restores the default allocator.
+      ///
+      /// The allocator has to stay alive as long as memory allocated through it exists.
+      static void SetAllocator(IAllocator* allocator);
+
+      /// \brief Restores the default allocator and hash function.
       static void SetDefaultFunctions();
+
+      /// \brief Uses the given functions for allocations and hashing. Passing nullptr for a function keeps its default.
+      ///
+      /// Allocations with a larger alignment than DEFAULT_ALIGNMENT are padded, since the functions don't support alignment.
       static void SetCustomFunctions(AllocateFunc allocateFunc, DeallocateFunc deallocateFunc, HashFunc hashFunc);
 
+      /// \brief Replaces the function behind Hash64(). Passing nullptr restores DefaultHash64().
+      static void SetCustomHash64Function(Hash64Func hash64Func);
+
     private:
-      static AllocateFunc s_allocateFunc;
-      static DeallocateFunc s_deallocateFunc;
-      static HashFunc s_hashFunc;
+      friend class ScopedThreadAllocator;
+
+      static std::atomic<IAllocator*> s_allocator;
+      static thread_local IAllocator* s_threadAllocator;
+      static std::atomic<HashFunc> s_hashFunc;
+      static std::atomic<Hash64Func> s_hash64Func;
     };
   } // namespace Runtime
 } // namespace Hydra
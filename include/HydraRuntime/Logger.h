@@ -1,22 +1,87 @@
 #pragma once
 
+#include <cstdarg>
+#include <stdint.h>
+
+/// \brief The lowest log level that is compiled in: 0 = info, 1 = warning, 2 = error.
+///
+/// HYDRA_LOG_INFO and HYDRA_LOG_WARNING expand to nothing below this level. Release builds only keep errors by default.
+#ifndef HYDRA_COMPILE_TIME_LOG_LEVEL
+#  ifdef NDEBUG
+#    define HYDRA_COMPILE_TIME_LOG_LEVEL 2
+#  else
+#    define HYDRA_COMPILE_TIME_LOG_LEVEL 0
+#  endif
+#endif
+
 namespace Hydra
 {
   namespace Runtime
   {
+    enum class LogLevel : uint8_t
+    {
+      Info,
+      Warning,
+      Error,
+      None, // disables all messages
+    };
+
     struct ILoggingInterface
     {
       virtual void LogInfo(const char* message) = 0;
       virtual void LogWarning(const char* message) = 0;
       virtual void LogError(const char* message) = 0;
+
+      /// \brief Called by Log before a message is formatted. Implementations that return true take over formatting the message, e.g. to do it later on another thread.
+      ///
+      /// 'args' must not be consumed, use va_copy() to read the arguments.
+      virtual bool LogDeferred([[maybe_unused]] LogLevel level, [[maybe_unused]] const char* formatStr, [[maybe_unused]] va_list args) { return false; }
+
+      /// \brief Messages below this level are dropped before they get formatted. All messages are passed on by default.
+      virtual LogLevel GetLogLevel() const { return LogLevel::Info; }
     };
 
     class Log
     {
     public:
+      /// \brief Returns whether a message of the given level would reach the logger.
+      static bool IsEnabled(ILoggingInterface* logger, LogLevel level) { return logger != nullptr && level >= logger->GetLogLevel(); }
+
       static void Info(ILoggingInterface* logger, const char* formatStr, ...);
       static void Warning(ILoggingInterface* logger, const char* formatStr, ...);
       static void Error(ILoggingInterface* logger, const char* formatStr, ...);
     };
   } // namespace Runtime
 } // namespace Hydra
+
+/// \brief Like Log::Info(), but the arguments are only evaluated if the message is enabled, and the call is removed entirely below HYDRA_COMPILE_TIME_LOG_LEVEL.
+#if HYDRA_COMPILE_TIME_LOG_LEVEL <= 0
+#  define HYDRA_LOG_INFO(logger, ...)                                                  \
+    do                                                                                 \
+    {                                                                                  \
+      ::Hydra::Runtime::ILoggingInterface* hydraLogger = (logger);                     \
+      if (::Hydra::Runtime::Log::IsEnabled(hydraLogger, ::Hydra::Runtime::LogLevel::Info)) \
+        ::Hydra::Runtime::Log::Info(hydraLogger, __VA_ARGS__);                         \
+    } while (false)
+#else
+#  define HYDRA_LOG_INFO(logger, ...) \
+    do                                \
+    {                                 \
+    } while (false)
+#endif
+
+/// \brief Like Log::Warning(), see HYDRA_LOG_INFO.
+#if HYDRA_COMPILE_TIME_LOG_LEVEL <= 1
+#  define HYDRA_LOG_WARNING(logger, ...)                                                  \
+    do                                                                                    \
+    {                                                                                     \
+      ::Hydra::Runtime::ILoggingInterface* hydraLogger = (logger);                        \
+      if (::Hydra::Runtime::Log::IsEnabled(hydraLogger, ::Hydra::Runtime::LogLevel::Warning)) \
+        ::Hydra::Runtime::Log::Warning(hydraLogger, __VA_ARGS__);                         \
+    } while (false)
+#else
+#  define HYDRA_LOG_WARNING(logger, ...) \
+    do                                   \
+    {                                    \
+    } while (false)
+#endif
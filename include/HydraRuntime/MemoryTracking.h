@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <stdint.h>
+
+namespace Hydra
+{
+  namespace Runtime
+  {
+    struct ILoggingInterface;
+
+    /// \brief The subsystem that an allocation is accounted to.
+    enum class MemoryTag : uint8_t
+    {
+      BitSet,        // Blocks of BitSets (states, sets and selections)
+      FileCache,     // Cached file contents and paths
+      ShaderText,    // Text of permutable shader sections
+      TextPieces,    // Parsed pieces of permutable text
+      ManagerTables, // Variables and lookup tables of the PermutationManager
+      ShaderLibrary, // Loaded shaders of the PermutationShaderLibrary
+      Other,         // Everything allocated through Core without a specific tag
+
+      ENUM_COUNT
+    };
+
+    struct MemoryTagStats
+    {
+      uint64_t m_liveBytes = 0;
+      uint64_t m_peakBytes = 0;
+      uint64_t m_numLiveAllocations = 0;
+      uint64_t m_numTotalAllocations = 0;
+    };
+
+    /// \brief Counts live and peak bytes per MemoryTag of everything that is allocated through Core, BitSet and StlAllocator.
+    ///
+    /// Tracking is always active and thread-safe. The byte counts are the requested sizes, without allocator overhead.
+    class MemoryTracking
+    {
+    public:
+      static void OnAllocate(MemoryTag tag, size_t numBytes);
+      static void OnDeallocate(MemoryTag tag, size_t numBytes);
+
+      static MemoryTagStats GetStats(MemoryTag tag);
+      static const char* GetTagName(MemoryTag tag);
+
+      /// \brief Returns the live bytes summed over all tags.
+      static uint64_t GetTotalLiveBytes();
+
+      /// \brief Sets the peak of every tag to its current live bytes, e.g. to measure the peak of a single frame or level load.
+      static void ResetPeaks();
+
+      /// \brief Logs the stats of all tags as info messages.
+      static void DumpToLog(ILoggingInterface* logger);
+
+    private:
+      struct TagCounters
+      {
+        std::atomic<uint64_t> m_liveBytes = 0;
+        std::atomic<uint64_t> m_peakBytes = 0;
+        std::atomic<uint64_t> m_numLiveAllocations = 0;
+        std::atomic<uint64_t> m_numTotalAllocations = 0;
+      };
+
+      static TagCounters s_counters[(size_t)MemoryTag::ENUM_COUNT];
+    };
+
+    inline void MemoryTracking::OnAllocate(MemoryTag tag, size_t numBytes)
+    {
+      TagCounters& counters = s_counters[(size_t)tag];
+
+      const uint64_t liveBytes = counters.m_liveBytes.fetch_add(numBytes, std::memory_order_relaxed) + numBytes;
+      counters.m_numLiveAllocations.fetch_add(1, std::memory_order_relaxed);
+      counters.m_numTotalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+      uint64_t peakBytes = counters.m_peakBytes.load(std::memory_order_relaxed);
+      while (liveBytes > peakBytes && !counters.m_peakBytes.compare_exchange_weak(peakBytes, liveBytes, std::memory_order_relaxed))
+      {
+      }
+    }
+
+    inline void MemoryTracking::OnDeallocate(MemoryTag tag, size_t numBytes)
+    {
+      TagCounters& counters = s_counters[(size_t)tag];
+
+      counters.m_liveBytes.fetch_sub(numBytes, std::memory_order_relaxed);
+      counters.m_numLiveAllocations.fetch_sub(1, std::memory_order_relaxed);
+    }
+  } // namespace Runtime
+} // namespace Hydra
@@ -1,13 +1,18 @@
 #pragma once
 
+#include <HydraRuntime/Allocator.h>
 #include <HydraRuntime/Logger.h>
 #include <HydraRuntime/PermutationSets.h>
+#include <HydraRuntime/PermutationStatistics.h>
+#include <HydraRuntime/SymbolTable.h>
 
 #include <deque>
+#include <functional>
 #include <map>
 #include <optional>
 #include <span>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace Hydra
@@ -27,6 +32,7 @@ namespace Hydra
       };
 
       std::string m_name;
+      SymbolId m_nameSymbol = INVALID_SYMBOL;
 
       uint32_t m_startBitIndex = 0;
       uint16_t m_numBits = 0;
@@ -36,6 +42,7 @@ namespace Hydra
       int m_defaultValue = 0;
 
       std::vector<std::pair<std::string, int>> m_allowedValues;
+      std::vector<SymbolId> m_qualifiedValueSymbols; // Symbols of 'Name::Value' for each allowed value of enum variables, empty otherwise
       const PermutationManager& m_manager;
 
       PermutationVariableEntry(const PermutationManager& manager)
@@ -57,10 +64,16 @@ namespace Hydra
       }
     };
 
+    using EnumeratePermutationsCallback = std::function<void(const PermutationVariableSelection& selection)>;
+
+    /// \brief Computes the value of a derived permutation variable from the values of its input variables (in the order they were registered).
+    using DeriveValueFunc = std::function<Result(std::span<const int> inputValues, int& out_value)>;
+
     class PermutationManager
     {
     public:
-      PermutationManager(ILoggingInterface* logger = nullptr);
+      /// \brief Variable names are interned into 'symbolTable', or into SymbolTable::GetGlobal() if none is given. The table must outlive the manager.
+      PermutationManager(ILoggingInterface* logger = nullptr, SymbolTable* symbolTable = nullptr);
 
       const PermutationVariableEntry* RegisterVariable(const char* name, std::optional<bool> defaultValue = std::nullopt);
       const PermutationVariableEntry* RegisterVariable(const char* name, std::span<int> allowedValues, std::optional<int> defaultValue = std::nullopt);
@@ -68,16 +81,73 @@ namespace Hydra
 
       const PermutationVariableEntry* GetVariable(const char* name) const;
       const PermutationVariableEntry* GetVariable(uint32_t bitIndex) const;
+      const PermutationVariableEntry* GetVariableBySymbol(SymbolId nameSymbol) const;
+
+      /// \brief The symbol table that holds the variable names. Tokenizers that use the same table produce matching symbol IDs.
+      SymbolTable& GetSymbolTable() const { return *m_symbolTable; }
 
+      /// \brief Merges the given state with the default values and applies all constraints. Fails if a used variable has no value or a mutually exclusive group is violated.
       Result FinalizeState(const PermutationVariableState& state, const PermutationVariableSet& usedVariablesSet, PermutationVariableSelection& out_selection) const;
 
+      /// \brief Whenever 'ifVariable' has the value 'ifValue', 'thenVariable' is forced to 'thenValue' during FinalizeState().
+      Result AddImplication(const PermutationVariableEntry& ifVariable, int ifValue, const PermutationVariableEntry& thenVariable, int thenValue);
+
+      /// \brief Whenever 'whenVariable' has the value 'whenValue', 'ignoredVariable' is irrelevant and is set to its canonical value during FinalizeState().
+      ///
+      /// The canonical value is the default value of 'ignoredVariable' or, if it has none, its first allowed value (false for bools).
+      Result AddDontCareRule(const PermutationVariableEntry& ignoredVariable, const PermutationVariableEntry& whenVariable, int whenValue);
+
+      /// \brief At most one of the given bool variables may be true at the same time. FinalizeState() fails for states that violate this.
+      Result AddMutuallyExclusiveGroup(std::span<const PermutationVariableEntry* const> variables);
+
+      /// \brief Turns an already registered variable into a derived variable, whose value is always computed from 'inputs' during FinalizeState().
+      ///
+      /// Values for derived variables don't need to be set in states, and values that are set get overwritten.
+      /// The inputs don't need to be part of the used variables set, they only need to have a value in the state or a default value.
+      /// A derived variable may use previously registered derived variables as inputs, but a variable that already is the input of a derived variable
+      /// can't become derived itself, so derived variables are always computed after their inputs and can't depend on each other in a cycle.
+      /// FinalizeState() only computes the derived variables of the used variables set and the ones they depend on.
+      /// Variable sets that already contain 'variable' have to be built again, see PermutationVariableSet::AddVariable().
+      Result RegisterDerivedVariable(const PermutationVariableEntry& variable, std::span<const PermutationVariableEntry* const> inputs, DeriveValueFunc deriveFunc);
+
+      bool IsDerivedVariable(const PermutationVariableEntry& variable) const;
+
+      /// \brief Calls 'callback' once for every distinct selection that FinalizeState() can produce for the given set and returns how many there are.
+      ///
+      /// All combinations of allowed values of the used variables (and the inputs of used derived variables) are tried, so the number of combinations grows exponentially with the size of the set.
+      /// Combinations that violate a constraint are skipped and combinations that are canonicalized to the same selection are only reported once.
+      uint32_t EnumeratePermutations(const PermutationVariableSet& usedVariablesSet, EnumeratePermutationsCallback callback) const;
+
+      /// \brief Enables recording of how often states are set, merged and finalized. Disabled by default, in which case recording costs a single branch per call.
+      ///
+      /// Meant for finding variables that are rarely set or thrash the shader cache. Recording is thread-safe, but takes a lock per SetVariable() and FinalizeState() call.
+      void SetStatisticsEnabled(bool enabled);
+      bool IsStatisticsEnabled() const;
+
+      /// \brief Returns a snapshot of everything that was recorded since the statistics were last reset.
+      PermutationStatistics GetStatistics() const;
+      void ResetStatistics();
+
     private:
+      friend class PermutationVariableState;
+
+      Result FinalizeStateInternal(const PermutationVariableState& state, const PermutationVariableSet& usedVariablesSet, PermutationVariableSelection& out_selection, ILoggingInterface* logger, bool recordStatistics) const;
+      Result ApplyConstraints(PermutationVariableSelection& selection, ILoggingInterface* logger) const;
+      Result ComputeDerivedValues(const PermutationVariableState& state, const PermutationVariableSet& usedVariablesSet, PermutationVariableSelection& inout_selection, ILoggingInterface* logger) const;
       const PermutationVariableEntry* RegisterVariableInternal(const char* name, std::span<std::pair<std::string, int>> allowedValues, std::optional<int> defaultValue, PermutationVariableEntry::Type type);
       uint32_t GetFreeBitIndex(uint32_t numBitsNeeded = 1);
 
-      std::deque<PermutationVariableEntry> m_variableStorage;
-      std::map<std::string, PermutationVariableEntry*> m_variableNameToVariable;
-      std::vector<PermutationVariableEntry*> m_bitIndexToVariable;
+      template <typename T>
+      using TableAllocator = StlAllocator<T, MemoryTag::ManagerTables>;
+
+      template <typename T>
+      using TableVector = std::vector<T, TableAllocator<T>>;
+
+      std::deque<PermutationVariableEntry, TableAllocator<PermutationVariableEntry>> m_variableStorage;
+      std::map<std::string, PermutationVariableEntry*, std::less<std::string>, TableAllocator<std::pair<const std::string, PermutationVariableEntry*>>> m_variableNameToVariable;
+      TableVector<PermutationVariableEntry*> m_bitIndexToVariable;
+      std::unordered_map<SymbolId, PermutationVariableEntry*, std::hash<SymbolId>, std::equal_to<SymbolId>, TableAllocator<std::pair<const SymbolId, PermutationVariableEntry*>>> m_symbolToVariable;
+      SymbolTable* m_symbolTable = nullptr;
 
       struct BlockAllocation
       {
@@ -92,11 +162,42 @@ namespace Hydra
           return m_blockIndex < other.m_blockIndex;
         }
       };
-      std::vector<BlockAllocation> m_blockAllocations;
+      TableVector<BlockAllocation> m_blockAllocations;
       uint32_t m_nextBlockIndex = 0;
 
       PermutationVariableState m_defaultState;
 
+      struct CanonicalizationRule
+      {
+        uint32_t m_conditionStartBitIndex = 0;
+        uint16_t m_conditionNumBits = 0;
+        uint32_t m_conditionEncodedValue = 0;
+
+        uint32_t m_targetStartBitIndex = 0;
+        uint16_t m_targetNumBits = 0;
+        uint32_t m_targetEncodedValue = 0;
+      };
+      TableVector<CanonicalizationRule> m_canonicalizationRules;
+
+      struct ExclusiveGroup
+      {
+        BitSet m_mask;
+        std::vector<const PermutationVariableEntry*> m_variables;
+      };
+      TableVector<ExclusiveGroup> m_exclusiveGroups;
+
+      struct DerivedVariable
+      {
+        const PermutationVariableEntry* m_variable = nullptr;
+        std::vector<const PermutationVariableEntry*> m_inputs;
+        std::vector<int32_t> m_derivedInputIndices; // For each input, the index of its entry in m_derivedVariables if it is derived, -1 otherwise
+        DeriveValueFunc m_deriveFunc;
+      };
+      TableVector<DerivedVariable> m_derivedVariables;
+      BitSet m_derivedVariablesMask;
+
+      mutable PermutationStatisticsRecorder m_statistics;
+
       ILoggingInterface* m_logger = nullptr;
     };
   } // namespace Runtime
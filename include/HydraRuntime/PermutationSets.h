@@ -12,6 +12,7 @@ namespace Hydra
     struct ILoggingInterface;
     struct PermutationVariableEntry;
     class PermutationManager;
+    class PermutationVariableState;
 
     using IterateCallback = std::function<void(const PermutationVariableEntry& variable)>;
     using IterateValuesCallback = std::function<void(const PermutationVariableEntry& variable, int valueInt, const char* valueString)>;
@@ -25,6 +26,10 @@ namespace Hydra
       bool operator==(const PermutationVariableSet& other) const;
       bool operator!=(const PermutationVariableSet& other) const;
 
+      /// \brief Adds the variable and resolves its default value or whether it is required, for finalizing states with this set.
+      ///
+      /// Derived variables are never required, so variables have to be registered as derived before they are added to sets.
+      /// Sets that already contain a variable when it becomes derived are stale, FinalizeState() fails for them until they are built again.
       void AddVariable(const PermutationVariableEntry& variable);
 
       void Iterate(IterateCallback callback) const;
@@ -33,12 +38,24 @@ namespace Hydra
 
       void Clear();
 
+      uint32_t Hash() const { return m_mask.Hash(); }
+
+      /// \brief Bits of all variables in this set that have no default value and aren't derived, i.e. that every finalized state has to set.
+      const BitSet& GetRequiredMask() const { return m_requiredMask; }
+
+      /// \brief Returns whether the state sets all variables in GetRequiredMask(), which means that it can be finalized with this set.
+      bool HasAllRequiredValues(const PermutationVariableState& state) const;
+
     private:
       friend class PermutationManager;
       friend class PermutationVariableState;
 
       const PermutationManager* m_manager = nullptr;
       BitSet m_mask;
+
+      // Template for finalizing states, these always cover the same blocks as m_mask
+      BitSet m_defaultValues;
+      BitSet m_requiredMask;
     };
 
     class PermutationVariableState
@@ -65,12 +82,14 @@ namespace Hydra
 
     private:
       friend class PermutationManager;
+      friend class PermutationVariableSet;
 
       void SetVariableInternal(const PermutationVariableEntry& variable, uint32_t encodedValue);
 
       using MissingValuesCallback = std::function<void(uint32_t baseBitIndex, BitSet::BlockType missingBits)>;
 
       static Result MergeInternal(const PermutationVariableState& stateA, const PermutationVariableState& stateB, const PermutationVariableSet& usedVarsSet, BitSet& out_values, BitSet& out_valuesMask, MissingValuesCallback missingValuesCallback = nullptr);
+      static Result MergeSetDefaultsInternal(const PermutationVariableState& state, const PermutationVariableSet& usedVarsSet, BitSet& out_values, BitSet& out_valuesMask, MissingValuesCallback missingValuesCallback);
 
       const PermutationManager* m_manager = nullptr;
       BitSet m_values;
@@ -90,6 +109,9 @@ namespace Hydra
       void DumpToDebugOut() const;
       void DumpToLog(ILoggingInterface* logger) const;
 
+      /// \brief Decodes the value of 'variable' straight from the selection bits. Returns false if the selection has no value for it.
+      bool GetVariableValue(const PermutationVariableEntry& variable, int& out_value) const;
+
       void Clear();
 
       uint32_t Hash() const { return m_hash; }
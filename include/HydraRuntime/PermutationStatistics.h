@@ -0,0 +1,89 @@
+#pragma once
+
+#include <HydraRuntime/BitSet.h>
+#include <HydraRuntime/PermutationSets.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Hydra
+{
+  namespace Runtime
+  {
+    struct ILoggingInterface;
+    struct PermutationVariableEntry;
+    class PermutationVariableSet;
+    class PermutationVariableSelection;
+
+    /// \brief A snapshot of the usage counters of a PermutationManager. See PermutationManager::SetStatisticsEnabled().
+    struct PermutationStatistics
+    {
+      struct SetStatistics
+      {
+        std::string m_variableNames;
+        uint64_t m_numFinalizeCalls = 0;
+        uint64_t m_numDistinctSelections = 0;
+      };
+
+      uint64_t m_numFinalizeCalls = 0;
+      uint64_t m_numFinalizeFailures = 0;
+      uint64_t m_numMerges = 0;
+      uint64_t m_numSetVariableCalls = 0;
+
+      /// How often FinalizeState() failed, because a variable had no value.
+      std::map<std::string, uint64_t> m_missingValueFailures;
+
+      /// How often PermutationVariableState::SetVariable() was called for each variable.
+      std::map<std::string, uint64_t> m_setVariableCounts;
+
+      /// One entry per PermutationVariableSet that was used in FinalizeState(). Many distinct selections per call indicate thrashing states.
+      std::vector<SetStatistics> m_sets;
+
+      void DumpToLog(ILoggingInterface* logger) const;
+    };
+
+    /// \brief Internal helper of the PermutationManager that records the statistics.
+    class PermutationStatisticsRecorder
+    {
+    public:
+      bool IsEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+      void SetEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+
+      void RecordFinalize(const PermutationVariableSet& usedVariablesSet, const PermutationVariableSelection& selection, bool succeeded);
+      void RecordMissingValue(const PermutationVariableEntry& variable);
+      void RecordMerge();
+      void RecordSetVariable(const PermutationVariableEntry& variable);
+
+      PermutationStatistics GetSnapshot() const;
+      void Reset();
+
+    private:
+      // Sets and selections are looked up by their hash, but compared in full, so that hash collisions don't merge them
+      struct SetRecord
+      {
+        PermutationVariableSet m_set;
+        std::string m_variableNames;
+        uint64_t m_numFinalizeCalls = 0;
+        std::vector<PermutationVariableSelection> m_distinctSelections;
+        std::unordered_multimap<uint32_t, size_t> m_selectionHashToIndex;
+      };
+
+      std::atomic<bool> m_enabled = false;
+
+      std::atomic<uint64_t> m_numFinalizeCalls = 0;
+      std::atomic<uint64_t> m_numFinalizeFailures = 0;
+      std::atomic<uint64_t> m_numMerges = 0;
+      std::atomic<uint64_t> m_numSetVariableCalls = 0;
+
+      mutable std::mutex m_mutex;
+      std::unordered_map<const PermutationVariableEntry*, uint64_t> m_missingValueFailures;
+      std::unordered_map<const PermutationVariableEntry*, uint64_t> m_setVariableCounts;
+      std::vector<SetRecord> m_sets;
+      std::unordered_multimap<uint32_t, size_t> m_setHashToIndex;
+    };
+  } // namespace Runtime
+} // namespace Hydra
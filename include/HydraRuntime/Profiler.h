@@ -0,0 +1,131 @@
+#pragma once
+
+#include <HydraRuntime/Result.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// \brief Set to 0 to compile out all HYDRA_PROFILE_SCOPE instrumentation.
+#ifndef HYDRA_PROFILING_ENABLED
+#  define HYDRA_PROFILING_ENABLED 1
+#endif
+
+namespace Hydra
+{
+  namespace Runtime
+  {
+    /// \brief Interface for hooking up a profiler. See Profiler::SetProfiler().
+    ///
+    /// Scope and counter names are always string literals, so implementations may store the pointers instead of copying the strings.
+    /// The functions are called from all threads that run instrumented code.
+    struct IProfiler
+    {
+      virtual void BeginScope(const char* name, uint32_t threadId) = 0;
+      virtual void EndScope(const char* name, uint32_t threadId) = 0;
+      virtual void SetCounter([[maybe_unused]] const char* name, [[maybe_unused]] uint32_t threadId, [[maybe_unused]] int64_t value) {}
+    };
+
+    class Profiler
+    {
+    public:
+      /// \brief Sets the profiler that receives all scopes and counters. Passing nullptr disables profiling, which is the default.
+      static void SetProfiler(IProfiler* profiler) { s_profiler.store(profiler, std::memory_order_release); }
+      static IProfiler* GetProfiler() { return s_profiler.load(std::memory_order_acquire); }
+
+      /// \brief Returns a small number that identifies the calling thread, assigned in the order in which threads first ask for it.
+      static uint32_t GetCurrentThreadId();
+
+      static void SetCounter(const char* name, int64_t value)
+      {
+        if (IProfiler* profiler = GetProfiler())
+        {
+          profiler->SetCounter(name, GetCurrentThreadId(), value);
+        }
+      }
+
+    private:
+      static std::atomic<IProfiler*> s_profiler;
+    };
+
+    /// \brief Reports a scope to the current profiler. Use HYDRA_PROFILE_SCOPE instead of using this directly.
+    class ProfilerScope
+    {
+    public:
+      ProfilerScope(const char* name)
+        : m_profiler(Profiler::GetProfiler())
+        , m_name(name)
+      {
+        if (m_profiler != nullptr)
+        {
+          m_threadId = Profiler::GetCurrentThreadId();
+          m_profiler->BeginScope(m_name, m_threadId);
+        }
+      }
+
+      ~ProfilerScope()
+      {
+        if (m_profiler != nullptr)
+        {
+          m_profiler->EndScope(m_name, m_threadId);
+        }
+      }
+
+      ProfilerScope(const ProfilerScope&) = delete;
+      void operator=(const ProfilerScope&) = delete;
+
+    private:
+      IProfiler* m_profiler = nullptr;
+      const char* m_name = nullptr;
+      uint32_t m_threadId = 0;
+    };
+
+    /// \brief A profiler that records all events in memory and writes them as Chrome trace events (for chrome://tracing or Perfetto).
+    class ChromeTraceRecorder : public IProfiler
+    {
+    public:
+      ChromeTraceRecorder();
+
+      virtual void BeginScope(const char* name, uint32_t threadId) override;
+      virtual void EndScope(const char* name, uint32_t threadId) override;
+      virtual void SetCounter(const char* name, uint32_t threadId, int64_t value) override;
+
+      uint32_t GetNumEvents() const;
+      void Clear();
+
+      /// \brief Returns all recorded events in the Chrome trace event JSON format.
+      std::string ToJson() const;
+
+      Result SaveToFile(const char* path) const;
+
+    private:
+      struct Event
+      {
+        const char* m_name = nullptr;
+        char m_phase = 'B';
+        uint32_t m_threadId = 0;
+        int64_t m_timestampNs = 0;
+        int64_t m_value = 0;
+      };
+
+      void AddEvent(const char* name, char phase, uint32_t threadId, int64_t value);
+
+      std::chrono::steady_clock::time_point m_startTime;
+
+      mutable std::mutex m_mutex;
+      std::vector<Event> m_events;
+    };
+  } // namespace Runtime
+} // namespace Hydra
+
+#define HYDRA_PROFILE_CONCAT_INTERNAL(a, b) a##b
+#define HYDRA_PROFILE_CONCAT(a, b) HYDRA_PROFILE_CONCAT_INTERNAL(a, b)
+
+/// \brief Reports the rest of the enclosing scope to the current profiler under 'name', which has to be a string literal. Costs a single branch when no profiler is set.
+#if HYDRA_PROFILING_ENABLED
+#  define HYDRA_PROFILE_SCOPE(name) ::Hydra::Runtime::ProfilerScope HYDRA_PROFILE_CONCAT(hydraProfileScope, __LINE__)(name)
+#else
+#  define HYDRA_PROFILE_SCOPE(name)
+#endif
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <HydraRuntime/Result.h>
+
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace Hydra
+{
+  namespace Runtime
+  {
+    /// \brief A stable integer ID for an interned string. IDs are dense and start at 0.
+    using SymbolId = uint32_t;
+
+    constexpr SymbolId INVALID_SYMBOL = 0xFFFFFFFFu;
+
+    /// \brief 'true' and 'false' are always interned first, so these IDs are the same in every symbol table.
+    constexpr SymbolId SYMBOL_TRUE = 0;
+    constexpr SymbolId SYMBOL_FALSE = 1;
+
+    /// \brief Maps strings to stable integer IDs, so that identifiers can be compared and looked up by integer.
+    ///
+    /// All functions are thread-safe. Lookups of existing symbols only take a shared lock.
+    /// Symbols are never removed, so IDs and the views returned by GetName() stay valid for the lifetime of the table.
+    class SymbolTable
+    {
+    public:
+      SymbolTable();
+      ~SymbolTable();
+
+      SymbolTable(const SymbolTable&) = delete;
+      SymbolTable& operator=(const SymbolTable&) = delete;
+
+      /// \brief Returns the ID of 'name', adding it to the table if necessary.
+      SymbolId Intern(std::string_view name);
+
+      /// \brief Returns the ID of 'name' or INVALID_SYMBOL if it was never interned.
+      SymbolId Find(std::string_view name) const;
+
+      /// \brief Returns the string of the given symbol or an empty view for invalid IDs.
+      std::string_view GetName(SymbolId symbol) const;
+
+      uint32_t GetNumSymbols() const;
+
+      /// \brief The process-wide table that is used when no table is passed explicitly, e.g. by the PermutationManager.
+      static SymbolTable& GetGlobal();
+
+    private:
+      mutable std::shared_mutex m_mutex;
+      std::deque<std::string> m_names; // deque, so that the strings don't move and the map keys stay valid
+      std::unordered_map<std::string_view, SymbolId> m_nameToSymbol;
+    };
+  } // namespace Runtime
+} // namespace Hydra
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <HydraRuntime/Result.h>
+
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace Hydra::Runtime
+{
+  struct ILoggingInterface;
+  struct PermutationVariableEntry;
+  class PermutationManager;
+}
+
+namespace Hydra::Tools
+{
+  class CompiledCondition;
+
+  /// Builds reduced, ordered binary decision diagrams (BDDs) over the encoded bits of permutation variables.
+  ///
+  /// Every BDD variable is one bit index of a PermutationManager, ordered by bit index. Nodes are shared between all BDDs of a manager,
+  /// so two functions are equivalent exactly if they are the same node. This allows answering questions about conditions,
+  /// like whether a condition is always true or whether two branches can ever be taken together, without enumerating the permutations.
+  ///
+  /// Nodes are never freed, they live as long as the manager. The manager is not thread-safe.
+  class BddManager
+  {
+  public:
+    using Node = uint32_t;
+
+    static constexpr Node FALSE_NODE = 0;
+    static constexpr Node TRUE_NODE = 1;
+
+    enum class Operator : uint8_t
+    {
+      And,
+      Or,
+      Xor,
+    };
+
+    BddManager();
+
+    /// The function that is true whenever the given bit is set.
+    Node GetBit(uint32_t bitIndex);
+
+    Node Not(Node node);
+    Node Apply(Operator op, Node lhs, Node rhs);
+    Node And(Node lhs, Node rhs) { return Apply(Operator::And, lhs, rhs); }
+    Node Or(Node lhs, Node rhs) { return Apply(Operator::Or, lhs, rhs); }
+    Node Xor(Node lhs, Node rhs) { return Apply(Operator::Xor, lhs, rhs); }
+
+    /// Returns the function that results from fixing the given bit to 'value'.
+    Node Restrict(Node node, uint32_t bitIndex, bool value);
+
+    /// Fixes all bits of the variable to the given encoded value.
+    Node Restrict(Node node, const Runtime::PermutationVariableEntry& variable, uint32_t encodedValue);
+
+    /// The function that is true whenever the variable has the given encoded value.
+    Node GetValueCondition(const Runtime::PermutationVariableEntry& variable, uint32_t encodedValue);
+
+    /// The function that is true whenever the bits of the variable encode one of its allowed values.
+    Node GetDomainConstraint(const Runtime::PermutationVariableEntry& variable);
+
+    /// Counts the assignments of the bits of the given variables for which 'node' is true.
+    ///
+    /// 'node' must not depend on other bits. Combine it with the domain constraints of the variables to count permutations instead of bit patterns.
+    /// The count is a double, since it can easily exceed 64 bits for tens of variables.
+    double SatCount(Node node, std::span<const Runtime::PermutationVariableEntry* const> variables) const;
+
+    /// Converts a compiled condition into the function that is true for all permutations in which the condition is true.
+    ///
+    /// Identifiers are resolved to variables of 'manager' and to 'Enum::Value' constants of its enum variables.
+    /// The result is false for every bit pattern that doesn't encode allowed values of the used variables, so it already includes their domain constraints.
+    /// Constraints and derived variables of the manager are not taken into account.
+    ///
+    /// Fails like CompiledCondition::Evaluate() in strict mode, if this happens for any permutation of allowed values:
+    /// an identifier that is neither a variable nor an enum value is read, or there is a division by zero.
+    Runtime::Result ConvertCondition(const CompiledCondition& condition, const Runtime::PermutationManager& manager, Node& out_node, Runtime::ILoggingInterface* logger = nullptr);
+
+    /// Number of nodes of all BDDs of this manager, including the two terminals.
+    uint32_t GetNumNodes() const { return static_cast<uint32_t>(m_nodes.size()); }
+
+  private:
+    struct NodeData
+    {
+      uint32_t m_bitIndex = 0; // TERMINAL_BIT_INDEX for the terminals
+      Node m_low = FALSE_NODE;
+      Node m_high = FALSE_NODE;
+    };
+
+    struct TripleKey
+    {
+      uint32_t m_a = 0;
+      uint32_t m_b = 0;
+      uint32_t m_c = 0;
+
+      bool operator==(const TripleKey& other) const = default;
+    };
+
+    struct TripleKeyHash
+    {
+      size_t operator()(const TripleKey& key) const
+      {
+        uint64_t hash = (uint64_t(key.m_a) << 32 | key.m_b) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(hash ^ (hash >> 29) ^ (uint64_t(key.m_c) * 0xC2B2AE3D27D4EB4Full));
+      }
+    };
+
+    static constexpr uint32_t TERMINAL_BIT_INDEX = UINT32_MAX;
+
+    Node MakeNode(uint32_t bitIndex, Node low, Node high);
+    Node RestrictInternal(Node node, uint32_t bitIndex, bool value, std::unordered_map<Node, Node>& cache);
+
+    std::vector<NodeData> m_nodes;
+    std::unordered_map<TripleKey, Node, TripleKeyHash> m_uniqueTable;
+    std::unordered_map<TripleKey, Node, TripleKeyHash> m_applyCache;
+  };
+
+} // namespace Hydra::Tools
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <HydraRuntime/Result.h>
+#include <HydraTools/CompiledCondition.h>
+
+#include <cstdint>
+#include <map>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Hydra::Runtime
+{
+  struct ILoggingInterface;
+  struct PermutationVariableEntry;
+}
+
+namespace Hydra::Tools
+{
+  /// Evaluates compiled conditions for 64 sets of variable values (lanes) at once.
+  ///
+  /// Values are stored bit-sliced: plane i holds bit i of the value in all lanes, so one bitwise operation on a plane works on all lanes.
+  /// Additions, comparisons, bitwise and logical operators and shifts by constants are computed like that,
+  /// multiplications, divisions and shifts by variable amounts are computed lane by lane.
+  /// The result of each lane is the same as that of CompiledCondition::Evaluate() in strict mode.
+  class BitSlicedEvaluator
+  {
+  public:
+    static constexpr uint32_t NUM_LANES = 64;
+
+    /// One bit per lane.
+    using LaneMask = uint64_t;
+
+    /// The value of every lane as 64 bit two's complement numbers. Planes from m_numPlanes on are copies of the last one (sign extension).
+    struct Value
+    {
+      uint32_t m_numPlanes = 1;
+      LaneMask m_planes[64] = {};
+    };
+
+    /// Sets the values of a variable in all lanes. Lanes beyond laneValues.size() get the value 0.
+    void SetVariable(std::string_view name, std::span<const int> laneValues);
+
+    /// Sets the same value for a variable in all lanes, e.g. for 'Enum::Value' constants.
+    void SetConstant(std::string_view name, int value);
+
+    void ClearVariables();
+
+    /// Computes the mask of all lanes in 'activeLanes', for which the condition isn't 0.
+    ///
+    /// Lanes outside of 'activeLanes' are never reported and can't make the evaluation fail.
+    /// Fails like CompiledCondition::Evaluate() in strict mode, if the condition reads a variable without a value, or divides by zero in an active lane that doesn't short-circuit the division.
+    Runtime::Result Evaluate(const CompiledCondition& condition, LaneMask& out_trueLanes, LaneMask activeLanes = ~LaneMask(0), Runtime::ILoggingInterface* logger = nullptr);
+
+  private:
+    std::map<std::string, Value, std::less<>> m_variables;
+    std::vector<Value> m_stack;
+    std::vector<const Value*> m_resolvedVariables;
+  };
+
+  /// All combinations of the allowed values of a set of variables.
+  ///
+  /// Permutations are indexed like a mixed radix number, where the value of the first variable changes fastest.
+  class PermutationSpace
+  {
+  public:
+    void AddVariable(std::string_view name, std::vector<int> allowedValues);
+
+    /// Adds a variable of a PermutationManager with all its allowed values. For enum variables, the 'Enum::Value' constants are added as well.
+    void AddVariable(const Runtime::PermutationVariableEntry& variable);
+
+    /// Adds a name that has the same value in all permutations, so it doesn't change the number of permutations.
+    void AddConstant(std::string_view name, int value);
+
+    uint64_t GetNumPermutations() const;
+
+    /// Sets the value of every variable and constant for the given permutation.
+    void GetPermutationValues(uint64_t permutationIndex, ValueTable& out_values) const;
+
+    /// Determines for every permutation whether the condition is true. Bit (i % 64) of out_mask[i / 64] is set, if it is true for permutation i.
+    ///
+    /// Fails if the condition fails to evaluate for any permutation.
+    Runtime::Result EvaluateCondition(const CompiledCondition& condition, std::vector<uint64_t>& out_mask, Runtime::ILoggingInterface* logger = nullptr) const;
+
+  private:
+    struct Variable
+    {
+      std::string m_name;
+      std::vector<int> m_allowedValues;
+    };
+
+    std::vector<Variable> m_variables;
+    std::vector<std::pair<std::string, int>> m_constants;
+  };
+
+} // namespace Hydra::Tools
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <HydraRuntime/Result.h>
+#include <HydraTools/Evaluator.h>
+
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Hydra::Runtime
+{
+  struct ILoggingInterface;
+  struct PermutationVariableEntry;
+  class PermutationManager;
+}
+
+namespace Hydra::Tools
+{
+  class BoundCondition;
+  class ConditionVariableSlots;
+
+  /// A condition that was parsed once into postfix bytecode, so that it can be evaluated many times without any tokenizing or parsing.
+  ///
+  /// Accepts the same syntax as the Evaluator, and evaluation has the same semantics and reports the same errors as Evaluator::EvaluateCondition().
+  /// Like there, '&&' and '||' short-circuit: the right operand is skipped with a jump when the left one decides the result.
+  class CompiledCondition
+  {
+  public:
+    enum class OpCode : uint8_t
+    {
+      PushConstant, // Pushes m_operand
+      PushVariable, // Pushes the value of the variable GetVariableNames()[m_operand]
+      PushSlot,     // Pushes the value at index m_operand of the slot values, only used by bound conditions
+      Negate,
+      BitNot,
+      LogicalNot,
+      Multiply,
+      Divide,
+      Modulo,
+      Add,
+      Subtract,
+      ShiftLeft,
+      ShiftRight,
+      Less,
+      LessEqual,
+      Greater,
+      GreaterEqual,
+      Equal,
+      NotEqual,
+      BitAnd,
+      BitXor,
+      BitOr,
+      ToBool,      // Replaces a value that isn't 0 with 1
+      JumpIfFalse, // '&&': If the value is 0, keeps it and skips the next m_operand instructions, otherwise pops it
+      JumpIfTrue,  // '||': If the value isn't 0, replaces it with 1 and skips the next m_operand instructions, otherwise pops it
+    };
+
+    struct Instruction
+    {
+      OpCode m_opCode = OpCode::PushConstant;
+      int32_t m_operand = 0;
+
+      bool operator==(const Instruction& other) const = default;
+    };
+
+    /// Parses the condition. On failure the errors are logged just like the Evaluator would log them and the condition stays empty.
+    Runtime::Result Compile(std::string_view condition, Runtime::ILoggingInterface* logger);
+    Runtime::Result Compile(const TokenStream& condition, Runtime::ILoggingInterface* logger);
+
+    Runtime::Result Evaluate(const ValueTable& values, int& result_out, Evaluator::Mode mode = Evaluator::Mode::Strict, Runtime::ILoggingInterface* logger = nullptr) const;
+
+    /// Folds everything that only depends on 'knownValues' into constants, so that only a residual condition over the remaining variables is left.
+    ///
+    /// '&&' and '||' with a decided operand are simplified as well, e.g. 'A && B' becomes '0' for A = 0 and 'B != 0' for A = 1.
+    /// Divisions by zero are never folded, so that evaluating the condition still reports them. For the same reason, e.g. 'A && 0'
+    /// is only folded to '0' if A is known, since evaluating the left operand could fail for a missing variable or a division by zero.
+    void PartiallyEvaluate(const ValueTable& knownValues);
+
+    /// Returns the value of conditions that consist of a single constant, e.g. after PartiallyEvaluate() decided them.
+    std::optional<int> GetConstantValue() const;
+
+    /// Resolves all identifiers through 'slots', which assigns new slots as needed. Fails for identifiers that 'slots' can't resolve.
+    Runtime::Result Bind(ConditionVariableSlots& slots, BoundCondition& out_bound, Runtime::ILoggingInterface* logger) const;
+
+    /// The identifiers that the condition reads, in order of their first use. Doesn't contain 'true' and 'false'.
+    const std::vector<std::string>& GetVariableNames() const { return m_variableNames; }
+
+    const std::vector<Instruction>& GetInstructions() const { return m_instructions; }
+
+    /// True for conditions without any tokens (apart from comments), which only evaluate successfully in lenient mode.
+    bool IsEmpty() const { return m_instructions.empty(); }
+
+  private:
+    std::vector<Instruction> m_instructions;
+    std::vector<std::string> m_variableNames;
+    uint32_t m_maxStackDepth = 0;
+  };
+
+  /// A compiled condition whose identifiers were replaced by slot indices and constants, see CompiledCondition::Bind().
+  ///
+  /// Evaluation only reads the slot values and never does any string handling.
+  class BoundCondition
+  {
+  public:
+    /// 'slotValues' holds the value of every variable, indexed by the slot that the ConditionVariableSlots assigned to it.
+    Runtime::Result Evaluate(std::span<const int> slotValues, int& result_out, Runtime::ILoggingInterface* logger = nullptr) const;
+
+    const std::vector<CompiledCondition::Instruction>& GetInstructions() const { return m_instructions; }
+
+    /// The minimum number of slot values that Evaluate() needs.
+    uint32_t GetNumRequiredSlots() const { return m_numRequiredSlots; }
+
+  private:
+    friend class CompiledCondition;
+
+    std::vector<CompiledCondition::Instruction> m_instructions;
+    uint32_t m_maxStackDepth = 0;
+    uint32_t m_numRequiredSlots = 0;
+  };
+
+  /// Assigns every variable that bound conditions read a slot in a flat value array.
+  ///
+  /// With a PermutationManager only its variables can be bound, and 'Enum::Value' identifiers of its enum variables become constants.
+  /// Without one, every identifier becomes a variable, which is useful for binding against a variable list of its own.
+  class ConditionVariableSlots
+  {
+  public:
+    ConditionVariableSlots(const Runtime::PermutationManager* manager = nullptr);
+
+    /// Returns the slot of the variable, assigning the next free one if it doesn't have one yet.
+    uint32_t AddVariable(std::string_view name);
+
+    std::optional<uint32_t> FindSlot(std::string_view name) const;
+
+    uint32_t GetNumSlots() const { return static_cast<uint32_t>(m_slotNames.size()); }
+    const std::string& GetSlotName(uint32_t slot) const { return m_slotNames[slot]; }
+
+    /// The manager's variable in the given slot, or null if there is no manager.
+    const Runtime::PermutationVariableEntry* GetSlotVariable(uint32_t slot) const { return m_slotVariables[slot]; }
+
+  private:
+    friend class CompiledCondition;
+
+    Runtime::Result ResolveIdentifier(std::string_view name, CompiledCondition::Instruction& out_instruction);
+
+    const Runtime::PermutationManager* m_manager = nullptr;
+    std::vector<std::string> m_slotNames;
+    std::vector<const Runtime::PermutationVariableEntry*> m_slotVariables;
+    std::map<std::string, uint32_t, std::less<>> m_nameToSlot;
+  };
+
+} // namespace Hydra::Tools
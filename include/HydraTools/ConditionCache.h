@@ -0,0 +1,45 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace Hydra::Tools
+{
+  class CompiledCondition;
+
+  /// Shares compiled conditions between all texts that use the same condition.
+  ///
+  /// Conditions are looked up by their text, with the whitespace normalized, and then deduplicated by their compiled program,
+  /// so e.g. 'A&&B' and '(A) && B' end up as the same object. Only loading goes through the cache, the shared conditions are
+  /// evaluated directly, since evaluating the bytecode is cheaper than any lookup of a memoized result.
+  ///
+  /// All functions are thread-safe. Conditions handed out stay alive as long as the cache, even if nobody else references them.
+  class ConditionCache
+  {
+  public:
+    ConditionCache();
+    ~ConditionCache();
+
+    /// Returns the shared condition for the given text, compiling it on first use. Returns null if the text doesn't compile, errors are not logged.
+    std::shared_ptr<const CompiledCondition> GetCondition(std::string_view text);
+
+    /// Returns an already cached condition with the same program as 'condition', or adds 'condition' to the cache and returns it.
+    std::shared_ptr<const CompiledCondition> GetCondition(std::shared_ptr<const CompiledCondition> condition);
+
+    /// Number of distinct compiled conditions.
+    size_t GetNumConditions() const;
+
+    void Clear();
+
+  private:
+    std::shared_ptr<const CompiledCondition> GetConditionInternal(std::shared_ptr<const CompiledCondition> condition);
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, std::shared_ptr<const CompiledCondition>> m_conditionsByText;    // Null for texts that don't compile
+    std::unordered_map<std::string, std::shared_ptr<const CompiledCondition>> m_conditionsByProgram; // Owns every condition that is handed out
+  };
+
+} // namespace Hydra::Tools
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <HydraRuntime/Result.h>
+#include <string_view>
+
+namespace Hydra::Runtime
+{
+  struct ILoggingInterface;
+  class PermutationManager;
+} // namespace Hydra::Runtime
+
+namespace Hydra::Tools
+{
+  /// Turns the already registered permutation variable 'variableName' into a derived variable, whose value is computed from 'expression'.
+  ///
+  /// The expression uses the same grammar as the conditions in #[if] blocks, e.g. "QUALITY >= 2" or "QUALITY == QUALITY::ULTRA && !LOW_POWER".
+  /// Every identifier in the expression is an input variable and has to be registered with the manager already,
+  /// except for 'ENUM::VALUE' identifiers, which are resolved to constants.
+  /// The expression is parsed once here, and evaluated during PermutationManager::FinalizeState().
+  Runtime::Result RegisterDerivedVariable(Runtime::PermutationManager& manager, const char* variableName, std::string_view expression, Runtime::ILoggingInterface* logger = nullptr);
+
+} // namespace Hydra::Tools
@@ -1,5 +1,7 @@
 #pragma once
 #include <HydraRuntime/Result.h>
+#include <HydraRuntime/SymbolTable.h>
+#include <HydraTools/Tokenizer.h>
 #include <map>
 #include <string>
 #include <unordered_map>
@@ -13,11 +15,28 @@ namespace Hydra::Runtime
 
 namespace Hydra::Tools
 {
-  struct Token;
-  using TokenStream = std::vector<Token>;
-
   using ValueTable = std::map<std::string, int, std::less<>>; // The std::less<> is needed to allow for lookups with std::string_view
   using ValueList = std::unordered_set<std::string_view>;
+  using SymbolValueTable = std::unordered_map<Runtime::SymbolId, int>; // Requires tokens from a Tokenizer with a symbol table
+
+  /// Scratch storage for evaluating conditions that are given as text.
+  ///
+  /// Reusing a context keeps the token storage of earlier evaluations alive, so repeated evaluations don't allocate.
+  /// A context must only be used by one thread at a time.
+  class EvaluationContext
+  {
+  public:
+    EvaluationContext() = default;
+
+    /// Tokenizes 'input' into the scratch storage. The returned tokens are valid until the next call.
+    const TokenStream& Tokenize(std::string_view input, Hydra::Runtime::ILoggingInterface* logger);
+
+    /// Returns the context of the calling thread, which is used by evaluators that don't have a context of their own.
+    static EvaluationContext& GetThreadLocal();
+
+  private:
+    Tokenizer m_tokenizer;
+  };
 
   class Evaluator
   {
@@ -28,9 +47,12 @@ namespace Hydra::Tools
       Lenient, // Assume value 0 for undefined variables
     };
 
-    Evaluator(Hydra::Runtime::ILoggingInterface* logger = nullptr);
+    /// Conditions given as text are tokenized into 'context', or into EvaluationContext::GetThreadLocal() if none is given.
+    Evaluator(Hydra::Runtime::ILoggingInterface* logger = nullptr, EvaluationContext* context = nullptr);
     ~Evaluator();
 
+    /// '&&' and '||' short-circuit: when the left operand decides the result, the right one is only checked for syntax errors, so it can't fail lookups or divide by zero.
+    /// 'usedValues_out' still receives the identifiers of such skipped operands.
     Hydra::Runtime::Result EvaluateCondition(std::string_view input,
       const ValueTable& values,
       int& result_out,
@@ -41,9 +63,17 @@ namespace Hydra::Tools
       int& result_out,
       Mode mode = Mode::Strict,
       ValueList* usedValues_out = nullptr);
+    Hydra::Runtime::Result EvaluateCondition(const TokenStream& input,
+      const SymbolValueTable& values,
+      int& result_out,
+      Mode mode = Mode::Strict,
+      ValueList* usedValues_out = nullptr);
 
   private:
+    Hydra::Runtime::Result EvaluateConditionInternal(const TokenStream& input, const ValueTable* values, const SymbolValueTable* symbolValues, int& result_out, Mode mode, ValueList* usedValues_out);
+
     Hydra::Runtime::ILoggingInterface* m_logger = nullptr;
+    EvaluationContext* m_context = nullptr;
   };
 
   void TestEvaluator(Hydra::Runtime::ILoggingInterface* logger = nullptr);
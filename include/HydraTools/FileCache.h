@@ -1,5 +1,7 @@
 #pragma once
 
+#include <HydraRuntime/Allocator.h>
+
 #include <map>
 #include <mutex>
 #include <string>
@@ -24,7 +26,13 @@ namespace Hydra::Tools
     ///
     /// Expects that the user made sure that the file exists beforehand.
     /// Repeated calls to the same file will return a cached result.
-    const std::string& GetFileContent(std::string_view normalizedPath);
+    /// The returned view stays valid until ClearCache() is called.
+    std::string_view GetFileContent(std::string_view normalizedPath);
+
+    /// Returns a 64 bit hash of the content of the file with the given normalized path.
+    ///
+    /// The hash is computed once when the file is read and can be used to detect whether a file changed on disk.
+    uint64_t GetFileContentHash(std::string_view normalizedPath);
 
     /// Removes all cached data. Future accesses will thus re-read files from disk.
     void ClearCache();
@@ -36,8 +44,19 @@ namespace Hydra::Tools
     /// Reads the file and returns its entire content.
     virtual std::string ReadFileFromDisk(std::string_view normalizedPath) = 0;
 
+    using String = std::basic_string<char, std::char_traits<char>, Runtime::StlAllocator<char, Runtime::MemoryTag::FileCache>>;
+
+    struct CachedFile
+    {
+      String m_content;
+      uint64_t m_contentHash = 0;
+    };
+
+    const CachedFile& GetCachedFile(std::string_view normalizedPath);
+
     mutable std::recursive_mutex m_mutex;
-    std::map<std::string, std::string, std::less<>> m_fileContents;
+    int64_t m_numCachedBytes = 0;
+    std::map<String, CachedFile, std::less<>, Runtime::StlAllocator<std::pair<const String, CachedFile>, Runtime::MemoryTag::FileCache>> m_fileContents;
   };
 
   /// A default implementation of FileCache, using std::filesystem.
@@ -1,18 +1,29 @@
 #pragma once
 
+#include <HydraRuntime/Allocator.h>
 #include <HydraRuntime/Result.h>
+#include <HydraTools/BddManager.h>
+#include <functional>
 #include <map>
+#include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
 namespace Hydra::Runtime
 {
   struct ILoggingInterface;
+  class PermutationManager;
 }
 
 namespace Hydra::Tools
 {
+  class BoundCondition;
+  class CompiledCondition;
+  class ConditionCache;
+  class ConditionVariableSlots;
+
   using PermutationVariableValues = std::map<std::string, int, std::less<>>; // The std::less<> is needed to allow for lookups with std::string_view
 
   struct PermutableTextPiece
@@ -28,6 +39,24 @@ namespace Hydra::Tools
 
     Type m_type = Type::Unconditional;
     std::string_view m_text;
+
+    /// The compiled condition of If and Elif pieces. Null if the condition doesn't compile, in which case it is evaluated from m_text to report the error.
+    std::shared_ptr<const CompiledCondition> m_condition;
+
+    /// For If, Elif and Else pieces, the index of the next Elif, Else or Endif piece of the same #[if].
+    uint32_t m_nextBranchIdx = 0;
+
+    /// For Elif and Else pieces, the index of the Endif piece of their #[if].
+    uint32_t m_endifIdx = 0;
+  };
+
+  /// Whether an #[if], #[elif] or #[else] branch can be taken, see PermutableText::ClassifyBranches().
+  enum class BranchLiveness : uint8_t
+  {
+    Live,        // Taken for some permutations, but not for all that reach it, or not known
+    AlwaysTaken, // Taken by every permutation that reaches it
+    NeverTaken,  // Not taken by any permutation
+    Unreachable, // Inside a branch that is never taken
   };
 
   class PermutableText
@@ -36,7 +65,12 @@ namespace Hydra::Tools
     /// Sets the text that should be permutable.
     ///
     /// Scans the text for occurrences of #[if] etc and prepares it to be be permuted.
-    void SetText(const std::string& text);
+    /// All conditions are compiled here, so generating permutations doesn't need to parse them again.
+    /// With a 'conditionCache', the compiled conditions are shared with all other texts that use the same cache. The cache must outlive this object.
+    ///
+    /// Fails if the #[if] structure is malformed, e.g. an #[endif] is missing or a directive lacks its closing ']'.
+    /// The text is kept in that case, but generating permutations of it fails.
+    Runtime::Result SetText(const std::string& text, Runtime::ILoggingInterface* logger = nullptr, ConditionCache* conditionCache = nullptr);
 
     /// Returns the original text that was set, without any permutation.
     std::string_view GetOriginalText() const;
@@ -44,15 +78,63 @@ namespace Hydra::Tools
     /// Generates a permutation of the text, as described by the state of the permutation variables.
     std::optional<std::string> GenerateTextPermutation(const PermutationVariableValues& permutationVariables, Runtime::ILoggingInterface* logger) const;
 
+    /// Variant of GenerateTextPermutation() that writes into 'out_text', which is cleared first.
+    ///
+    /// Reusing the same string for many permutations avoids all allocations once its capacity suffices.
+    Runtime::Result GenerateTextPermutation(const PermutationVariableValues& permutationVariables, std::string& out_text, Runtime::ILoggingInterface* logger) const;
+
+    /// Binds the compiled conditions through 'slots'. 'out_conditions' gets one entry per piece, of which only the ones of If and Elif pieces are used.
+    ///
+    /// Fails if a condition doesn't compile or uses an identifier that 'slots' can't resolve.
+    Runtime::Result BindConditions(ConditionVariableSlots& slots, std::vector<BoundCondition>& out_conditions, Runtime::ILoggingInterface* logger) const;
+
+    /// Variant of GenerateTextPermutation() that evaluates the conditions from BindConditions() on the given slot values and appends the text to 'inout_text'.
+    Runtime::Result AppendTextPermutation(std::span<const BoundCondition> conditions, std::span<const int> slotValues, std::string& inout_text, Runtime::ILoggingInterface* logger) const;
+
+    /// Partially evaluates all conditions with 'knownValues' and removes the branches that this decides, see CompiledCondition::PartiallyEvaluate().
+    ///
+    /// Branches that are known not to be taken are dropped. A branch that is known to be taken becomes unconditional,
+    /// or the 'else' of the branches before it that are still undecided. Fails and leaves the text unchanged, if its #[if] structure is malformed.
+    Runtime::Result PruneDecidedBranches(const PermutationVariableValues& knownValues, Runtime::ILoggingInterface* logger);
+
+    /// Determines for every branch, whether it can be taken by any permutation in 'validPermutations' and whether it is taken by all of them.
+    ///
+    /// The conditions are converted with BddManager::ConvertCondition() and enclosing and earlier branches of the same #[if] are taken into account,
+    /// e.g. a nested '#[if !A]' inside '#[if A]' is never taken. Branches whose condition can't be converted are Live.
+    /// 'out_liveness' gets one entry per piece, which is Live for pieces that aren't branches. Fails if the #[if] structure is malformed.
+    Runtime::Result ClassifyBranches(BddManager& bdd, const Runtime::PermutationManager& manager, BddManager::Node validPermutations, std::vector<BranchLiveness>& out_liveness) const;
+
+    /// Removes the branches that ClassifyBranches() found to be never taken and makes the ones that are always taken unconditional.
+    ///
+    /// Logs a warning for every such branch, except for the unreachable ones. Fails and leaves the text unchanged, if its #[if] structure is malformed.
+    Runtime::Result RemoveDeadBranches(std::span<const BranchLiveness> liveness, Runtime::ILoggingInterface* logger);
+
     /// Checks all conditional pieces for which permutation variables they may read. No duplicate values are returned.
     Runtime::Result DetermineUsedPermutationVariables(std::vector<std::string>& foundVars, Runtime::ILoggingInterface* logger);
 
   private:
-    Runtime::Result EnterBlock(const PermutationVariableValues& permutationVariables, size_t& blockIdx, std::string& output, Runtime::ILoggingInterface* logger) const;
-    Runtime::Result SkipBlock(size_t& blockIdx, Runtime::ILoggingInterface* logger) const;
+    using PieceList = std::vector<PermutableTextPiece, Runtime::StlAllocator<PermutableTextPiece, Runtime::MemoryTag::TextPieces>>;
+
+    /// Decides a branch piece: sets the constant value of its condition if that is known, and otherwise the condition to keep.
+    using DecideBranchFunc = std::function<void(const PermutableTextPiece& piece, size_t pieceIdx, std::optional<int>& out_constantValue, std::shared_ptr<const CompiledCondition>& out_condition)>;
+
+    Runtime::Result PrunePieces(const DecideBranchFunc& decide, Runtime::ILoggingInterface* logger);
+    static Runtime::Result PruneBlock(const PieceList& pieces, size_t& pieceIdx, const DecideBranchFunc& decide, PieceList& out_pieces);
+    static Runtime::Result PruneBranches(const PieceList& pieces, size_t& pieceIdx, const DecideBranchFunc& decide, PieceList& out_pieces);
+
+    Runtime::Result ClassifyBlock(BddManager& bdd, const Runtime::PermutationManager& manager, size_t& pieceIdx, BddManager::Node reachingPermutations, std::vector<BranchLiveness>& inout_liveness) const;
+    Runtime::Result ClassifyIfBranches(BddManager& bdd, const Runtime::PermutationManager& manager, size_t& pieceIdx, BddManager::Node reachingPermutations, std::vector<BranchLiveness>& inout_liveness) const;
+
+    /// Checks the #[if] structure and sets up m_nextBranchIdx and m_endifIdx of all pieces.
+    Runtime::Result LinkBranches(Runtime::ILoggingInterface* logger);
+
+    template <typename EvaluateFunc>
+    Runtime::Result AppendPieces(const EvaluateFunc& evaluate, std::string& inout_text, Runtime::ILoggingInterface* logger) const;
 
-    std::string m_text;
-    std::vector<PermutableTextPiece> m_pieces;
+    std::basic_string<char, std::char_traits<char>, Runtime::StlAllocator<char, Runtime::MemoryTag::ShaderText>> m_text;
+    PieceList m_pieces;
+    ConditionCache* m_conditionCache = nullptr;
+    bool m_isMalformed = false;
   };
 
 } // namespace Hydra::Tools
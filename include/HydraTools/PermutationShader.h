@@ -1,5 +1,6 @@
 #pragma once
 
+#include <HydraTools/CompiledCondition.h>
 #include <HydraTools/PermutableText.h>
 #include <map>
 #include <set>
@@ -69,4 +70,31 @@ namespace Hydra::Tools
     // The text of each section in the shader file. These can be permuted.
     PermutableText m_shaderSection[ShaderFileSection::MAX_SECTIONS];
   };
+
+  /// The conditions of a PermutationShader and all its imports, bound to the variables of one PermutationManager.
+  ///
+  /// Created through PermutationShaderLibrary::BindPermutationShader(). With this, permutations can be generated
+  /// directly from a PermutationVariableSelection, without setting up PermutationVariableValues first.
+  struct BoundPermutationShader
+  {
+    struct BoundText
+    {
+      const PermutableText* m_text = nullptr;
+
+      // One entry per piece of m_text, see PermutableText::BindConditions().
+      std::vector<BoundCondition> m_conditions;
+    };
+
+    // The shader that was bound. The library that loaded it must outlive this object.
+    const PermutationShader* m_shader = nullptr;
+
+    // Every permutation variable that any condition reads, in the order of the slot values that the conditions expect.
+    ConditionVariableSlots m_slots;
+
+    // The value from the '[PERMUTATIONS]' section for each slot whose variable has a fixed value. All other slots read their value from the selection.
+    std::vector<std::optional<int>> m_fixedSlotValues;
+
+    // The texts to concatenate for each section, imports first.
+    std::vector<BoundText> m_sectionTexts[ShaderFileSection::MAX_SECTIONS];
+  };
 } // namespace Hydra::Tools
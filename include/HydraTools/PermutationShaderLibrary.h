@@ -1,6 +1,8 @@
 #pragma once
 
+#include <HydraRuntime/Allocator.h>
 #include <HydraRuntime/PermutationSets.h>
+#include <HydraTools/ConditionCache.h>
 #include <HydraTools/PermutationShader.h>
 #include <map>
 #include <mutex>
@@ -35,6 +37,15 @@ namespace Hydra::Tools
     /// Sets the file locator implementation to use. This is mandatory to set before loading any shader.
     void SetFileLocator(FileLocator* locator);
 
+    /// Sets the permutation manager whose variables the shaders use. Optional, and should be set before loading any shader.
+    ///
+    /// Shaders are simplified at load time using the fixed values from their [PERMUTATIONS] section.
+    /// Without a manager only 'true', 'false' and integer values can be used for that, with one, fixed enum values are used as well.
+    void SetPermutationManager(const Runtime::PermutationManager* manager);
+
+    /// The cache that all loaded shaders share their compiled #[if] conditions through.
+    const ConditionCache& GetConditionCache() const { return m_conditionCache; }
+
     /// Attempts to return a previously loaded shader. Returns nullptr, if no shader with the given path is loaded yet.
     const PermutationShader* GetLoadedPermutationShader(std::string_view path) const;
 
@@ -74,6 +85,16 @@ namespace Hydra::Tools
     /// This is supposed to be used when a certain shader permutation needs to be compiled and the actual source code is needed.
     std::optional<std::string> GeneratePermutedShaderCode(const PermutationShader& shader, ShaderFileSection::Enum stage, const PermutationVariableValues& permutationVariables) const;
 
+    /// Binds the conditions of the shader and all its imports to the variables of 'manager'. This should be done once for each shader and the result stored.
+    ///
+    /// Fails if a condition doesn't compile or uses an identifier that is neither a variable of 'manager' nor one of its enum values.
+    Runtime::Result BindPermutationShader(const PermutationShader& shader, const Runtime::PermutationManager& manager, BoundPermutationShader& out_bound) const;
+
+    /// Variant of GeneratePermutedShaderCode() that reads the variable values straight from the selection bits, see BindPermutationShader().
+    ///
+    /// This skips SetupVariableValuesForPermutationSelection() entirely. Fails if a variable that the shader uses has neither a fixed value nor a value in the selection.
+    Runtime::Result GeneratePermutedShaderCode(const BoundPermutationShader& shader, ShaderFileSection::Enum stage, const Runtime::PermutationVariableSelection& selection, std::string& out_code) const;
+
     /// Creates the PermutationVariableSet for the given shader. This should be done once for each shader and the result stored.
     ///
     /// The PermutationVariableSet specifies which permutation variables the shader 'exposes', ie allows to be permuted.
@@ -90,19 +111,26 @@ namespace Hydra::Tools
   private:
     Runtime::Result ParseShaderImports(PermutationShader& shader, std::string_view imports) const;
     Runtime::Result LoadShaderImports(PermutationShader& shader);
+    Runtime::Result BindShaderTexts(const PermutationShader& shader, BoundPermutationShader& bound) const;
     Runtime::Result ParsePermutationConfiguration(std::map<std::string, std::string>& allowedPermutations, std::string_view permutations) const;
-    Runtime::Result ParseShaderFile(PermutationShader& shader, const std::string& content);
+    Runtime::Result ParseShaderFile(PermutationShader& shader, std::string_view content);
     Runtime::Result ValidateShader(PermutationShader& shader) const;
+    Runtime::Result RemoveDeadBranches(PermutationShader& shader) const;
 
     Runtime::Result SetupVariableValuesWithNeededEnumValues(PermutationVariableValues& variables, const PermutationShader& shader, const Runtime::PermutationManager& manager, const std::map<std::string, std::string>& allowedValues);
     Runtime::Result SetupVariableValuesWithSelectionValues(PermutationVariableValues& variables, const Runtime::PermutationVariableSelection& selection) const;
     Runtime::Result SetupVariableValuesWithFixedValues(PermutationVariableValues& variables, const PermutationShader& shader, const Runtime::PermutationManager& manager, const std::map<std::string, std::string>& allowedValues);
     void ConfigureTextSectionizer(TextSectionizer& sectionizer) const;
+    void GetFixedVariableValues(const std::map<std::string, std::string>& allowedPermutations, PermutationVariableValues& out_values) const;
+
+    static std::optional<int> ParseFixedValue(const Runtime::PermutationVariableEntry& variable, const std::string& value);
 
     mutable std::recursive_mutex m_mutex;
     Runtime::ILoggingInterface* m_logger = nullptr;
+    const Runtime::PermutationManager* m_permutationManager = nullptr;
     FileCache* m_fileCache = nullptr;
     FileLocator* m_fileLocator = nullptr;
-    std::map<std::string, PermutationShader> m_loadedShaders;
+    ConditionCache m_conditionCache;
+    std::map<std::string, PermutationShader, std::less<std::string>, Runtime::StlAllocator<std::pair<const std::string, PermutationShader>, Runtime::MemoryTag::ShaderLibrary>> m_loadedShaders;
   };
 } // namespace Hydra::Tools
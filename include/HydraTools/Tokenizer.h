@@ -1,4 +1,6 @@
 #pragma once
+#include <HydraRuntime/SymbolTable.h>
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -24,8 +26,39 @@ namespace Hydra::Tools
       BlockComment,
     };
 
+    /// Operators are NonIdentifier tokens. Multi-character operators like '==' or '&&' are emitted as a single token.
+    enum class Operator : uint8_t
+    {
+      None = 0, // Not an operator, e.g. an identifier or an unknown character like ':' or ','
+      Plus,
+      Minus,
+      Multiply,
+      Divide,
+      Modulo,
+      BitNot,
+      BitAnd,
+      BitOr,
+      BitXor,
+      LogicalNot,
+      LogicalAnd,
+      LogicalOr,
+      ShiftLeft,
+      ShiftRight,
+      Equal,
+      NotEqual,
+      Less,
+      LessEqual,
+      Greater,
+      GreaterEqual,
+      Assign,
+      OpenParenthesis,
+      CloseParenthesis,
+    };
+
     Type m_type = Type::Unknown;
     std::string_view m_token;
+    Operator m_operator = Operator::None;
+    Runtime::SymbolId m_symbol = Runtime::INVALID_SYMBOL; // Only set for identifiers, if the Tokenizer has a symbol table
   };
 
   using TokenStream = std::vector<Token>;
@@ -33,11 +66,14 @@ namespace Hydra::Tools
   class Tokenizer
   {
   public:
-    Tokenizer(Hydra::Runtime::ILoggingInterface* logger = nullptr);
+    /// If a symbol table is given, all identifiers (including 'Enum::Value' forms) are interned and get a symbol ID.
+    Tokenizer(Hydra::Runtime::ILoggingInterface* logger = nullptr, Hydra::Runtime::SymbolTable* symbolTable = nullptr);
     ~Tokenizer();
 
     const TokenStream& GetResult() const { return m_tokenStream; }
 
+    void SetLogger(Hydra::Runtime::ILoggingInterface* logger) { m_logger = logger; }
+
     void Tokenize(std::string_view input);
 
   private:
@@ -55,5 +91,6 @@ namespace Hydra::Tools
     Token::Type m_currentType = Token::Type::Unknown;
 
     Hydra::Runtime::ILoggingInterface* m_logger = nullptr;
+    Hydra::Runtime::SymbolTable* m_symbolTable = nullptr;
   };
 } // namespace Hydra::Tools
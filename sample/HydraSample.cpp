@@ -46,6 +46,7 @@ public:
       m_shaderLibrary.SetLogger(&m_logger);
       m_shaderLibrary.SetFileCache(&m_fileCache);
       m_shaderLibrary.SetFileLocator(&m_fileLocator);
+      m_shaderLibrary.SetPermutationManager(&m_permutationManager);
     }
 
     // set up all the permutation variables that we need
@@ -93,6 +94,12 @@ public:
       // if the shader was loaded without errors
 
       shader.m_permutationVariableSet = m_shaderLibrary.CreatePermutationVariableSet(*shader.m_permutationShader, m_permutationManager);
+
+      // binding the conditions to the permutation variables once, allows to generate permutations straight from a selection later
+      if (m_shaderLibrary.BindPermutationShader(*shader.m_permutationShader, m_permutationManager, shader.m_boundShader).Failed())
+      {
+        shader.m_permutationShader = nullptr;
+      }
     }
 
     return m_shaders.size() - 1;
@@ -136,22 +143,14 @@ public:
     {
       printf("Shader permutation %u doesn't exist yet, generating...\n", selectionHash);
 
-      PermutationVariableValues values;
-      if (m_shaderLibrary.SetupVariableValuesForPermutationSelection(values, *shader.m_permutationShader, m_permutationManager, permutationSelection).Failed())
-      {
-        printf("Skipping drawcall, because the shader uses unknown permutation variables.\n");
-        return;
-      }
-
-      std::optional<std::string> permutationSrc = m_shaderLibrary.GeneratePermutedShaderCode(*shader.m_permutationShader, ShaderFileSection::User1, values);
-
-      if (!permutationSrc.has_value())
+      std::string permutationSrc;
+      if (m_shaderLibrary.GeneratePermutedShaderCode(shader.m_boundShader, ShaderFileSection::User1, permutationSelection, permutationSrc).Failed())
       {
         printf("Skipping drawcall, because the shader permutation generation failed.\n");
         return;
       }
 
-      shader.m_shaderPermutations[selectionHash] = permutationSrc.value();
+      shader.m_shaderPermutations[selectionHash] = std::move(permutationSrc);
       iter = shader.m_shaderPermutations.find(selectionHash);
     }
 
@@ -173,6 +172,7 @@ private:
   {
     const Tools::PermutationShader* m_permutationShader = nullptr;
     Runtime::PermutationVariableSet m_permutationVariableSet;
+    Tools::BoundPermutationShader m_boundShader;
     std::map<uint32_t, std::string> m_shaderPermutations;
   };
 
@@ -0,0 +1,101 @@
+#include <HydraRuntime/Allocator.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace Hydra::Runtime
+{
+  ScopedThreadAllocator::ScopedThreadAllocator(IAllocator* allocator)
+    : m_previousAllocator(Core::s_threadAllocator)
+  {
+    Core::s_threadAllocator = allocator;
+  }
+
+  ScopedThreadAllocator::~ScopedThreadAllocator()
+  {
+    Core::s_threadAllocator = m_previousAllocator;
+  }
+
+  //////////////////////////////////////////////////////////////////////////
+
+  ArenaAllocator::ArenaAllocator(size_t chunkSize /*= 64 * 1024*/, IAllocator* parentAllocator /*= nullptr*/)
+    : m_parentAllocator(parentAllocator != nullptr ? parentAllocator : Core::GetAllocator())
+    , m_chunkSize(chunkSize)
+  {
+    assert(m_parentAllocator != this);
+  }
+
+  ArenaAllocator::~ArenaAllocator()
+  {
+    Chunk* chunk = m_firstChunk;
+    while (chunk != nullptr)
+    {
+      Chunk* next = chunk->m_next;
+      m_parentAllocator->Deallocate(chunk, chunk->m_size, alignof(Chunk));
+      chunk = next;
+    }
+  }
+
+  void* ArenaAllocator::Allocate(size_t numBytes, size_t alignment)
+  {
+    assert((alignment & (alignment - 1)) == 0 && "alignment has to be a power of two");
+
+    while (m_currentChunk != nullptr)
+    {
+      const uintptr_t chunkStart = reinterpret_cast<uintptr_t>(m_currentChunk);
+      const uintptr_t freeAddress = chunkStart + m_currentOffset;
+      const uintptr_t alignedAddress = (freeAddress + alignment - 1) & ~(uintptr_t)(alignment - 1);
+
+      if (alignedAddress + numBytes <= chunkStart + m_currentChunk->m_size)
+      {
+        m_numUsedBytes += (alignedAddress + numBytes) - freeAddress;
+        m_currentOffset = (alignedAddress + numBytes) - chunkStart;
+        return reinterpret_cast<void*>(alignedAddress);
+      }
+
+      // continue in the next chunk that was kept from before the last Reset()
+      if (m_currentChunk->m_next == nullptr)
+        break;
+
+      m_currentChunk = m_currentChunk->m_next;
+      m_currentOffset = sizeof(Chunk);
+    }
+
+    const size_t chunkSize = std::max(m_chunkSize, sizeof(Chunk) + alignment + numBytes);
+    Chunk* chunk = static_cast<Chunk*>(m_parentAllocator->Allocate(chunkSize, alignof(Chunk)));
+    if (chunk == nullptr)
+      return nullptr;
+
+    chunk->m_size = chunkSize;
+    m_numReservedBytes += chunkSize;
+
+    if (m_currentChunk != nullptr)
+    {
+      chunk->m_next = m_currentChunk->m_next;
+      m_currentChunk->m_next = chunk;
+    }
+    else
+    {
+      chunk->m_next = nullptr;
+      m_firstChunk = chunk;
+    }
+
+    m_currentChunk = chunk;
+    m_currentOffset = sizeof(Chunk);
+
+    return Allocate(numBytes, alignment);
+  }
+
+  void ArenaAllocator::Deallocate(void*, size_t, size_t)
+  {
+    // memory is only given back in Reset()
+  }
+
+  void ArenaAllocator::Reset()
+  {
+    m_currentChunk = m_firstChunk;
+    m_currentOffset = sizeof(Chunk);
+    m_numUsedBytes = 0;
+  }
+
+} // namespace Hydra::Runtime
@@ -0,0 +1,624 @@
+#include <HydraRuntime/AsyncLogger.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+namespace Hydra::Runtime
+{
+  namespace
+  {
+    enum class LengthModifier : uint8_t
+    {
+      None,
+      Char,       // hh
+      Short,      // h
+      Long,       // l
+      LongLong,   // ll
+      IntMax,     // j
+      Size,       // z
+      PtrDiff,    // t
+      LongDouble, // L
+    };
+
+    struct FormatSpec
+    {
+      size_t m_start = 0;        // position of the '%'
+      size_t m_lengthStart = 0;  // position of the length modifier (or the conversion, if there is none)
+      size_t m_end = 0;          // position after the conversion character
+      uint8_t m_numStars = 0;    // number of '*' for width and precision
+      bool m_hasStarPrecision = false; // whether the precision is given as '*', in which case it is the last star argument
+      int32_t m_precision = -1;  // precision given as digits, -1 if there is none
+      LengthModifier m_length = LengthModifier::None;
+      char m_conversion = 0;
+    };
+
+    /// Finds the next conversion specification in 'formatStr' starting at 'pos'. Returns false, if there is none.
+    bool ParseNextSpec(const char* formatStr, size_t pos, FormatSpec& out_spec)
+    {
+      const char* percent = strchr(formatStr + pos, '%');
+      if (percent == nullptr)
+        return false;
+
+      out_spec = FormatSpec();
+      out_spec.m_start = percent - formatStr;
+
+      const char* cur = percent + 1;
+
+      while (*cur != '\0' && strchr("-+ #0", *cur) != nullptr)
+        ++cur;
+
+      if (*cur == '*')
+      {
+        ++out_spec.m_numStars;
+        ++cur;
+      }
+
+      while (*cur >= '0' && *cur <= '9')
+        ++cur;
+
+      if (*cur == '.')
+      {
+        ++cur;
+
+        if (*cur == '*')
+        {
+          ++out_spec.m_numStars;
+          out_spec.m_hasStarPrecision = true;
+          ++cur;
+        }
+        else
+        {
+          // a '.' without digits means a precision of zero
+          out_spec.m_precision = 0;
+        }
+
+        while (*cur >= '0' && *cur <= '9')
+        {
+          out_spec.m_precision = std::min(out_spec.m_precision * 10 + (*cur - '0'), 0xFFFFF);
+          ++cur;
+        }
+      }
+
+      out_spec.m_lengthStart = cur - formatStr;
+
+      switch (*cur)
+      {
+        case 'h':
+          ++cur;
+          out_spec.m_length = (*cur == 'h') ? LengthModifier::Char : LengthModifier::Short;
+          cur += (*cur == 'h') ? 1 : 0;
+          break;
+        case 'l':
+          ++cur;
+          out_spec.m_length = (*cur == 'l') ? LengthModifier::LongLong : LengthModifier::Long;
+          cur += (*cur == 'l') ? 1 : 0;
+          break;
+        case 'j':
+          ++cur;
+          out_spec.m_length = LengthModifier::IntMax;
+          break;
+        case 'z':
+          ++cur;
+          out_spec.m_length = LengthModifier::Size;
+          break;
+        case 't':
+          ++cur;
+          out_spec.m_length = LengthModifier::PtrDiff;
+          break;
+        case 'L':
+          ++cur;
+          out_spec.m_length = LengthModifier::LongDouble;
+          break;
+      }
+
+      out_spec.m_conversion = *cur;
+      out_spec.m_end = (*cur != '\0') ? (cur - formatStr + 1) : (cur - formatStr);
+      return true;
+    }
+
+    bool IsIntegerConversion(char conversion)
+    {
+      return conversion != '\0' && strchr("diuoxX", conversion) != nullptr;
+    }
+
+    bool IsFloatConversion(char conversion)
+    {
+      return conversion != '\0' && strchr("fFeEgGaA", conversion) != nullptr;
+    }
+
+    int64_t ReadIntegerArgument(const FormatSpec& spec, va_list& args)
+    {
+      const bool isSigned = (spec.m_conversion == 'd' || spec.m_conversion == 'i');
+
+      switch (spec.m_length)
+      {
+        case LengthModifier::Char:
+          return isSigned ? (int64_t)(signed char)va_arg(args, int) : (int64_t)(unsigned char)va_arg(args, int);
+        case LengthModifier::Short:
+          return isSigned ? (int64_t)(short)va_arg(args, int) : (int64_t)(unsigned short)va_arg(args, int);
+        case LengthModifier::Long:
+          return isSigned ? (int64_t)va_arg(args, long) : (int64_t)va_arg(args, unsigned long);
+        case LengthModifier::LongLong:
+          return isSigned ? (int64_t)va_arg(args, long long) : (int64_t)va_arg(args, unsigned long long);
+        case LengthModifier::IntMax:
+          return isSigned ? (int64_t)va_arg(args, intmax_t) : (int64_t)va_arg(args, uintmax_t);
+        case LengthModifier::Size:
+          return isSigned ? (int64_t)(std::make_signed_t<size_t>)va_arg(args, size_t) : (int64_t)va_arg(args, size_t);
+        case LengthModifier::PtrDiff:
+          return (int64_t)va_arg(args, ptrdiff_t);
+        default:
+          return isSigned ? (int64_t)va_arg(args, int) : (int64_t)va_arg(args, unsigned int);
+      }
+    }
+
+    class PayloadWriter
+    {
+    public:
+      PayloadWriter(uint8_t* data, size_t capacity)
+        : m_data(data)
+        , m_capacity(capacity)
+      {
+      }
+
+      bool Write(const void* value, size_t numBytes)
+      {
+        if (m_size + numBytes > m_capacity)
+          return false;
+
+        memcpy(m_data + m_size, value, numBytes);
+        m_size += numBytes;
+        return true;
+      }
+
+      template <typename T>
+      bool Write(T value)
+      {
+        return Write(&value, sizeof(T));
+      }
+
+      size_t GetSize() const { return m_size; }
+
+    private:
+      uint8_t* m_data = nullptr;
+      size_t m_capacity = 0;
+      size_t m_size = 0;
+    };
+
+    class PayloadReader
+    {
+    public:
+      PayloadReader(const uint8_t* data)
+        : m_data(data)
+      {
+      }
+
+      template <typename T>
+      T Read()
+      {
+        T value;
+        memcpy(&value, m_data + m_offset, sizeof(T));
+        m_offset += sizeof(T);
+        return value;
+      }
+
+      const char* ReadBytes(size_t numBytes)
+      {
+        const char* result = reinterpret_cast<const char*>(m_data + m_offset);
+        m_offset += numBytes;
+        return result;
+      }
+
+    private:
+      const uint8_t* m_data = nullptr;
+      size_t m_offset = 0;
+    };
+
+    /// Copies all arguments that 'formatStr' references. Returns false for unsupported conversions or if the arguments don't fit.
+    bool PackArguments(const char* formatStr, va_list& args, PayloadWriter& writer)
+    {
+      FormatSpec spec;
+      size_t pos = 0;
+
+      while (ParseNextSpec(formatStr, pos, spec))
+      {
+        pos = spec.m_end;
+
+        if (spec.m_conversion == '%')
+          continue;
+
+        int32_t precision = spec.m_precision;
+
+        for (uint8_t i = 0; i < spec.m_numStars; ++i)
+        {
+          const int32_t star = va_arg(args, int);
+          if (!writer.Write<int32_t>(star))
+            return false;
+
+          if (spec.m_hasStarPrecision && i + 1 == spec.m_numStars)
+          {
+            // a negative precision counts as none
+            precision = star;
+          }
+        }
+
+        if (IsIntegerConversion(spec.m_conversion))
+        {
+          if (!writer.Write<int64_t>(ReadIntegerArgument(spec, args)))
+            return false;
+        }
+        else if (IsFloatConversion(spec.m_conversion))
+        {
+          const double value = (spec.m_length == LengthModifier::LongDouble) ? (double)va_arg(args, long double) : va_arg(args, double);
+          if (!writer.Write<double>(value))
+            return false;
+        }
+        else if (spec.m_conversion == 'c' && spec.m_length == LengthModifier::None)
+        {
+          if (!writer.Write<int32_t>(va_arg(args, int)))
+            return false;
+        }
+        else if (spec.m_conversion == 's' && spec.m_length == LengthModifier::None)
+        {
+          const char* str = va_arg(args, const char*);
+          if (str == nullptr)
+            str = "(null)";
+
+          // with a precision, the string doesn't need to be null-terminated, e.g. '%.*s' for string views
+          size_t length = 0;
+          if (precision >= 0)
+          {
+            const void* terminator = memchr(str, '\0', (size_t)precision);
+            length = (terminator != nullptr) ? (const char*)terminator - str : (size_t)precision;
+          }
+          else
+          {
+            length = strlen(str);
+          }
+
+          if (length > 0xFFFF || !writer.Write<uint16_t>((uint16_t)length) || !writer.Write(str, length))
+            return false;
+        }
+        else if (spec.m_conversion == 'p')
+        {
+          if (!writer.Write<const void*>(va_arg(args, const void*)))
+            return false;
+        }
+        else
+        {
+          // %n, wide characters and malformed specifications
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    template <typename T>
+    int FormatArgument(char* buffer, size_t bufferSize, const char* spec, uint8_t numStars, const int32_t* stars, T value)
+    {
+      switch (numStars)
+      {
+        case 0:
+          return snprintf(buffer, bufferSize, spec, value);
+        case 1:
+          return snprintf(buffer, bufferSize, spec, stars[0], value);
+        default:
+          return snprintf(buffer, bufferSize, spec, stars[0], stars[1], value);
+      }
+    }
+
+    /// Formats the message like vsnprintf would, but takes the arguments from the payload written by PackArguments().
+    void UnpackAndFormat(const char* formatStr, const uint8_t* payload, char* buffer, size_t bufferSize)
+    {
+      PayloadReader reader(payload);
+
+      size_t written = 0;
+      auto append = [&](const char* text, size_t length)
+      {
+        const size_t numBytes = std::min(length, bufferSize - 1 - written);
+        memcpy(buffer + written, text, numBytes);
+        written += numBytes;
+      };
+
+      FormatSpec spec;
+      size_t pos = 0;
+
+      while (ParseNextSpec(formatStr, pos, spec))
+      {
+        append(formatStr + pos, spec.m_start - pos);
+        pos = spec.m_end;
+
+        if (spec.m_conversion == '%')
+        {
+          append("%", 1);
+          continue;
+        }
+
+        int32_t stars[2] = {};
+        for (uint8_t i = 0; i < spec.m_numStars; ++i)
+        {
+          stars[i] = reader.Read<int32_t>();
+        }
+
+        // the specification up to the length modifier, plus the length modifier and conversion that match the stored value
+        char specBuf[64];
+        const size_t prefixLength = std::min<size_t>(spec.m_lengthStart - spec.m_start, sizeof(specBuf) - 4);
+        memcpy(specBuf, formatStr + spec.m_start, prefixLength);
+        char* specEnd = specBuf + prefixLength;
+
+        char* target = buffer + written;
+        const size_t targetSize = bufferSize - written;
+
+        if (IsIntegerConversion(spec.m_conversion))
+        {
+          *specEnd++ = 'l';
+          *specEnd++ = 'l';
+          *specEnd++ = spec.m_conversion;
+          *specEnd = '\0';
+
+          const int64_t value = reader.Read<int64_t>();
+
+          if (spec.m_conversion == 'd' || spec.m_conversion == 'i')
+            FormatArgument<long long>(target, targetSize, specBuf, spec.m_numStars, stars, value);
+          else
+            FormatArgument<unsigned long long>(target, targetSize, specBuf, spec.m_numStars, stars, (uint64_t)value);
+        }
+        else if (IsFloatConversion(spec.m_conversion))
+        {
+          *specEnd++ = spec.m_conversion;
+          *specEnd = '\0';
+          FormatArgument<double>(target, targetSize, specBuf, spec.m_numStars, stars, reader.Read<double>());
+        }
+        else if (spec.m_conversion == 'c')
+        {
+          *specEnd++ = 'c';
+          *specEnd = '\0';
+          FormatArgument<int>(target, targetSize, specBuf, spec.m_numStars, stars, reader.Read<int32_t>());
+        }
+        else if (spec.m_conversion == 's')
+        {
+          *specEnd++ = 's';
+          *specEnd = '\0';
+
+          const uint16_t length = reader.Read<uint16_t>();
+          const char* str = reader.ReadBytes(length);
+
+          char strBuf[AsyncLogger::MAX_MESSAGE_LENGTH];
+          const size_t strLength = std::min<size_t>(length, sizeof(strBuf) - 1);
+          memcpy(strBuf, str, strLength);
+          strBuf[strLength] = '\0';
+
+          FormatArgument<const char*>(target, targetSize, specBuf, spec.m_numStars, stars, strBuf);
+        }
+        else if (spec.m_conversion == 'p')
+        {
+          *specEnd++ = 'p';
+          *specEnd = '\0';
+          FormatArgument<const void*>(target, targetSize, specBuf, spec.m_numStars, stars, reader.Read<const void*>());
+        }
+
+        written += strnlen(target, targetSize - 1);
+      }
+
+      append(formatStr + pos, strlen(formatStr + pos));
+      buffer[written] = '\0';
+    }
+  } // namespace
+
+  //////////////////////////////////////////////////////////////////////////
+
+  AsyncLogger::AsyncLogger(ILoggingInterface* target, uint32_t capacity /*= 1024*/)
+    : m_target(target)
+    , m_targetLogLevel(target != nullptr ? target->GetLogLevel() : LogLevel::None)
+  {
+    const uint32_t numMessages = std::bit_ceil(std::max<uint32_t>(capacity, 2));
+
+    m_messages = std::make_unique<Message[]>(numMessages);
+    m_capacityMask = numMessages - 1;
+
+    for (uint32_t i = 0; i < numMessages; ++i)
+    {
+      m_messages[i].m_sequence.store(i, std::memory_order_relaxed);
+    }
+
+    m_thread = std::thread(&AsyncLogger::ConsumerThread, this);
+  }
+
+  AsyncLogger::~AsyncLogger()
+  {
+    m_stop.store(true, std::memory_order_release);
+
+    // wake up the consumer thread
+    m_numQueuedMessages.fetch_add(1, std::memory_order_release);
+    m_numQueuedMessages.notify_one();
+
+    m_thread.join();
+  }
+
+  void AsyncLogger::LogInfo(const char* message)
+  {
+    EnqueueText(LogLevel::Info, message);
+  }
+
+  void AsyncLogger::LogWarning(const char* message)
+  {
+    EnqueueText(LogLevel::Warning, message);
+  }
+
+  void AsyncLogger::LogError(const char* message)
+  {
+    EnqueueText(LogLevel::Error, message);
+  }
+
+  LogLevel AsyncLogger::GetLogLevel() const
+  {
+    return m_targetLogLevel;
+  }
+
+  bool AsyncLogger::LogDeferred(LogLevel level, const char* formatStr, va_list args)
+  {
+    Message* message = BeginEnqueue();
+    if (message == nullptr)
+      return true;
+
+    message->m_level = level;
+    message->m_formatStr = formatStr;
+    message->m_isFormatted = false;
+
+    va_list argsCopy;
+    va_copy(argsCopy, args);
+    PayloadWriter writer(message->m_payload, PAYLOAD_SIZE);
+    const bool packed = PackArguments(formatStr, argsCopy, writer);
+    va_end(argsCopy);
+
+    if (packed)
+    {
+      message->m_payloadSize = static_cast<uint16_t>(writer.GetSize());
+    }
+    else
+    {
+      // arguments that can't be stored get formatted right away, the text might get truncated
+      va_copy(argsCopy, args);
+      vsnprintf(reinterpret_cast<char*>(message->m_payload), PAYLOAD_SIZE, formatStr, argsCopy);
+      va_end(argsCopy);
+
+      message->m_isFormatted = true;
+    }
+
+    EndEnqueue(message);
+    return true;
+  }
+
+  void AsyncLogger::Flush()
+  {
+    const uint64_t target = m_enqueuePosition.load(std::memory_order_acquire);
+
+    uint64_t position = m_dequeuePosition.load(std::memory_order_acquire);
+    while (position < target)
+    {
+      m_dequeuePosition.wait(position, std::memory_order_acquire);
+      position = m_dequeuePosition.load(std::memory_order_acquire);
+    }
+  }
+
+  AsyncLogger::Message* AsyncLogger::BeginEnqueue()
+  {
+    // bounded MPMC queue by Dmitry Vyukov, every slot's sequence number tells whether it is free for the given position
+    uint64_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+      Message* message = &m_messages[position & m_capacityMask];
+      const uint64_t sequence = message->m_sequence.load(std::memory_order_acquire);
+      const int64_t diff = (int64_t)sequence - (int64_t)position;
+
+      if (diff == 0)
+      {
+        if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+          return message;
+      }
+      else if (diff < 0)
+      {
+        // the slot still holds a message from the previous round, the queue is full
+        m_numDroppedMessages.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+      }
+      else
+      {
+        position = m_enqueuePosition.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  void AsyncLogger::EndEnqueue(Message* message)
+  {
+    const uint64_t position = message->m_sequence.load(std::memory_order_relaxed);
+    message->m_sequence.store(position + 1, std::memory_order_release);
+
+    m_numQueuedMessages.fetch_add(1, std::memory_order_release);
+    m_numQueuedMessages.notify_one();
+  }
+
+  void AsyncLogger::EnqueueText(LogLevel level, const char* text)
+  {
+    Message* message = BeginEnqueue();
+    if (message == nullptr)
+      return;
+
+    message->m_level = level;
+    message->m_formatStr = nullptr;
+    message->m_isFormatted = true;
+
+    const size_t length = std::min<size_t>(strlen(text), PAYLOAD_SIZE - 1);
+    memcpy(message->m_payload, text, length);
+    message->m_payload[length] = '\0';
+
+    EndEnqueue(message);
+  }
+
+  void AsyncLogger::ConsumerThread()
+  {
+    while (true)
+    {
+      const uint64_t numQueued = m_numQueuedMessages.load(std::memory_order_acquire);
+
+      uint64_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+      while (true)
+      {
+        Message& message = m_messages[position & m_capacityMask];
+        if (message.m_sequence.load(std::memory_order_acquire) != position + 1)
+          break;
+
+        ForwardMessage(message);
+
+        // free the slot for the next round
+        message.m_sequence.store(position + m_capacityMask + 1, std::memory_order_release);
+
+        ++position;
+        m_dequeuePosition.store(position, std::memory_order_release);
+        m_dequeuePosition.notify_all();
+      }
+
+      if (m_stop.load(std::memory_order_acquire))
+        return;
+
+      m_numQueuedMessages.wait(numQueued, std::memory_order_acquire);
+    }
+  }
+
+  void AsyncLogger::ForwardMessage(const Message& message)
+  {
+    if (!Log::IsEnabled(m_target, message.m_level))
+      return;
+
+    char msgBuf[MAX_MESSAGE_LENGTH];
+
+    if (message.m_isFormatted)
+    {
+      strncpy(msgBuf, reinterpret_cast<const char*>(message.m_payload), sizeof(msgBuf) - 1);
+      msgBuf[sizeof(msgBuf) - 1] = '\0';
+    }
+    else
+    {
+      UnpackAndFormat(message.m_formatStr, message.m_payload, msgBuf, sizeof(msgBuf));
+    }
+
+    switch (message.m_level)
+    {
+      case LogLevel::Info:
+        m_target->LogInfo(msgBuf);
+        break;
+      case LogLevel::Warning:
+        m_target->LogWarning(msgBuf);
+        break;
+      default:
+        m_target->LogError(msgBuf);
+        break;
+    }
+  }
+
+} // namespace Hydra::Runtime
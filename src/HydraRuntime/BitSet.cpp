@@ -8,7 +8,7 @@ namespace Hydra::Runtime
   {
     if (m_blockCapacity > 1)
     {
-      DeallocateBlocks(m_externalData);
+      DeallocateBlocks(m_externalData, m_blockCapacity);
       m_blockCapacity = 1;
       m_externalData = nullptr;
     }
@@ -66,7 +66,7 @@ namespace Hydra::Runtime
 
     if (oldCapacity > 1)
     {
-      DeallocateBlocks(oldData);
+      DeallocateBlocks(oldData, oldCapacity);
     }
 
     m_blockCount = newBlockCount;
@@ -120,7 +120,7 @@ namespace Hydra::Runtime
     {
       if (m_blockCapacity > 1)
       {
-        DeallocateBlocks(m_externalData);
+        DeallocateBlocks(m_externalData, m_blockCapacity);
       }
 
       m_blockCapacity = other.m_blockCapacity;
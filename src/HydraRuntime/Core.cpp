@@ -1,18 +1,81 @@
 #include <HydraRuntime/Core.h>
 
+#include <cassert>
+#include <cstring>
 #include <stdlib.h>
 
+#ifdef _MSC_VER
+#  include <intrin.h>
+#endif
+
 namespace Hydra::Runtime
 {
-  void* DefaultAlloc(size_t numBytes)
+  class DefaultAllocator : public IAllocator
   {
-    return ::malloc(numBytes);
-  }
+  public:
+    virtual void* Allocate(size_t numBytes, size_t alignment) override
+    {
+      if (alignment <= Core::DEFAULT_ALIGNMENT)
+        return ::malloc(numBytes);
+
+#ifdef _MSC_VER
+      return ::_aligned_malloc(numBytes, alignment);
+#else
+      // aligned_alloc requires the size to be a multiple of the alignment
+      return ::aligned_alloc(alignment, (numBytes + alignment - 1) & ~(alignment - 1));
+#endif
+    }
+
+    virtual void Deallocate(void* ptr, size_t, [[maybe_unused]] size_t alignment) override
+    {
+#ifdef _MSC_VER
+      if (alignment > Core::DEFAULT_ALIGNMENT)
+      {
+        ::_aligned_free(ptr);
+        return;
+      }
+#endif
+
+      ::free(ptr);
+    }
+  };
 
-  void DefaultDealloc(void* ptr)
+  /// Wraps the functions passed to Core::SetCustomFunctions().
+  class FunctionAllocator : public IAllocator
   {
-    ::free(ptr);
-  }
+  public:
+    virtual void* Allocate(size_t numBytes, size_t alignment) override
+    {
+      if (alignment <= Core::DEFAULT_ALIGNMENT)
+        return m_allocateFunc.load(std::memory_order_relaxed)(numBytes);
+
+      // over-allocate and store the original pointer right in front of the aligned memory
+      uint8_t* rawPtr = static_cast<uint8_t*>(m_allocateFunc.load(std::memory_order_relaxed)(numBytes + alignment + sizeof(void*)));
+      if (rawPtr == nullptr)
+        return nullptr;
+
+      const uintptr_t alignedAddress = (reinterpret_cast<uintptr_t>(rawPtr) + sizeof(void*) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+      void** alignedPtr = reinterpret_cast<void**>(alignedAddress);
+      alignedPtr[-1] = rawPtr;
+      return alignedPtr;
+    }
+
+    virtual void Deallocate(void* ptr, size_t, size_t alignment) override
+    {
+      if (ptr != nullptr && alignment > Core::DEFAULT_ALIGNMENT)
+      {
+        ptr = static_cast<void**>(ptr)[-1];
+      }
+
+      m_deallocateFunc.load(std::memory_order_relaxed)(ptr);
+    }
+
+    std::atomic<Core::AllocateFunc> m_allocateFunc = nullptr;
+    std::atomic<Core::DeallocateFunc> m_deallocateFunc = nullptr;
+  };
+
+  static DefaultAllocator s_defaultAllocator;
+  static FunctionAllocator s_functionAllocator;
 
   // MurmurHash3_x86_32 :
   // https://github.com/aappleby/smhasher/blob/master/src/MurmurHash3.cpp
@@ -22,7 +85,7 @@ namespace Hydra::Runtime
     return (x << r) | (x >> (32 - r));
   }
 
-  uint32_t DefaultHash(const void* ptr, size_t numBytes)
+  uint32_t Core::MurmurHash3(const void* ptr, size_t numBytes)
   {
     const uint8_t* data = (const uint8_t*)ptr;
     const int numBlocks = static_cast<int>(numBytes) / 4;
@@ -84,24 +147,173 @@ namespace Hydra::Runtime
     return h1;
   }
 
+  // 64 bit hash in the style of wyhash (https://github.com/wangyi-fudan/wyhash):
+  // every step folds a 128 bit product of two 64 bit words, long inputs are processed in three independent 16 byte lanes.
+
+  static uint64_t Read64(const uint8_t* ptr)
+  {
+    uint64_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+  }
+
+  static uint64_t Read32(const uint8_t* ptr)
+  {
+    uint32_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+  }
+
+  static uint64_t Read1To3(const uint8_t* ptr, size_t numBytes)
+  {
+    return (uint64_t(ptr[0]) << 16) | (uint64_t(ptr[numBytes >> 1]) << 8) | ptr[numBytes - 1];
+  }
+
+  /// Multiplies a and b to 128 bits and returns the low and high half in a and b.
+  static void MultiplyFull(uint64_t& a, uint64_t& b)
+  {
+#if defined(__SIZEOF_INT128__)
+    const __uint128_t product = __uint128_t(a) * b;
+    a = uint64_t(product);
+    b = uint64_t(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    a = _umul128(a, b, &b);
+#else
+    const uint64_t aHigh = a >> 32, aLow = uint32_t(a);
+    const uint64_t bHigh = b >> 32, bLow = uint32_t(b);
+    const uint64_t highHigh = aHigh * bHigh, highLow = aHigh * bLow;
+    const uint64_t lowHigh = aLow * bHigh, lowLow = aLow * bLow;
+    const uint64_t middle = highLow + lowHigh;
+    const uint64_t carryMiddle = (middle < highLow) ? (1ull << 32) : 0;
+    const uint64_t low = lowLow + (middle << 32);
+    a = low;
+    b = highHigh + (middle >> 32) + carryMiddle + (low < lowLow ? 1 : 0);
+#endif
+  }
+
+  static uint64_t Mix(uint64_t a, uint64_t b)
+  {
+    MultiplyFull(a, b);
+    return a ^ b;
+  }
+
+  uint64_t Core::DefaultHash64(const void* ptr, size_t numBytes, uint64_t seed)
+  {
+    constexpr uint64_t secret[4] = {0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull};
+
+    const uint8_t* data = static_cast<const uint8_t*>(ptr);
+    seed ^= Mix(seed ^ secret[0], secret[1]);
+
+    uint64_t a = 0;
+    uint64_t b = 0;
+
+    if (numBytes <= 16)
+    {
+      if (numBytes >= 4)
+      {
+        // two (possibly overlapping) pairs of 4 byte reads cover everything up to 16 bytes
+        const size_t offset = (numBytes >> 3) << 2;
+        a = (Read32(data) << 32) | Read32(data + offset);
+        b = (Read32(data + numBytes - 4) << 32) | Read32(data + numBytes - 4 - offset);
+      }
+      else if (numBytes > 0)
+      {
+        a = Read1To3(data, numBytes);
+      }
+    }
+    else
+    {
+      size_t remaining = numBytes;
+
+      if (remaining > 48)
+      {
+        uint64_t lane1 = seed;
+        uint64_t lane2 = seed;
+
+        do
+        {
+          seed = Mix(Read64(data) ^ secret[1], Read64(data + 8) ^ seed);
+          lane1 = Mix(Read64(data + 16) ^ secret[2], Read64(data + 24) ^ lane1);
+          lane2 = Mix(Read64(data + 32) ^ secret[3], Read64(data + 40) ^ lane2);
+          data += 48;
+          remaining -= 48;
+        } while (remaining > 48);
+
+        seed ^= lane1 ^ lane2;
+      }
+
+      while (remaining > 16)
+      {
+        seed = Mix(Read64(data) ^ secret[1], Read64(data + 8) ^ seed);
+        data += 16;
+        remaining -= 16;
+      }
+
+      // the last 16 bytes, overlapping with already processed data if necessary
+      a = Read64(data + remaining - 16);
+      b = Read64(data + remaining - 8);
+    }
+
+    a ^= secret[1];
+    b ^= seed;
+    MultiplyFull(a, b);
+    return Mix(a ^ secret[0] ^ numBytes, b ^ secret[1]);
+  }
+
+  uint32_t Core::DefaultHash(const void* ptr, size_t numBytes)
+  {
+    const uint64_t hash = DefaultHash64(ptr, numBytes, 0);
+    return static_cast<uint32_t>(hash ^ (hash >> 32));
+  }
+
   //////////////////////////////////////////////////////////////////////////
 
-  Core::AllocateFunc Core::s_allocateFunc = DefaultAlloc;
-  Core::DeallocateFunc Core::s_deallocateFunc = DefaultDealloc;
-  Core::HashFunc Core::s_hashFunc = DefaultHash;
+  std::atomic<IAllocator*> Core::s_allocator = &s_defaultAllocator;
+  thread_local IAllocator* Core::s_threadAllocator = nullptr;
+  std::atomic<Core::HashFunc> Core::s_hashFunc = DefaultHash;
+  std::atomic<Core::Hash64Func> Core::s_hash64Func = DefaultHash64;
+
+  IAllocator* Core::GetAllocator()
+  {
+    if (s_threadAllocator != nullptr)
+      return s_threadAllocator;
+
+    return s_allocator.load(std::memory_order_acquire);
+  }
+
+  void Core::SetAllocator(IAllocator* allocator)
+  {
+    s_allocator.store(allocator != nullptr ? allocator : &s_defaultAllocator, std::memory_order_release);
+  }
 
   void Core::SetDefaultFunctions()
   {
-    s_allocateFunc = DefaultAlloc;
-    s_deallocateFunc = DefaultDealloc;
-    s_hashFunc = DefaultHash;
+    SetAllocator(nullptr);
+    s_hashFunc.store(DefaultHash, std::memory_order_relaxed);
+    s_hash64Func.store(DefaultHash64, std::memory_order_relaxed);
   }
 
   void Core::SetCustomFunctions(AllocateFunc allocateFunc, DeallocateFunc deallocateFunc, HashFunc hashFunc)
   {
-    s_allocateFunc = allocateFunc;
-    s_deallocateFunc = deallocateFunc;
-    s_hashFunc = hashFunc;
+    assert((allocateFunc == nullptr) == (deallocateFunc == nullptr) && "allocate and deallocate functions have to be replaced together");
+
+    if (allocateFunc != nullptr)
+    {
+      s_functionAllocator.m_allocateFunc.store(allocateFunc, std::memory_order_relaxed);
+      s_functionAllocator.m_deallocateFunc.store(deallocateFunc, std::memory_order_relaxed);
+      SetAllocator(&s_functionAllocator);
+    }
+    else
+    {
+      SetAllocator(nullptr);
+    }
+
+    s_hashFunc.store(hashFunc != nullptr ? hashFunc : DefaultHash, std::memory_order_relaxed);
+  }
+
+  void Core::SetCustomHash64Function(Hash64Func hash64Func)
+  {
+    s_hash64Func.store(hash64Func != nullptr ? hash64Func : DefaultHash64, std::memory_order_relaxed);
   }
 
 } // namespace Hydra::Runtime
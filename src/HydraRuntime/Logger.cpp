@@ -5,60 +5,63 @@
 
 namespace Hydra::Runtime
 {
-  void Log::Info(ILoggingInterface* logger, const char* formatStr, ...)
+  static void LogMessage(ILoggingInterface* logger, LogLevel level, const char* formatStr, va_list args)
   {
-    if (logger != nullptr)
-    {
-      char msgBuf[1024];
+    if (logger->LogDeferred(level, formatStr, args))
+      return;
+
+    char msgBuf[1024];
 
-      va_list args;
-      va_start(args, formatStr);
 #ifdef _MSC_VER
-      vsnprintf_s(msgBuf, sizeof(msgBuf), formatStr, args);
+    vsnprintf_s(msgBuf, sizeof(msgBuf), formatStr, args);
 #else
-      vsnprintf(msgBuf, sizeof(msgBuf), formatStr, args);
+    vsnprintf(msgBuf, sizeof(msgBuf), formatStr, args);
 #endif
-      va_end(args);
 
-      logger->LogInfo(msgBuf);
+    switch (level)
+    {
+      case LogLevel::Info:
+        logger->LogInfo(msgBuf);
+        break;
+      case LogLevel::Warning:
+        logger->LogWarning(msgBuf);
+        break;
+      default:
+        logger->LogError(msgBuf);
+        break;
     }
   }
 
-  void Log::Warning(ILoggingInterface* logger, const char* formatStr, ...)
+  void Log::Info(ILoggingInterface* logger, const char* formatStr, ...)
   {
-    if (logger != nullptr)
+    if (IsEnabled(logger, LogLevel::Info))
     {
-      char msgBuf[1024];
-
       va_list args;
       va_start(args, formatStr);
-#ifdef _MSC_VER
-      vsnprintf_s(msgBuf, sizeof(msgBuf), formatStr, args);
-#else
-      vsnprintf(msgBuf, sizeof(msgBuf), formatStr, args);
-#endif
+      LogMessage(logger, LogLevel::Info, formatStr, args);
       va_end(args);
+    }
+  }
 
-      logger->LogWarning(msgBuf);
+  void Log::Warning(ILoggingInterface* logger, const char* formatStr, ...)
+  {
+    if (IsEnabled(logger, LogLevel::Warning))
+    {
+      va_list args;
+      va_start(args, formatStr);
+      LogMessage(logger, LogLevel::Warning, formatStr, args);
+      va_end(args);
     }
   }
 
   void Log::Error(ILoggingInterface* logger, const char* formatStr, ...)
   {
-    if (logger != nullptr)
+    if (IsEnabled(logger, LogLevel::Error))
     {
-      char msgBuf[1024];
-
       va_list args;
       va_start(args, formatStr);
-#ifdef _MSC_VER
-      vsnprintf_s(msgBuf, sizeof(msgBuf), formatStr, args);
-#else
-      vsnprintf(msgBuf, sizeof(msgBuf), formatStr, args);
-#endif
+      LogMessage(logger, LogLevel::Error, formatStr, args);
       va_end(args);
-
-      logger->LogError(msgBuf);
     }
   }
 
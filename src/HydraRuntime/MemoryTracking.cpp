@@ -0,0 +1,74 @@
+#include <HydraRuntime/Logger.h>
+#include <HydraRuntime/MemoryTracking.h>
+
+namespace Hydra::Runtime
+{
+  MemoryTracking::TagCounters MemoryTracking::s_counters[(size_t)MemoryTag::ENUM_COUNT];
+
+  MemoryTagStats MemoryTracking::GetStats(MemoryTag tag)
+  {
+    const TagCounters& counters = s_counters[(size_t)tag];
+
+    MemoryTagStats stats;
+    stats.m_liveBytes = counters.m_liveBytes.load(std::memory_order_relaxed);
+    stats.m_peakBytes = counters.m_peakBytes.load(std::memory_order_relaxed);
+    stats.m_numLiveAllocations = counters.m_numLiveAllocations.load(std::memory_order_relaxed);
+    stats.m_numTotalAllocations = counters.m_numTotalAllocations.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+  const char* MemoryTracking::GetTagName(MemoryTag tag)
+  {
+    switch (tag)
+    {
+      case MemoryTag::BitSet:
+        return "BitSet";
+      case MemoryTag::FileCache:
+        return "FileCache";
+      case MemoryTag::ShaderText:
+        return "ShaderText";
+      case MemoryTag::TextPieces:
+        return "TextPieces";
+      case MemoryTag::ManagerTables:
+        return "ManagerTables";
+      case MemoryTag::ShaderLibrary:
+        return "ShaderLibrary";
+      case MemoryTag::Other:
+        return "Other";
+      default:
+        return "<unknown>";
+    }
+  }
+
+  uint64_t MemoryTracking::GetTotalLiveBytes()
+  {
+    uint64_t totalBytes = 0;
+
+    for (const TagCounters& counters : s_counters)
+    {
+      totalBytes += counters.m_liveBytes.load(std::memory_order_relaxed);
+    }
+
+    return totalBytes;
+  }
+
+  void MemoryTracking::ResetPeaks()
+  {
+    for (TagCounters& counters : s_counters)
+    {
+      counters.m_peakBytes.store(counters.m_liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+  }
+
+  void MemoryTracking::DumpToLog(ILoggingInterface* logger)
+  {
+    for (size_t i = 0; i < (size_t)MemoryTag::ENUM_COUNT; ++i)
+    {
+      const MemoryTagStats stats = GetStats((MemoryTag)i);
+      Log::Info(logger, "%s: %llu bytes live (peak %llu) in %llu allocations (%llu total)", GetTagName((MemoryTag)i), (unsigned long long)stats.m_liveBytes, (unsigned long long)stats.m_peakBytes, (unsigned long long)stats.m_numLiveAllocations, (unsigned long long)stats.m_numTotalAllocations);
+    }
+
+    Log::Info(logger, "Total: %llu bytes live", (unsigned long long)GetTotalLiveBytes());
+  }
+
+} // namespace Hydra::Runtime
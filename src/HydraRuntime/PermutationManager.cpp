@@ -1,6 +1,8 @@
 #include <HydraRuntime/PermutationManager.h>
+#include <HydraRuntime/Profiler.h>
 
 #include <string>
+#include <unordered_map>
 
 namespace Hydra::Runtime
 {
@@ -82,8 +84,9 @@ namespace Hydra::Runtime
 
   //////////////////////////////////////////////////////////////////////////
 
-  PermutationManager::PermutationManager(ILoggingInterface* logger /*= nullptr*/)
-    : m_logger(logger)
+  PermutationManager::PermutationManager(ILoggingInterface* logger /*= nullptr*/, SymbolTable* symbolTable /*= nullptr*/)
+    : m_symbolTable(symbolTable != nullptr ? symbolTable : &SymbolTable::GetGlobal())
+    , m_logger(logger)
   {
   }
 
@@ -134,10 +137,274 @@ namespace Hydra::Runtime
     return nullptr;
   }
 
+  const PermutationVariableEntry* PermutationManager::GetVariableBySymbol(SymbolId nameSymbol) const
+  {
+    if (auto varIt = m_symbolToVariable.find(nameSymbol); varIt != m_symbolToVariable.end())
+    {
+      return varIt->second;
+    }
+
+    return nullptr;
+  }
+
   Result PermutationManager::FinalizeState(const PermutationVariableState& state, const PermutationVariableSet& usedVariablesSet, PermutationVariableSelection& out_selection) const
+  {
+    HYDRA_PROFILE_SCOPE("FinalizeState");
+
+    if (!m_statistics.IsEnabled())
+      return FinalizeStateInternal(state, usedVariablesSet, out_selection, m_logger, false);
+
+    const Result result = FinalizeStateInternal(state, usedVariablesSet, out_selection, m_logger, true);
+    m_statistics.RecordFinalize(usedVariablesSet, out_selection, result.Succeeded());
+    return result;
+  }
+
+  void PermutationManager::SetStatisticsEnabled(bool enabled)
+  {
+    m_statistics.SetEnabled(enabled);
+  }
+
+  bool PermutationManager::IsStatisticsEnabled() const
+  {
+    return m_statistics.IsEnabled();
+  }
+
+  PermutationStatistics PermutationManager::GetStatistics() const
+  {
+    return m_statistics.GetSnapshot();
+  }
+
+  void PermutationManager::ResetStatistics()
+  {
+    m_statistics.Reset();
+  }
+
+  Result PermutationManager::AddImplication(const PermutationVariableEntry& ifVariable, int ifValue, const PermutationVariableEntry& thenVariable, int thenValue)
+  {
+    assert(&ifVariable.m_manager == this && &thenVariable.m_manager == this);
+
+    CanonicalizationRule rule;
+    rule.m_conditionStartBitIndex = ifVariable.m_startBitIndex;
+    rule.m_conditionNumBits = ifVariable.m_numBits;
+    rule.m_targetStartBitIndex = thenVariable.m_startBitIndex;
+    rule.m_targetNumBits = thenVariable.m_numBits;
+
+    if (ifVariable.GetEncodedValue(ifValue, rule.m_conditionEncodedValue).Failed())
+    {
+      Log::Error(m_logger, "%d is not a valid value for permutation variable '%s'", ifValue, ifVariable.m_name.c_str());
+      return HYDRA_FAILURE;
+    }
+
+    if (thenVariable.GetEncodedValue(thenValue, rule.m_targetEncodedValue).Failed())
+    {
+      Log::Error(m_logger, "%d is not a valid value for permutation variable '%s'", thenValue, thenVariable.m_name.c_str());
+      return HYDRA_FAILURE;
+    }
+
+    m_canonicalizationRules.push_back(rule);
+    return HYDRA_SUCCESS;
+  }
+
+  Result PermutationManager::AddDontCareRule(const PermutationVariableEntry& ignoredVariable, const PermutationVariableEntry& whenVariable, int whenValue)
+  {
+    const int canonicalValue = ignoredVariable.m_hasDefaultValue ? ignoredVariable.m_defaultValue : ignoredVariable.GetValueInt(0);
+    return AddImplication(whenVariable, whenValue, ignoredVariable, canonicalValue);
+  }
+
+  Result PermutationManager::AddMutuallyExclusiveGroup(std::span<const PermutationVariableEntry* const> variables)
+  {
+    ExclusiveGroup group;
+
+    for (const PermutationVariableEntry* variable : variables)
+    {
+      assert(&variable->m_manager == this);
+
+      if (variable->m_type != PermutationVariableEntry::Type::Bool)
+      {
+        Log::Error(m_logger, "Permutation variable '%s' can't be part of a mutually exclusive group, because it is not a bool", variable->m_name.c_str());
+        return HYDRA_FAILURE;
+      }
+
+      group.m_mask.SetBitOnes(variable->m_startBitIndex, variable->m_numBits);
+      group.m_variables.push_back(variable);
+    }
+
+    m_exclusiveGroups.push_back(std::move(group));
+    return HYDRA_SUCCESS;
+  }
+
+  Result PermutationManager::RegisterDerivedVariable(const PermutationVariableEntry& variable, std::span<const PermutationVariableEntry* const> inputs, DeriveValueFunc deriveFunc)
+  {
+    assert(&variable.m_manager == this);
+
+    if (IsDerivedVariable(variable))
+    {
+      Log::Error(m_logger, "Permutation variable '%s' is already a derived variable", variable.m_name.c_str());
+      return HYDRA_FAILURE;
+    }
+
+    if (!deriveFunc)
+    {
+      Log::Error(m_logger, "No function given to compute derived permutation variable '%s'", variable.m_name.c_str());
+      return HYDRA_FAILURE;
+    }
+
+    for (const DerivedVariable& derived : m_derivedVariables)
+    {
+      if (std::find(derived.m_inputs.begin(), derived.m_inputs.end(), &variable) != derived.m_inputs.end())
+      {
+        Log::Error(m_logger, "Permutation variable '%s' is already an input of derived variable '%s', derived variables must be registered before the derived variables that use them", variable.m_name.c_str(), derived.m_variable->m_name.c_str());
+        return HYDRA_FAILURE;
+      }
+    }
+
+    DerivedVariable derivedVariable;
+    derivedVariable.m_variable = &variable;
+    derivedVariable.m_inputs.assign(inputs.begin(), inputs.end());
+    derivedVariable.m_deriveFunc = std::move(deriveFunc);
+
+    for (const PermutationVariableEntry* input : inputs)
+    {
+      assert(&input->m_manager == this);
+
+      if (input == &variable)
+      {
+        Log::Error(m_logger, "Derived permutation variable '%s' can't use itself as an input", variable.m_name.c_str());
+        return HYDRA_FAILURE;
+      }
+
+      auto derivedIt = std::find_if(m_derivedVariables.begin(), m_derivedVariables.end(), [&](const DerivedVariable& derived)
+        { return derived.m_variable == input; });
+
+      derivedVariable.m_derivedInputIndices.push_back(derivedIt != m_derivedVariables.end() ? static_cast<int32_t>(derivedIt - m_derivedVariables.begin()) : -1);
+    }
+
+    m_derivedVariables.push_back(std::move(derivedVariable));
+    m_derivedVariablesMask.SetBitOnes(variable.m_startBitIndex, variable.m_numBits);
+    return HYDRA_SUCCESS;
+  }
+
+  bool PermutationManager::IsDerivedVariable(const PermutationVariableEntry& variable) const
+  {
+    const BitSet::BlockType block = m_derivedVariablesMask.GetBlockOrEmpty(variable.m_startBitIndex / BitSet::BITS_PER_BLOCK);
+    return ((block >> (variable.m_startBitIndex & BitSet::BIT_INDEX_MASK)) & 1) != 0;
+  }
+
+  uint32_t PermutationManager::EnumeratePermutations(const PermutationVariableSet& usedVariablesSet, EnumeratePermutationsCallback callback) const
+  {
+    std::vector<const PermutationVariableEntry*> variables;
+    usedVariablesSet.Iterate([&](const PermutationVariableEntry& variable)
+      { variables.push_back(&variable); });
+
+    // derived variables are not enumerated themselves, but all their inputs are
+    for (size_t i = 0; i < variables.size();)
+    {
+      auto derivedIt = std::find_if(m_derivedVariables.begin(), m_derivedVariables.end(), [&](const DerivedVariable& derived)
+        { return derived.m_variable == variables[i]; });
+
+      if (derivedIt == m_derivedVariables.end())
+      {
+        ++i;
+        continue;
+      }
+
+      variables.erase(variables.begin() + i);
+
+      for (const PermutationVariableEntry* input : derivedIt->m_inputs)
+      {
+        if (std::find(variables.begin(), variables.end(), input) == variables.end())
+        {
+          variables.push_back(input);
+        }
+      }
+    }
+
+    std::vector<uint32_t> encodedValues(variables.size(), 0);
+
+    std::vector<PermutationVariableSelection> distinctSelections;
+    std::unordered_multimap<uint32_t, size_t> hashToSelection;
+
+    PermutationVariableState state;
+    PermutationVariableSelection selection;
+
+    while (true)
+    {
+      state.Clear();
+      for (size_t i = 0; i < variables.size(); ++i)
+      {
+        state.SetVariableInternal(*variables[i], encodedValues[i]);
+      }
+
+      if (FinalizeStateInternal(state, usedVariablesSet, selection, nullptr, false).Succeeded())
+      {
+        bool isNew = true;
+
+        auto range = hashToSelection.equal_range(selection.Hash());
+        for (auto it = range.first; it != range.second; ++it)
+        {
+          if (distinctSelections[it->second] == selection)
+          {
+            isNew = false;
+            break;
+          }
+        }
+
+        if (isNew)
+        {
+          hashToSelection.insert({selection.Hash(), distinctSelections.size()});
+          distinctSelections.push_back(selection);
+
+          if (callback)
+          {
+            callback(selection);
+          }
+        }
+      }
+
+      // advance to the next combination, like a counter where each digit has a different base
+      size_t digit = 0;
+      for (; digit < variables.size(); ++digit)
+      {
+        const PermutationVariableEntry& variable = *variables[digit];
+        const uint32_t numValues = (variable.m_type == PermutationVariableEntry::Type::Bool) ? 2 : static_cast<uint32_t>(variable.m_allowedValues.size());
+
+        if (++encodedValues[digit] < numValues)
+          break;
+
+        encodedValues[digit] = 0;
+      }
+
+      if (digit == variables.size())
+        break;
+    }
+
+    return static_cast<uint32_t>(distinctSelections.size());
+  }
+
+  Result PermutationManager::FinalizeStateInternal(const PermutationVariableState& state, const PermutationVariableSet& usedVariablesSet, PermutationVariableSelection& out_selection, ILoggingInterface* logger, bool recordStatistics) const
   {
     out_selection.Clear();
 
+    bool usesDerivedVariables = false;
+
+    if (!m_derivedVariables.empty())
+    {
+      const uint32_t blockEnd = std::min(m_derivedVariablesMask.GetBlockEndOffset(), usedVariablesSet.m_mask.GetBlockEndOffset());
+
+      for (uint32_t blockIndex = m_derivedVariablesMask.GetBlockStartOffset(); blockIndex < blockEnd; ++blockIndex)
+      {
+        const BitSet::BlockType derivedBlock = m_derivedVariablesMask.GetBlockOrEmpty(blockIndex);
+        usesDerivedVariables |= (derivedBlock & usedVariablesSet.m_mask.GetBlockOrEmpty(blockIndex)) != 0;
+
+        // the set was built before one of its variables became derived, see PermutationVariableSet::AddVariable()
+        if (const BitSet::BlockType staleBits = derivedBlock & usedVariablesSet.m_requiredMask.GetBlockOrEmpty(blockIndex); staleBits != 0)
+        {
+          Log::Error(logger, "The used variables set was built before '%s' became a derived variable and has to be built again", GetVariable(blockIndex * BitSet::BITS_PER_BLOCK + firstBitLow(staleBits))->m_name.c_str());
+          return HYDRA_FAILURE;
+        }
+      }
+    }
+
     auto missingValuesCallback = [&](uint32_t baseBitIndex, BitSet::BlockType missingBits)
     {
       while (missingBits > 0)
@@ -147,14 +414,26 @@ namespace Hydra::Runtime
         const uint32_t bitIndex = baseBitIndex + i;
         auto variable = GetVariable(bitIndex);
 
-        Log::Error(m_logger, "Permutation variable '%s' is not set in state and has no default value", variable->m_name.c_str());
+        Log::Error(logger, "Permutation variable '%s' is not set in state and has no default value", variable->m_name.c_str());
+
+        if (recordStatistics)
+        {
+          m_statistics.RecordMissingValue(*variable);
+        }
 
         const BitSet::BlockType mask = ((1ull << variable->m_numBits) - 1) << i;
         missingBits &= ~mask;
       }
     };
 
-    if (PermutationVariableState::MergeInternal(m_defaultState, state, usedVariablesSet, out_selection.m_values, out_selection.m_valuesMask, missingValuesCallback).Failed())
+    if (PermutationVariableState::MergeSetDefaultsInternal(state, usedVariablesSet, out_selection.m_values, out_selection.m_valuesMask, missingValuesCallback).Failed())
+      return HYDRA_FAILURE;
+
+    // derived variables aren't required, their values are computed straight into the selection
+    if (usesDerivedVariables && ComputeDerivedValues(state, usedVariablesSet, out_selection, logger).Failed())
+      return HYDRA_FAILURE;
+
+    if (ApplyConstraints(out_selection, logger).Failed())
       return HYDRA_FAILURE;
 
     out_selection.m_manager = this;
@@ -162,6 +441,194 @@ namespace Hydra::Runtime
     return HYDRA_SUCCESS;
   }
 
+  Result PermutationManager::ApplyConstraints(PermutationVariableSelection& selection, ILoggingInterface* logger) const
+  {
+    const BitSet& values = selection.m_values;
+    const BitSet& valuesMask = selection.m_valuesMask;
+
+    auto isVariableSet = [&](uint32_t startBitIndex)
+    {
+      const BitSet::BlockType block = valuesMask.GetBlockOrEmpty(startBitIndex / BitSet::BITS_PER_BLOCK);
+      return ((block >> (startBitIndex & BitSet::BIT_INDEX_MASK)) & 1) != 0;
+    };
+
+    // rules may enable each other, so repeat until nothing changes anymore, but don't loop forever on contradicting rules
+    for (size_t pass = 0; pass <= m_canonicalizationRules.size(); ++pass)
+    {
+      bool changed = false;
+
+      for (const CanonicalizationRule& rule : m_canonicalizationRules)
+      {
+        if (!isVariableSet(rule.m_conditionStartBitIndex) || !isVariableSet(rule.m_targetStartBitIndex))
+          continue;
+
+        if (values.GetBitValues(rule.m_conditionStartBitIndex, rule.m_conditionNumBits) != rule.m_conditionEncodedValue)
+          continue;
+
+        if (values.GetBitValues(rule.m_targetStartBitIndex, rule.m_targetNumBits) == rule.m_targetEncodedValue)
+          continue;
+
+        selection.m_values.SetBitValues(rule.m_targetStartBitIndex, rule.m_targetNumBits, rule.m_targetEncodedValue);
+        changed = true;
+      }
+
+      if (!changed)
+        break;
+    }
+
+    for (const ExclusiveGroup& group : m_exclusiveGroups)
+    {
+      uint32_t numSet = 0;
+
+      for (uint32_t blockIndex = group.m_mask.GetBlockStartOffset(); blockIndex < group.m_mask.GetBlockEndOffset(); ++blockIndex)
+      {
+        numSet += std::popcount(group.m_mask.GetBlockOrEmpty(blockIndex) & values.GetBlockOrEmpty(blockIndex) & valuesMask.GetBlockOrEmpty(blockIndex));
+      }
+
+      if (numSet > 1)
+      {
+        std::string names;
+        for (const PermutationVariableEntry* variable : group.m_variables)
+        {
+          if (isVariableSet(variable->m_startBitIndex) && values.GetBitValue(variable->m_startBitIndex))
+          {
+            names += names.empty() ? "" : ", ";
+            names += variable->m_name;
+          }
+        }
+
+        Log::Error(logger, "Mutually exclusive permutation variables are set at the same time: %s", names.c_str());
+        return HYDRA_FAILURE;
+      }
+    }
+
+    return HYDRA_SUCCESS;
+  }
+
+  Result PermutationManager::ComputeDerivedValues(const PermutationVariableState& state, const PermutationVariableSet& usedVariablesSet, PermutationVariableSelection& inout_selection, ILoggingInterface* logger) const
+  {
+    auto isVariableInMask = [](const BitSet& mask, const PermutationVariableEntry& variable)
+    {
+      const BitSet::BlockType block = mask.GetBlockOrEmpty(variable.m_startBitIndex / BitSet::BITS_PER_BLOCK);
+      return ((block >> (variable.m_startBitIndex & BitSet::BIT_INDEX_MASK)) & 1) != 0;
+    };
+
+    auto getValue = [&](const PermutationVariableEntry& variable, uint32_t& out_encodedValue)
+    {
+      const PermutationVariableState* sources[] = {&state, &m_defaultState};
+      for (const PermutationVariableState* source : sources)
+      {
+        if (isVariableInMask(source->m_valuesMask, variable))
+        {
+          out_encodedValue = source->m_values.GetBitValues(variable.m_startBitIndex, variable.m_numBits);
+          return true;
+        }
+      }
+
+      return false;
+    };
+
+    const size_t numDerived = m_derivedVariables.size();
+
+    constexpr size_t MAX_INLINE_DERIVED = 32;
+    uint8_t inlineIsNeeded[MAX_INLINE_DERIVED];
+    int inlineDerivedValues[MAX_INLINE_DERIVED];
+    std::vector<uint8_t> heapIsNeeded;
+    std::vector<int> heapDerivedValues;
+
+    uint8_t* isNeeded = inlineIsNeeded;
+    int* derivedValues = inlineDerivedValues;
+    if (numDerived > MAX_INLINE_DERIVED)
+    {
+      heapIsNeeded.resize(numDerived);
+      heapDerivedValues.resize(numDerived);
+      isNeeded = heapIsNeeded.data();
+      derivedValues = heapDerivedValues.data();
+    }
+
+    for (size_t derivedIdx = 0; derivedIdx < numDerived; ++derivedIdx)
+    {
+      isNeeded[derivedIdx] = isVariableInMask(usedVariablesSet.m_mask, *m_derivedVariables[derivedIdx].m_variable) ? 1 : 0;
+    }
+
+    // derived inputs are always registered before the derived variables that use them, so walking backwards finds everything that the used ones depend on
+    for (size_t derivedIdx = numDerived; derivedIdx-- > 0;)
+    {
+      if (isNeeded[derivedIdx] == 0)
+        continue;
+
+      for (int32_t inputDerivedIdx : m_derivedVariables[derivedIdx].m_derivedInputIndices)
+      {
+        if (inputDerivedIdx >= 0)
+        {
+          isNeeded[inputDerivedIdx] = 1;
+        }
+      }
+    }
+
+    constexpr size_t MAX_INLINE_INPUTS = 16;
+    int inlineInputValues[MAX_INLINE_INPUTS];
+    std::vector<int> heapInputValues;
+
+    for (size_t derivedIdx = 0; derivedIdx < numDerived; ++derivedIdx)
+    {
+      if (isNeeded[derivedIdx] == 0)
+        continue;
+
+      const DerivedVariable& derived = m_derivedVariables[derivedIdx];
+
+      int* inputValues = inlineInputValues;
+      if (derived.m_inputs.size() > MAX_INLINE_INPUTS)
+      {
+        heapInputValues.resize(derived.m_inputs.size());
+        inputValues = heapInputValues.data();
+      }
+
+      for (size_t i = 0; i < derived.m_inputs.size(); ++i)
+      {
+        const PermutationVariableEntry& input = *derived.m_inputs[i];
+
+        if (derived.m_derivedInputIndices[i] >= 0)
+        {
+          inputValues[i] = derivedValues[derived.m_derivedInputIndices[i]];
+          continue;
+        }
+
+        uint32_t encodedValue = 0;
+        if (!getValue(input, encodedValue))
+        {
+          Log::Error(logger, "Input variable '%s' of derived permutation variable '%s' is not set in state and has no default value", input.m_name.c_str(), derived.m_variable->m_name.c_str());
+          return HYDRA_FAILURE;
+        }
+
+        inputValues[i] = input.GetValueInt(encodedValue);
+      }
+
+      int value = 0;
+      if (derived.m_deriveFunc(std::span<const int>(inputValues, derived.m_inputs.size()), value).Failed())
+      {
+        Log::Error(logger, "Computing derived permutation variable '%s' failed", derived.m_variable->m_name.c_str());
+        return HYDRA_FAILURE;
+      }
+
+      uint32_t encodedValue = 0;
+      if (derived.m_variable->GetEncodedValue(value, encodedValue).Failed())
+      {
+        Log::Error(logger, "%d is not a valid value for derived permutation variable '%s'", value, derived.m_variable->m_name.c_str());
+        return HYDRA_FAILURE;
+      }
+
+      derivedValues[derivedIdx] = value;
+
+      if (isVariableInMask(usedVariablesSet.m_mask, *derived.m_variable))
+      {
+        inout_selection.m_values.SetBitValues(derived.m_variable->m_startBitIndex, derived.m_variable->m_numBits, encodedValue);
+      }
+    }
+
+    return HYDRA_SUCCESS;
+  }
+
   const PermutationVariableEntry* PermutationManager::RegisterVariableInternal(const char* name, std::span<std::pair<std::string, int>> allowedValues, std::optional<int> defaultValue, PermutationVariableEntry::Type type)
   {
     if (type != PermutationVariableEntry::Type::Bool && allowedValues.empty())
@@ -198,6 +665,7 @@ namespace Hydra::Runtime
 
     PermutationVariableEntry newVariableEntry(*this);
     newVariableEntry.m_name = name;
+    newVariableEntry.m_nameSymbol = m_symbolTable->Intern(name);
     newVariableEntry.m_startBitIndex = bitIndex;
     newVariableEntry.m_numBits = numBits;
     newVariableEntry.m_type = type;
@@ -207,6 +675,16 @@ namespace Hydra::Runtime
       newVariableEntry.m_allowedValues.assign(allowedValues.begin(), allowedValues.end());
     }
 
+    if (type == PermutationVariableEntry::Type::Enum)
+    {
+      std::string qualifiedName;
+      for (const auto& allowedValue : allowedValues)
+      {
+        qualifiedName = newVariableEntry.m_name + "::" + allowedValue.first;
+        newVariableEntry.m_qualifiedValueSymbols.push_back(m_symbolTable->Intern(qualifiedName));
+      }
+    }
+
     if (defaultValue.has_value())
     {
       newVariableEntry.m_hasDefaultValue = true;
@@ -226,6 +704,7 @@ namespace Hydra::Runtime
     auto& variableEntry = m_variableStorage.back();
 
     m_variableNameToVariable.insert({name, &variableEntry});
+    m_symbolToVariable.insert({variableEntry.m_nameSymbol, &variableEntry});
 
     if (m_bitIndexToVariable.size() <= bitIndex)
     {
@@ -53,6 +53,37 @@ namespace Hydra::Runtime
     assert(m_manager == nullptr || m_manager == &variable.m_manager);
     m_manager = &variable.m_manager;
     m_mask.SetBitOnes(variable.m_startBitIndex, variable.m_numBits);
+
+    if (!m_manager->IsDerivedVariable(variable))
+    {
+      uint32_t encodedDefaultValue = 0;
+      if (variable.m_hasDefaultValue && variable.GetEncodedValue(variable.m_defaultValue, encodedDefaultValue).Succeeded())
+      {
+        m_defaultValues.SetBitValues(variable.m_startBitIndex, variable.m_numBits, encodedDefaultValue);
+      }
+      else
+      {
+        m_requiredMask.SetBitOnes(variable.m_startBitIndex, variable.m_numBits);
+      }
+    }
+
+    m_defaultValues.Reserve(m_mask.GetBlockStartOffset(), m_mask.GetBlockCount());
+    m_requiredMask.Reserve(m_mask.GetBlockStartOffset(), m_mask.GetBlockCount());
+  }
+
+  bool PermutationVariableSet::HasAllRequiredValues(const PermutationVariableState& state) const
+  {
+    const BitSet::BlockType* requiredBlock = m_requiredMask.GetDataPtr();
+
+    for (uint32_t blockIndex = m_requiredMask.GetBlockStartOffset(); blockIndex < m_requiredMask.GetBlockEndOffset(); ++blockIndex)
+    {
+      if ((*requiredBlock & ~state.m_valuesMask.GetBlockOrEmpty(blockIndex)) != 0)
+        return false;
+
+      ++requiredBlock;
+    }
+
+    return true;
   }
 
   void PermutationVariableSet::Iterate(IterateCallback callback) const
@@ -84,6 +115,8 @@ namespace Hydra::Runtime
   {
     m_manager = nullptr;
     m_mask.Clear();
+    m_defaultValues.Clear();
+    m_requiredMask.Clear();
   }
 
   //////////////////////////////////////////////////////////////////////////
@@ -109,6 +142,12 @@ namespace Hydra::Runtime
       return HYDRA_FAILURE;
 
     SetVariableInternal(variable, value ? 1 : 0);
+
+    if (variable.m_manager.m_statistics.IsEnabled())
+    {
+      variable.m_manager.m_statistics.RecordSetVariable(variable);
+    }
+
     return HYDRA_SUCCESS;
   }
 
@@ -122,6 +161,12 @@ namespace Hydra::Runtime
       return HYDRA_FAILURE;
 
     SetVariableInternal(variable, encodedValue);
+
+    if (variable.m_manager.m_statistics.IsEnabled())
+    {
+      variable.m_manager.m_statistics.RecordSetVariable(variable);
+    }
+
     return HYDRA_SUCCESS;
   }
 
@@ -132,6 +177,12 @@ namespace Hydra::Runtime
       return HYDRA_FAILURE;
 
     SetVariableInternal(variable, encodedValue);
+
+    if (variable.m_manager.m_statistics.IsEnabled())
+    {
+      variable.m_manager.m_statistics.RecordSetVariable(variable);
+    }
+
     return HYDRA_SUCCESS;
   }
 
@@ -178,6 +229,12 @@ namespace Hydra::Runtime
       return HYDRA_FAILURE;
 
     out_resultState.m_manager = usedVarsSet.m_manager;
+
+    if (usedVarsSet.m_manager != nullptr && usedVarsSet.m_manager->m_statistics.IsEnabled())
+    {
+      usedVarsSet.m_manager->m_statistics.RecordMerge();
+    }
+
     return HYDRA_SUCCESS;
   }
 
@@ -236,6 +293,51 @@ namespace Hydra::Runtime
     return HYDRA_SUCCESS;
   }
 
+  Result PermutationVariableState::MergeSetDefaultsInternal(const PermutationVariableState& state, const PermutationVariableSet& usedVarsSet, BitSet& out_values, BitSet& out_valuesMask, MissingValuesCallback missingValuesCallback)
+  {
+    assert(state.m_manager == usedVarsSet.m_manager || state.m_manager == nullptr);
+
+    uint32_t blockIndex = usedVarsSet.m_mask.GetBlockStartOffset();
+    const uint32_t maskBlockCount = usedVarsSet.m_mask.GetBlockCount();
+    const uint32_t maskBlockEnd = usedVarsSet.m_mask.GetBlockEndOffset();
+
+    out_values.Clear();
+    out_values.Reserve(blockIndex, maskBlockCount);
+
+    out_valuesMask.Clear();
+    out_valuesMask.Reserve(blockIndex, maskBlockCount);
+
+    const BitSet::BlockType* maskBlock = usedVarsSet.m_mask.GetDataPtr();
+    const BitSet::BlockType* defaultsBlock = usedVarsSet.m_defaultValues.GetDataPtr();
+    const BitSet::BlockType* requiredBlock = usedVarsSet.m_requiredMask.GetDataPtr();
+    BitSet::BlockType* resultValuesBlock = out_values.GetDataPtr();
+    BitSet::BlockType* resultMaskBlock = out_valuesMask.GetDataPtr();
+
+    for (; blockIndex < maskBlockEnd; ++blockIndex)
+    {
+      const BitSet::BlockType values = state.m_values.GetBlockOrEmpty(blockIndex);
+      const BitSet::BlockType valuesMask = state.m_valuesMask.GetBlockOrEmpty(blockIndex);
+
+      const BitSet::BlockType missingBits = *requiredBlock & ~valuesMask;
+      if (missingBits != 0)
+      {
+        missingValuesCallback(blockIndex * BitSet::BITS_PER_BLOCK, missingBits);
+        return HYDRA_FAILURE;
+      }
+
+      *resultValuesBlock = (values | (*defaultsBlock & ~valuesMask)) & *maskBlock;
+      *resultMaskBlock = *maskBlock;
+
+      ++maskBlock;
+      ++defaultsBlock;
+      ++requiredBlock;
+      ++resultValuesBlock;
+      ++resultMaskBlock;
+    }
+
+    return HYDRA_SUCCESS;
+  }
+
   //////////////////////////////////////////////////////////////////////////
 
   PermutationVariableSelection::PermutationVariableSelection() = default;
@@ -266,6 +368,23 @@ namespace Hydra::Runtime
     }
   }
 
+  bool PermutationVariableSelection::GetVariableValue(const PermutationVariableEntry& variable, int& out_value) const
+  {
+    if (m_manager != &variable.m_manager)
+      return false;
+
+    // variables never straddle block boundaries
+    const uint32_t blockIndex = variable.m_startBitIndex >> BitSet::BLOCK_SHIFT;
+    const uint32_t bitIndex = variable.m_startBitIndex & BitSet::BIT_INDEX_MASK;
+
+    if (((m_valuesMask.GetBlockOrEmpty(blockIndex) >> bitIndex) & 1) == 0)
+      return false;
+
+    const BitSet::BlockType valueMask = (1ull << variable.m_numBits) - 1;
+    out_value = variable.GetValueInt(static_cast<uint32_t>((m_values.GetBlockOrEmpty(blockIndex) >> bitIndex) & valueMask));
+    return true;
+  }
+
   void PermutationVariableSelection::DumpToDebugOut() const
   {
     Iterate([](const PermutationVariableEntry& variable, int valueInt, const char* valueString)
@@ -0,0 +1,146 @@
+#include <HydraRuntime/PermutationManager.h>
+#include <HydraRuntime/PermutationStatistics.h>
+
+namespace Hydra::Runtime
+{
+  void PermutationStatistics::DumpToLog(ILoggingInterface* logger) const
+  {
+    Log::Info(logger, "FinalizeState: %llu calls, %llu failures", (unsigned long long)m_numFinalizeCalls, (unsigned long long)m_numFinalizeFailures);
+    Log::Info(logger, "MergeBontoA: %llu calls", (unsigned long long)m_numMerges);
+    Log::Info(logger, "SetVariable: %llu calls", (unsigned long long)m_numSetVariableCalls);
+
+    for (const auto& it : m_missingValueFailures)
+    {
+      Log::Info(logger, "  missing value '%s': %llu", it.first.c_str(), (unsigned long long)it.second);
+    }
+
+    for (const auto& it : m_setVariableCounts)
+    {
+      Log::Info(logger, "  set '%s': %llu", it.first.c_str(), (unsigned long long)it.second);
+    }
+
+    for (const SetStatistics& set : m_sets)
+    {
+      Log::Info(logger, "  variable set [%s]: %llu finalize calls, %llu distinct selections", set.m_variableNames.c_str(), (unsigned long long)set.m_numFinalizeCalls, (unsigned long long)set.m_numDistinctSelections);
+    }
+  }
+
+  //////////////////////////////////////////////////////////////////////////
+
+  void PermutationStatisticsRecorder::RecordFinalize(const PermutationVariableSet& usedVariablesSet, const PermutationVariableSelection& selection, bool succeeded)
+  {
+    m_numFinalizeCalls.fetch_add(1, std::memory_order_relaxed);
+
+    if (!succeeded)
+    {
+      m_numFinalizeFailures.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    const uint32_t setHash = usedVariablesSet.Hash();
+    const uint32_t selectionHash = selection.Hash();
+
+    std::scoped_lock<std::mutex> lock(m_mutex);
+
+    SetRecord* record = nullptr;
+
+    auto setRange = m_setHashToIndex.equal_range(setHash);
+    for (auto it = setRange.first; it != setRange.second; ++it)
+    {
+      if (m_sets[it->second].m_set == usedVariablesSet)
+      {
+        record = &m_sets[it->second];
+        break;
+      }
+    }
+
+    if (record == nullptr)
+    {
+      m_setHashToIndex.insert({setHash, m_sets.size()});
+      record = &m_sets.emplace_back();
+      record->m_set = usedVariablesSet;
+
+      usedVariablesSet.Iterate([&](const PermutationVariableEntry& variable)
+        {
+          record->m_variableNames += record->m_variableNames.empty() ? "" : ", ";
+          record->m_variableNames += variable.m_name; });
+    }
+
+    ++record->m_numFinalizeCalls;
+
+    auto selectionRange = record->m_selectionHashToIndex.equal_range(selectionHash);
+    for (auto it = selectionRange.first; it != selectionRange.second; ++it)
+    {
+      if (record->m_distinctSelections[it->second] == selection)
+        return;
+    }
+
+    record->m_selectionHashToIndex.insert({selectionHash, record->m_distinctSelections.size()});
+    record->m_distinctSelections.push_back(selection);
+  }
+
+  void PermutationStatisticsRecorder::RecordMissingValue(const PermutationVariableEntry& variable)
+  {
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    ++m_missingValueFailures[&variable];
+  }
+
+  void PermutationStatisticsRecorder::RecordMerge()
+  {
+    m_numMerges.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void PermutationStatisticsRecorder::RecordSetVariable(const PermutationVariableEntry& variable)
+  {
+    m_numSetVariableCalls.fetch_add(1, std::memory_order_relaxed);
+
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    ++m_setVariableCounts[&variable];
+  }
+
+  PermutationStatistics PermutationStatisticsRecorder::GetSnapshot() const
+  {
+    PermutationStatistics result;
+    result.m_numFinalizeCalls = m_numFinalizeCalls.load(std::memory_order_relaxed);
+    result.m_numFinalizeFailures = m_numFinalizeFailures.load(std::memory_order_relaxed);
+    result.m_numMerges = m_numMerges.load(std::memory_order_relaxed);
+    result.m_numSetVariableCalls = m_numSetVariableCalls.load(std::memory_order_relaxed);
+
+    std::scoped_lock<std::mutex> lock(m_mutex);
+
+    for (const auto& it : m_missingValueFailures)
+    {
+      result.m_missingValueFailures[it.first->m_name] = it.second;
+    }
+
+    for (const auto& it : m_setVariableCounts)
+    {
+      result.m_setVariableCounts[it.first->m_name] = it.second;
+    }
+
+    for (const SetRecord& record : m_sets)
+    {
+      PermutationStatistics::SetStatistics& set = result.m_sets.emplace_back();
+      set.m_variableNames = record.m_variableNames;
+      set.m_numFinalizeCalls = record.m_numFinalizeCalls;
+      set.m_numDistinctSelections = record.m_distinctSelections.size();
+    }
+
+    return result;
+  }
+
+  void PermutationStatisticsRecorder::Reset()
+  {
+    m_numFinalizeCalls = 0;
+    m_numFinalizeFailures = 0;
+    m_numMerges = 0;
+    m_numSetVariableCalls = 0;
+
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    m_missingValueFailures.clear();
+    m_setVariableCounts.clear();
+    m_sets.clear();
+    m_setHashToIndex.clear();
+  }
+
+} // namespace Hydra::Runtime
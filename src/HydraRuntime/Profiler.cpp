@@ -0,0 +1,112 @@
+#include <HydraRuntime/Profiler.h>
+
+#include <cstdio>
+#include <fstream>
+
+namespace Hydra::Runtime
+{
+  std::atomic<IProfiler*> Profiler::s_profiler = nullptr;
+
+  uint32_t Profiler::GetCurrentThreadId()
+  {
+    static std::atomic<uint32_t> s_nextThreadId = 0;
+    thread_local uint32_t threadId = s_nextThreadId.fetch_add(1, std::memory_order_relaxed);
+    return threadId;
+  }
+
+  //////////////////////////////////////////////////////////////////////////
+
+  ChromeTraceRecorder::ChromeTraceRecorder()
+    : m_startTime(std::chrono::steady_clock::now())
+  {
+  }
+
+  void ChromeTraceRecorder::BeginScope(const char* name, uint32_t threadId)
+  {
+    AddEvent(name, 'B', threadId, 0);
+  }
+
+  void ChromeTraceRecorder::EndScope(const char* name, uint32_t threadId)
+  {
+    AddEvent(name, 'E', threadId, 0);
+  }
+
+  void ChromeTraceRecorder::SetCounter(const char* name, uint32_t threadId, int64_t value)
+  {
+    AddEvent(name, 'C', threadId, value);
+  }
+
+  uint32_t ChromeTraceRecorder::GetNumEvents() const
+  {
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return static_cast<uint32_t>(m_events.size());
+  }
+
+  void ChromeTraceRecorder::Clear()
+  {
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    m_events.clear();
+  }
+
+  std::string ChromeTraceRecorder::ToJson() const
+  {
+    std::scoped_lock<std::mutex> lock(m_mutex);
+
+    std::string json = "{\"traceEvents\":[\n";
+
+    for (size_t i = 0; i < m_events.size(); ++i)
+    {
+      const Event& event = m_events[i];
+
+      json += "{\"name\":\"";
+      for (const char* c = event.m_name; *c != '\0'; ++c)
+      {
+        if (*c == '"' || *c == '\\')
+          json += '\\';
+
+        json += *c;
+      }
+
+      char buffer[128];
+      snprintf(buffer, sizeof(buffer), "\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":0,\"tid\":%u", event.m_phase, event.m_timestampNs / 1000.0, event.m_threadId);
+      json += buffer;
+
+      if (event.m_phase == 'C')
+      {
+        snprintf(buffer, sizeof(buffer), ",\"args\":{\"value\":%lld}", (long long)event.m_value);
+        json += buffer;
+      }
+
+      json += (i + 1 < m_events.size()) ? "},\n" : "}\n";
+    }
+
+    json += "],\"displayTimeUnit\":\"ms\"}\n";
+    return json;
+  }
+
+  Result ChromeTraceRecorder::SaveToFile(const char* path) const
+  {
+    std::ofstream file(path, std::ios::out | std::ios::binary);
+    if (!file.is_open())
+      return HYDRA_FAILURE;
+
+    const std::string json = ToJson();
+    file.write(json.data(), json.size());
+
+    return file.good() ? HYDRA_SUCCESS : HYDRA_FAILURE;
+  }
+
+  void ChromeTraceRecorder::AddEvent(const char* name, char phase, uint32_t threadId, int64_t value)
+  {
+    Event event;
+    event.m_name = name;
+    event.m_phase = phase;
+    event.m_threadId = threadId;
+    event.m_timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_startTime).count();
+    event.m_value = value;
+
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    m_events.push_back(event);
+  }
+
+} // namespace Hydra::Runtime
@@ -0,0 +1,69 @@
+#include <HydraRuntime/SymbolTable.h>
+
+#include <assert.h>
+#include <mutex>
+
+namespace Hydra::Runtime
+{
+  SymbolTable::SymbolTable()
+  {
+    [[maybe_unused]] SymbolId trueSymbol = Intern("true");
+    [[maybe_unused]] SymbolId falseSymbol = Intern("false");
+    assert(trueSymbol == SYMBOL_TRUE && falseSymbol == SYMBOL_FALSE);
+  }
+
+  SymbolTable::~SymbolTable() = default;
+
+  SymbolId SymbolTable::Intern(std::string_view name)
+  {
+    {
+      std::shared_lock lock(m_mutex);
+      if (auto it = m_nameToSymbol.find(name); it != m_nameToSymbol.end())
+        return it->second;
+    }
+
+    std::unique_lock lock(m_mutex);
+
+    // Another thread may have added it in the meantime
+    if (auto it = m_nameToSymbol.find(name); it != m_nameToSymbol.end())
+      return it->second;
+
+    const SymbolId symbol = static_cast<SymbolId>(m_names.size());
+    const std::string& storedName = m_names.emplace_back(name);
+    m_nameToSymbol.insert({storedName, symbol});
+
+    return symbol;
+  }
+
+  SymbolId SymbolTable::Find(std::string_view name) const
+  {
+    std::shared_lock lock(m_mutex);
+
+    if (auto it = m_nameToSymbol.find(name); it != m_nameToSymbol.end())
+      return it->second;
+
+    return INVALID_SYMBOL;
+  }
+
+  std::string_view SymbolTable::GetName(SymbolId symbol) const
+  {
+    std::shared_lock lock(m_mutex);
+
+    if (symbol < m_names.size())
+      return m_names[symbol];
+
+    return {};
+  }
+
+  uint32_t SymbolTable::GetNumSymbols() const
+  {
+    std::shared_lock lock(m_mutex);
+    return static_cast<uint32_t>(m_names.size());
+  }
+
+  SymbolTable& SymbolTable::GetGlobal()
+  {
+    static SymbolTable s_globalTable;
+    return s_globalTable;
+  }
+} // namespace Hydra::Runtime
@@ -0,0 +1,449 @@
+#include <HydraTools/BddManager.h>
+#include <HydraTools/CompiledCondition.h>
+#include <HydraTools/ConditionOperators.h>
+
+#include <HydraRuntime/Logger.h>
+#include <HydraRuntime/PermutationManager.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <optional>
+
+using namespace Hydra::Runtime;
+
+namespace Hydra::Tools
+{
+  namespace
+  {
+    uint32_t GetNumEncodedValues(const PermutationVariableEntry& variable)
+    {
+      return (variable.m_type == PermutationVariableEntry::Type::Bool) ? 2 : static_cast<uint32_t>(variable.m_allowedValues.size());
+    }
+  } // namespace
+
+  BddManager::BddManager()
+  {
+    m_nodes.push_back({TERMINAL_BIT_INDEX, FALSE_NODE, FALSE_NODE});
+    m_nodes.push_back({TERMINAL_BIT_INDEX, TRUE_NODE, TRUE_NODE});
+  }
+
+  BddManager::Node BddManager::MakeNode(uint32_t bitIndex, Node low, Node high)
+  {
+    if (low == high)
+      return low;
+
+    const TripleKey key = {bitIndex, low, high};
+    if (auto it = m_uniqueTable.find(key); it != m_uniqueTable.end())
+      return it->second;
+
+    const Node node = static_cast<Node>(m_nodes.size());
+    m_nodes.push_back({bitIndex, low, high});
+    m_uniqueTable.emplace(key, node);
+    return node;
+  }
+
+  BddManager::Node BddManager::GetBit(uint32_t bitIndex)
+  {
+    return MakeNode(bitIndex, FALSE_NODE, TRUE_NODE);
+  }
+
+  BddManager::Node BddManager::Not(Node node)
+  {
+    return Apply(Operator::Xor, node, TRUE_NODE);
+  }
+
+  BddManager::Node BddManager::Apply(Operator op, Node lhs, Node rhs)
+  {
+    switch (op)
+    {
+      case Operator::And:
+        if (lhs == FALSE_NODE || rhs == FALSE_NODE)
+          return FALSE_NODE;
+        if (lhs == TRUE_NODE || lhs == rhs)
+          return rhs;
+        if (rhs == TRUE_NODE)
+          return lhs;
+        break;
+
+      case Operator::Or:
+        if (lhs == TRUE_NODE || rhs == TRUE_NODE)
+          return TRUE_NODE;
+        if (lhs == FALSE_NODE || lhs == rhs)
+          return rhs;
+        if (rhs == FALSE_NODE)
+          return lhs;
+        break;
+
+      case Operator::Xor:
+        if (lhs == rhs)
+          return FALSE_NODE;
+        if (lhs == FALSE_NODE)
+          return rhs;
+        if (rhs == FALSE_NODE)
+          return lhs;
+        break;
+    }
+
+    // all operators are commutative, so both orders share one cache entry
+    if (lhs > rhs)
+      std::swap(lhs, rhs);
+
+    const TripleKey key = {static_cast<uint32_t>(op), lhs, rhs};
+    if (auto it = m_applyCache.find(key); it != m_applyCache.end())
+      return it->second;
+
+    // copies, since the recursion can grow m_nodes
+    const NodeData lhsData = m_nodes[lhs];
+    const NodeData rhsData = m_nodes[rhs];
+    const uint32_t bitIndex = std::min(lhsData.m_bitIndex, rhsData.m_bitIndex);
+
+    const Node low = Apply(op, lhsData.m_bitIndex == bitIndex ? lhsData.m_low : lhs, rhsData.m_bitIndex == bitIndex ? rhsData.m_low : rhs);
+    const Node high = Apply(op, lhsData.m_bitIndex == bitIndex ? lhsData.m_high : lhs, rhsData.m_bitIndex == bitIndex ? rhsData.m_high : rhs);
+
+    const Node result = MakeNode(bitIndex, low, high);
+    m_applyCache.emplace(key, result);
+    return result;
+  }
+
+  BddManager::Node BddManager::RestrictInternal(Node node, uint32_t bitIndex, bool value, std::unordered_map<Node, Node>& cache)
+  {
+    const NodeData data = m_nodes[node];
+
+    // the bit can't appear below a node with a larger bit index
+    if (data.m_bitIndex > bitIndex)
+      return node;
+
+    if (data.m_bitIndex == bitIndex)
+      return value ? data.m_high : data.m_low;
+
+    if (auto it = cache.find(node); it != cache.end())
+      return it->second;
+
+    const Node low = RestrictInternal(data.m_low, bitIndex, value, cache);
+    const Node high = RestrictInternal(data.m_high, bitIndex, value, cache);
+    const Node result = MakeNode(data.m_bitIndex, low, high);
+    cache.emplace(node, result);
+    return result;
+  }
+
+  BddManager::Node BddManager::Restrict(Node node, uint32_t bitIndex, bool value)
+  {
+    std::unordered_map<Node, Node> cache;
+    return RestrictInternal(node, bitIndex, value, cache);
+  }
+
+  BddManager::Node BddManager::Restrict(Node node, const PermutationVariableEntry& variable, uint32_t encodedValue)
+  {
+    for (uint32_t i = 0; i < variable.m_numBits; ++i)
+    {
+      node = Restrict(node, variable.m_startBitIndex + i, ((encodedValue >> i) & 1) != 0);
+    }
+
+    return node;
+  }
+
+  BddManager::Node BddManager::GetValueCondition(const PermutationVariableEntry& variable, uint32_t encodedValue)
+  {
+    // built bottom up, the highest bit index is closest to the terminals
+    Node node = TRUE_NODE;
+    for (uint32_t i = variable.m_numBits; i-- > 0;)
+    {
+      const uint32_t bitIndex = variable.m_startBitIndex + i;
+      node = ((encodedValue >> i) & 1) ? MakeNode(bitIndex, FALSE_NODE, node) : MakeNode(bitIndex, node, FALSE_NODE);
+    }
+
+    return node;
+  }
+
+  BddManager::Node BddManager::GetDomainConstraint(const PermutationVariableEntry& variable)
+  {
+    const uint32_t numValues = GetNumEncodedValues(variable);
+    if (numValues == (1u << variable.m_numBits))
+      return TRUE_NODE;
+
+    Node node = FALSE_NODE;
+    for (uint32_t encodedValue = 0; encodedValue < numValues; ++encodedValue)
+    {
+      node = Or(node, GetValueCondition(variable, encodedValue));
+    }
+
+    return node;
+  }
+
+  double BddManager::SatCount(Node node, std::span<const PermutationVariableEntry* const> variables) const
+  {
+    std::vector<uint32_t> bitIndices;
+    for (const PermutationVariableEntry* variable : variables)
+    {
+      for (uint32_t i = 0; i < variable->m_numBits; ++i)
+      {
+        bitIndices.push_back(variable->m_startBitIndex + i);
+      }
+    }
+
+    std::sort(bitIndices.begin(), bitIndices.end());
+    bitIndices.erase(std::unique(bitIndices.begin(), bitIndices.end()), bitIndices.end());
+
+    // position of a node's bit in the ordered list of counted bits, the terminals come after all bits
+    auto getPosition = [&](Node n) -> uint32_t
+    {
+      const uint32_t bitIndex = m_nodes[n].m_bitIndex;
+      if (bitIndex == TERMINAL_BIT_INDEX)
+        return static_cast<uint32_t>(bitIndices.size());
+
+      auto it = std::lower_bound(bitIndices.begin(), bitIndices.end(), bitIndex);
+      assert(it != bitIndices.end() && *it == bitIndex && "The node depends on a bit of another variable");
+      return static_cast<uint32_t>(it - bitIndices.begin());
+    };
+
+    // number of assignments of the bits from the node's position on
+    std::unordered_map<Node, double> counts;
+    auto countFrom = [&](auto& self, Node n) -> double
+    {
+      if (n == FALSE_NODE || n == TRUE_NODE)
+        return (n == TRUE_NODE) ? 1.0 : 0.0;
+
+      if (auto it = counts.find(n); it != counts.end())
+        return it->second;
+
+      const NodeData& data = m_nodes[n];
+      const uint32_t position = getPosition(n);
+      const double low = self(self, data.m_low) * std::ldexp(1.0, getPosition(data.m_low) - position - 1);
+      const double high = self(self, data.m_high) * std::ldexp(1.0, getPosition(data.m_high) - position - 1);
+
+      counts.emplace(n, low + high);
+      return low + high;
+    };
+
+    return countFrom(countFrom, node) * std::ldexp(1.0, getPosition(node));
+  }
+
+  Result BddManager::ConvertCondition(const CompiledCondition& condition, const PermutationManager& manager, Node& out_node, ILoggingInterface* logger)
+  {
+    using OpCode = CompiledCondition::OpCode;
+
+    out_node = FALSE_NODE;
+
+    if (condition.IsEmpty())
+    {
+      Log::Error(logger, "Empty expression");
+      return HYDRA_FAILURE;
+    }
+
+    const std::vector<std::string>& variableNames = condition.GetVariableNames();
+    std::vector<const PermutationVariableEntry*> variables(variableNames.size(), nullptr);
+    std::vector<std::optional<int>> enumConstants(variableNames.size());
+
+    // The set of permutations that the current instruction is evaluated for, narrowed by '&&' and '||'
+    Node active = TRUE_NODE;
+
+    for (size_t i = 0; i < variableNames.size(); ++i)
+    {
+      const std::string& name = variableNames[i];
+
+      if (const PermutationVariableEntry* variable = manager.GetVariable(name.c_str()))
+      {
+        variables[i] = variable;
+        active = And(active, GetDomainConstraint(*variable));
+      }
+      else if (const size_t separator = name.find("::"); separator != std::string::npos)
+      {
+        const PermutationVariableEntry* enumVariable = manager.GetVariable(name.substr(0, separator).c_str());
+        if (enumVariable != nullptr && enumVariable->m_type == PermutationVariableEntry::Type::Enum)
+        {
+          const std::string_view valueName = std::string_view(name).substr(separator + 2);
+          for (const auto& allowedValue : enumVariable->m_allowedValues)
+          {
+            if (allowedValue.first == valueName)
+              enumConstants[i] = allowedValue.second;
+          }
+        }
+      }
+    }
+
+    // Every value on the stack is a list of the values it can have, each with the set of permutations in which it has that value.
+    // The sets are disjoint and cover exactly the active permutations at the time the value was computed.
+    using ValueCases = std::vector<std::pair<Node, int64_t>>;
+
+    auto addCase = [&](ValueCases& cases, Node permutations, int64_t value)
+    {
+      if (permutations == FALSE_NODE)
+        return;
+
+      for (auto& existingCase : cases)
+      {
+        if (existingCase.second == value)
+        {
+          existingCase.first = Or(existingCase.first, permutations);
+          return;
+        }
+      }
+
+      cases.push_back({permutations, value});
+    };
+
+    auto getNonZeroPermutations = [&](const ValueCases& cases)
+    {
+      Node result = FALSE_NODE;
+      for (const auto& valueCase : cases)
+      {
+        if (valueCase.second != 0)
+          result = Or(result, valueCase.first);
+      }
+
+      return result;
+    };
+
+    struct PendingJump
+    {
+      OpCode m_jumpOpCode;
+      size_t m_endIndex;
+      Node m_lhsNonZero;
+      Node m_outerActive;
+    };
+
+    std::vector<ValueCases> stack;
+    std::vector<PendingJump> pendingJumps;
+
+    auto finishJumps = [&](size_t index)
+    {
+      while (!pendingJumps.empty() && pendingJumps.back().m_endIndex == index)
+      {
+        const PendingJump jump = pendingJumps.back();
+        pendingJumps.pop_back();
+
+        // the right operand was only evaluated where the left one didn't decide the result
+        const Node rhsNonZero = getNonZeroPermutations(stack.back());
+        const Node result = (jump.m_jumpOpCode == OpCode::JumpIfFalse) ? rhsNonZero : Or(jump.m_lhsNonZero, rhsNonZero);
+
+        stack.back().clear();
+        addCase(stack.back(), result, 1);
+        addCase(stack.back(), And(jump.m_outerActive, Not(result)), 0);
+
+        active = jump.m_outerActive;
+      }
+    };
+
+    const std::vector<CompiledCondition::Instruction>& instructions = condition.GetInstructions();
+
+    for (size_t index = 0; index < instructions.size(); ++index)
+    {
+      finishJumps(index);
+
+      const CompiledCondition::Instruction& instruction = instructions[index];
+
+      switch (instruction.m_opCode)
+      {
+        case OpCode::PushConstant:
+          addCase(stack.emplace_back(), active, instruction.m_operand);
+          continue;
+
+        case OpCode::PushVariable:
+        {
+          const PermutationVariableEntry* variable = variables[instruction.m_operand];
+          const std::optional<int>& enumConstant = enumConstants[instruction.m_operand];
+
+          if (variable == nullptr && !enumConstant.has_value() && active != FALSE_NODE)
+          {
+            Log::Error(logger, "No value specified for identifier '%s'", variableNames[instruction.m_operand].c_str());
+            return HYDRA_FAILURE;
+          }
+
+          ValueCases& cases = stack.emplace_back();
+          if (variable != nullptr)
+          {
+            for (uint32_t encodedValue = 0; encodedValue < GetNumEncodedValues(*variable); ++encodedValue)
+            {
+              addCase(cases, And(active, GetValueCondition(*variable, encodedValue)), variable->GetValueInt(encodedValue));
+            }
+          }
+          else if (enumConstant.has_value())
+          {
+            addCase(cases, active, *enumConstant);
+          }
+          continue;
+        }
+
+        case OpCode::PushSlot:
+          assert(false && "Only compiled conditions can be converted, not bound ones");
+          return HYDRA_FAILURE;
+
+        case OpCode::Negate:
+        case OpCode::BitNot:
+        case OpCode::LogicalNot:
+        case OpCode::ToBool:
+        {
+          ValueCases result;
+          for (const auto& valueCase : stack.back())
+          {
+            addCase(result, valueCase.first, ApplyUnaryOperator(instruction.m_opCode, valueCase.second));
+          }
+
+          stack.back() = std::move(result);
+          continue;
+        }
+
+        case OpCode::JumpIfFalse:
+        case OpCode::JumpIfTrue:
+        {
+          const Node lhsNonZero = getNonZeroPermutations(stack.back());
+          stack.pop_back();
+
+          pendingJumps.push_back({instruction.m_opCode, index + 1 + instruction.m_operand, lhsNonZero, active});
+          active = (instruction.m_opCode == OpCode::JumpIfFalse) ? lhsNonZero : And(active, Not(lhsNonZero));
+
+          if (active == FALSE_NODE)
+          {
+            // the left operand decides every permutation
+            stack.emplace_back();
+            index += instruction.m_operand;
+          }
+          continue;
+        }
+
+        default:
+          break;
+      }
+
+      // Binary operators
+      const ValueCases rhs = std::move(stack.back());
+      stack.pop_back();
+
+      ValueCases result;
+      for (const auto& lhsCase : stack.back())
+      {
+        for (const auto& rhsCase : rhs)
+        {
+          const Node permutations = And(lhsCase.first, rhsCase.first);
+          if (permutations == FALSE_NODE)
+            continue;
+
+          if ((instruction.m_opCode == OpCode::Divide || instruction.m_opCode == OpCode::Modulo) && rhsCase.second == 0)
+          {
+            Log::Error(logger, "Division by zero in condition");
+            return HYDRA_FAILURE;
+          }
+
+          addCase(result, permutations, ApplyBinaryOperator(instruction.m_opCode, lhsCase.second, rhsCase.second));
+        }
+      }
+
+      stack.back() = std::move(result);
+    }
+
+    finishJumps(instructions.size());
+
+    assert(stack.size() == 1 && pendingJumps.empty());
+
+    // the result is truncated to an int, like in CompiledCondition::Evaluate()
+    for (const auto& valueCase : stack.back())
+    {
+      if (static_cast<int>(valueCase.second) != 0)
+        out_node = Or(out_node, valueCase.first);
+    }
+
+    return HYDRA_SUCCESS;
+  }
+
+} // namespace Hydra::Tools
@@ -0,0 +1,591 @@
+#include <HydraTools/BitSlicedEvaluator.h>
+#include <HydraTools/ConditionOperators.h>
+
+#include <HydraRuntime/Logger.h>
+#include <HydraRuntime/PermutationManager.h>
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <optional>
+
+using namespace Hydra::Runtime;
+
+namespace Hydra::Tools
+{
+  namespace
+  {
+    using OpCode = CompiledCondition::OpCode;
+    using LaneMask = BitSlicedEvaluator::LaneMask;
+    using Value = BitSlicedEvaluator::Value;
+
+    constexpr LaneMask ALL_LANES = ~LaneMask(0);
+
+    LaneMask GetPlane(const Value& value, uint32_t plane)
+    {
+      return value.m_planes[std::min(plane, value.m_numPlanes - 1)];
+    }
+
+    /// Drops redundant sign planes, so that the following operations touch fewer planes.
+    void Shrink(Value& value)
+    {
+      while (value.m_numPlanes > 1 && value.m_planes[value.m_numPlanes - 1] == value.m_planes[value.m_numPlanes - 2])
+      {
+        --value.m_numPlanes;
+      }
+    }
+
+    void SetUniform(Value& value, int64_t constant)
+    {
+      for (uint32_t plane = 0; plane < 64; ++plane)
+      {
+        value.m_planes[plane] = ((constant >> plane) & 1) ? ALL_LANES : 0;
+      }
+
+      value.m_numPlanes = 64;
+      Shrink(value);
+    }
+
+    void SetMask(Value& value, LaneMask mask)
+    {
+      value.m_planes[0] = mask;
+      value.m_planes[1] = 0;
+      value.m_numPlanes = 2;
+    }
+
+    void SetLanes(Value& value, const int64_t* laneValues, LaneMask lanes)
+    {
+      std::fill(std::begin(value.m_planes), std::end(value.m_planes), 0);
+
+      for (; lanes != 0; lanes &= lanes - 1)
+      {
+        const uint32_t lane = static_cast<uint32_t>(std::countr_zero(lanes));
+        const uint64_t bits = static_cast<uint64_t>(laneValues[lane]);
+
+        for (uint32_t plane = 0; plane < 64; ++plane)
+        {
+          value.m_planes[plane] |= ((bits >> plane) & 1) << lane;
+        }
+      }
+
+      value.m_numPlanes = 64;
+      Shrink(value);
+    }
+
+    int64_t GetLane(const Value& value, uint32_t lane)
+    {
+      uint64_t bits = 0;
+      for (uint32_t plane = 0; plane < value.m_numPlanes; ++plane)
+      {
+        bits |= ((value.m_planes[plane] >> lane) & 1) << plane;
+      }
+
+      // sign extension
+      if (value.m_numPlanes < 64 && ((value.m_planes[value.m_numPlanes - 1] >> lane) & 1))
+      {
+        bits |= ~uint64_t(0) << value.m_numPlanes;
+      }
+
+      return static_cast<int64_t>(bits);
+    }
+
+    /// Returns the value of the lanes, if they all have the same value.
+    std::optional<int64_t> GetUniformValue(const Value& value)
+    {
+      for (uint32_t plane = 0; plane < value.m_numPlanes; ++plane)
+      {
+        if (value.m_planes[plane] != 0 && value.m_planes[plane] != ALL_LANES)
+          return std::nullopt;
+      }
+
+      return GetLane(value, 0);
+    }
+
+    LaneMask GetNonZeroLanes(const Value& value, uint32_t numPlanes = 64)
+    {
+      LaneMask result = 0;
+      for (uint32_t plane = 0; plane < std::min(numPlanes, value.m_numPlanes); ++plane)
+      {
+        result |= value.m_planes[plane];
+      }
+
+      return result;
+    }
+
+    /// Ripple carry adder over all planes. Subtraction is 'lhs + ~rhs + 1'.
+    void Add(const Value& lhs, const Value& rhs, bool subtract, Value& out_result)
+    {
+      const LaneMask invert = subtract ? ALL_LANES : 0;
+      const uint32_t numPlanes = std::min(64u, std::max(lhs.m_numPlanes, rhs.m_numPlanes) + 1);
+
+      LaneMask carry = invert;
+      for (uint32_t plane = 0; plane < numPlanes; ++plane)
+      {
+        const LaneMask a = GetPlane(lhs, plane);
+        const LaneMask b = GetPlane(rhs, plane) ^ invert;
+        out_result.m_planes[plane] = a ^ b ^ carry;
+        carry = (a & b) | (carry & (a ^ b));
+      }
+
+      out_result.m_numPlanes = numPlanes;
+      Shrink(out_result);
+    }
+
+    /// Computes the lanes in which lhs < rhs and lhs == rhs, by comparing from the most significant plane down.
+    void Compare(const Value& lhs, const Value& rhs, LaneMask& out_less, LaneMask& out_equal)
+    {
+      const uint32_t numPlanes = std::max(lhs.m_numPlanes, rhs.m_numPlanes);
+
+      // sign plane: negative values are smaller
+      LaneMask a = GetPlane(lhs, numPlanes - 1);
+      LaneMask b = GetPlane(rhs, numPlanes - 1);
+      LaneMask less = a & ~b;
+      LaneMask equal = ~(a ^ b);
+
+      for (uint32_t plane = numPlanes - 1; plane-- > 0;)
+      {
+        a = GetPlane(lhs, plane);
+        b = GetPlane(rhs, plane);
+        less |= equal & ~a & b;
+        equal &= ~(a ^ b);
+      }
+
+      out_less = less;
+      out_equal = equal;
+    }
+
+    void Bitwise(const Value& lhs, const Value& rhs, OpCode opCode, Value& out_result)
+    {
+      const uint32_t numPlanes = std::max(lhs.m_numPlanes, rhs.m_numPlanes);
+
+      for (uint32_t plane = 0; plane < numPlanes; ++plane)
+      {
+        const LaneMask a = GetPlane(lhs, plane);
+        const LaneMask b = GetPlane(rhs, plane);
+        out_result.m_planes[plane] = (opCode == OpCode::BitAnd) ? (a & b) : ((opCode == OpCode::BitOr) ? (a | b) : (a ^ b));
+      }
+
+      out_result.m_numPlanes = numPlanes;
+      Shrink(out_result);
+    }
+
+    void ShiftByConstant(const Value& value, OpCode opCode, uint32_t amount, Value& out_result)
+    {
+      if (opCode == OpCode::ShiftLeft)
+      {
+        const uint32_t numPlanes = std::min(64u, value.m_numPlanes + amount);
+        for (uint32_t plane = 0; plane < numPlanes; ++plane)
+        {
+          out_result.m_planes[plane] = (plane < amount) ? 0 : GetPlane(value, plane - amount);
+        }
+
+        out_result.m_numPlanes = numPlanes;
+      }
+      else
+      {
+        // arithmetic shift, the sign plane is repeated
+        const uint32_t numPlanes = (value.m_numPlanes > amount) ? value.m_numPlanes - amount : 1;
+        for (uint32_t plane = 0; plane < numPlanes; ++plane)
+        {
+          out_result.m_planes[plane] = GetPlane(value, plane + amount);
+        }
+
+        out_result.m_numPlanes = numPlanes;
+      }
+
+      Shrink(out_result);
+    }
+  } // namespace
+
+  void BitSlicedEvaluator::SetVariable(std::string_view name, std::span<const int> laneValues)
+  {
+    assert(laneValues.size() <= NUM_LANES);
+
+    int64_t values[NUM_LANES] = {};
+    std::copy(laneValues.begin(), laneValues.end(), values);
+
+    auto it = m_variables.find(name);
+    if (it == m_variables.end())
+    {
+      it = m_variables.emplace(std::string(name), Value()).first;
+    }
+
+    SetLanes(it->second, values, ALL_LANES);
+  }
+
+  void BitSlicedEvaluator::SetConstant(std::string_view name, int value)
+  {
+    auto it = m_variables.find(name);
+    if (it == m_variables.end())
+    {
+      it = m_variables.emplace(std::string(name), Value()).first;
+    }
+
+    SetUniform(it->second, value);
+  }
+
+  void BitSlicedEvaluator::ClearVariables()
+  {
+    m_variables.clear();
+  }
+
+  Result BitSlicedEvaluator::Evaluate(const CompiledCondition& condition, LaneMask& out_trueLanes, LaneMask activeLanes, ILoggingInterface* logger)
+  {
+    out_trueLanes = 0;
+
+    if (condition.IsEmpty())
+    {
+      Log::Error(logger, "Empty expression");
+      return HYDRA_FAILURE;
+    }
+
+    const std::vector<CompiledCondition::Instruction>& instructions = condition.GetInstructions();
+    const std::vector<std::string>& variableNames = condition.GetVariableNames();
+
+    m_resolvedVariables.resize(variableNames.size());
+    for (size_t i = 0; i < variableNames.size(); ++i)
+    {
+      auto it = m_variables.find(variableNames[i]);
+      m_resolvedVariables[i] = (it != m_variables.end()) ? &it->second : nullptr;
+    }
+
+    /// A '&&' or '||' whose right operand is being evaluated, only for the lanes that the left operand doesn't decide.
+    struct PendingJump
+    {
+      OpCode m_jumpOpCode;
+      size_t m_endIndex;
+      LaneMask m_lhsLanes;
+      LaneMask m_outerActiveLanes;
+    };
+
+    std::vector<PendingJump> pendingJumps;
+    uint32_t top = 0; // Number of values on the stack
+
+    auto push = [&]() -> Value&
+    {
+      if (top == m_stack.size())
+        m_stack.emplace_back();
+
+      return m_stack[top++];
+    };
+
+    auto finishJumps = [&](size_t index)
+    {
+      while (!pendingJumps.empty() && pendingJumps.back().m_endIndex == index)
+      {
+        const PendingJump jump = pendingJumps.back();
+        pendingJumps.pop_back();
+
+        const LaneMask rhsLanes = GetNonZeroLanes(m_stack[top - 1]);
+        const LaneMask result = (jump.m_jumpOpCode == OpCode::JumpIfFalse) ? (jump.m_lhsLanes & rhsLanes) : (jump.m_lhsLanes | rhsLanes);
+        SetMask(m_stack[top - 1], result);
+
+        activeLanes = jump.m_outerActiveLanes;
+      }
+    };
+
+    for (size_t index = 0; index < instructions.size(); ++index)
+    {
+      finishJumps(index);
+
+      const CompiledCondition::Instruction& instruction = instructions[index];
+
+      switch (instruction.m_opCode)
+      {
+        case OpCode::PushConstant:
+          SetUniform(push(), instruction.m_operand);
+          continue;
+
+        case OpCode::PushVariable:
+          if (const Value* variable = m_resolvedVariables[instruction.m_operand])
+          {
+            push() = *variable;
+          }
+          else if (activeLanes != 0)
+          {
+            Log::Error(logger, "No value specified for identifier '%s'", variableNames[instruction.m_operand].c_str());
+            return HYDRA_FAILURE;
+          }
+          else
+          {
+            SetUniform(push(), 0);
+          }
+          continue;
+
+        case OpCode::PushSlot:
+          assert(false && "Only compiled conditions can be evaluated, not bound ones");
+          return HYDRA_FAILURE;
+
+        case OpCode::Negate:
+        {
+          Value zero;
+          const Value operand = m_stack[top - 1];
+          Add(zero, operand, true, m_stack[top - 1]);
+          continue;
+        }
+
+        case OpCode::BitNot:
+        {
+          Value& value = m_stack[top - 1];
+          for (uint32_t plane = 0; plane < value.m_numPlanes; ++plane)
+          {
+            value.m_planes[plane] = ~value.m_planes[plane];
+          }
+          continue;
+        }
+
+        case OpCode::LogicalNot:
+          SetMask(m_stack[top - 1], ~GetNonZeroLanes(m_stack[top - 1]));
+          continue;
+
+        case OpCode::ToBool:
+          SetMask(m_stack[top - 1], GetNonZeroLanes(m_stack[top - 1]));
+          continue;
+
+        case OpCode::JumpIfFalse:
+        case OpCode::JumpIfTrue:
+        {
+          const LaneMask lhsLanes = GetNonZeroLanes(m_stack[--top]);
+          const LaneMask undecidedLanes = (instruction.m_opCode == OpCode::JumpIfFalse) ? lhsLanes : ~lhsLanes;
+
+          pendingJumps.push_back({instruction.m_opCode, index + 1 + instruction.m_operand, lhsLanes, activeLanes});
+          activeLanes &= undecidedLanes;
+
+          if (activeLanes == 0)
+          {
+            // the left operand decides all lanes, skip the right one entirely
+            SetUniform(push(), 0);
+            index += instruction.m_operand;
+          }
+          continue;
+        }
+
+        default:
+          break;
+      }
+
+      // Binary operators
+      const Value& rhs = m_stack[top - 1];
+      const Value& lhs = m_stack[top - 2];
+      Value result;
+
+      switch (instruction.m_opCode)
+      {
+        case OpCode::Add:
+        case OpCode::Subtract:
+          Add(lhs, rhs, instruction.m_opCode == OpCode::Subtract, result);
+          break;
+
+        case OpCode::BitAnd:
+        case OpCode::BitOr:
+        case OpCode::BitXor:
+          Bitwise(lhs, rhs, instruction.m_opCode, result);
+          break;
+
+        case OpCode::Less:
+        case OpCode::LessEqual:
+        case OpCode::Greater:
+        case OpCode::GreaterEqual:
+        case OpCode::Equal:
+        case OpCode::NotEqual:
+        {
+          LaneMask less = 0;
+          LaneMask equal = 0;
+          Compare(lhs, rhs, less, equal);
+
+          LaneMask lanes = 0;
+          switch (instruction.m_opCode)
+          {
+            case OpCode::Less:
+              lanes = less;
+              break;
+            case OpCode::LessEqual:
+              lanes = less | equal;
+              break;
+            case OpCode::Greater:
+              lanes = ~(less | equal);
+              break;
+            case OpCode::GreaterEqual:
+              lanes = ~less;
+              break;
+            case OpCode::Equal:
+              lanes = equal;
+              break;
+            default:
+              lanes = ~equal;
+              break;
+          }
+
+          SetMask(result, lanes);
+          break;
+        }
+
+        default:
+        {
+          if (instruction.m_opCode == OpCode::ShiftLeft || instruction.m_opCode == OpCode::ShiftRight)
+          {
+            if (std::optional<int64_t> amount = GetUniformValue(rhs); amount.has_value() && *amount >= 0 && *amount < 64)
+            {
+              ShiftByConstant(lhs, instruction.m_opCode, static_cast<uint32_t>(*amount), result);
+              break;
+            }
+          }
+
+          // everything else is computed lane by lane
+          int64_t laneResults[NUM_LANES] = {};
+          for (LaneMask lanes = activeLanes; lanes != 0; lanes &= lanes - 1)
+          {
+            const uint32_t lane = static_cast<uint32_t>(std::countr_zero(lanes));
+            const int64_t rhsValue = GetLane(rhs, lane);
+
+            if ((instruction.m_opCode == OpCode::Divide || instruction.m_opCode == OpCode::Modulo) && rhsValue == 0)
+            {
+              Log::Error(logger, "Division by zero in condition");
+              return HYDRA_FAILURE;
+            }
+
+            laneResults[lane] = ApplyBinaryOperator(instruction.m_opCode, GetLane(lhs, lane), rhsValue);
+          }
+
+          SetLanes(result, laneResults, activeLanes);
+          break;
+        }
+      }
+
+      --top;
+      m_stack[top - 1] = result;
+    }
+
+    finishJumps(instructions.size());
+
+    assert(top == 1 && pendingJumps.empty());
+
+    // the result is truncated to an int, like in CompiledCondition::Evaluate()
+    out_trueLanes = GetNonZeroLanes(m_stack[0], 32) & activeLanes;
+    return HYDRA_SUCCESS;
+  }
+
+  //////////////////////////////////////////////////////////////////////////
+
+  void PermutationSpace::AddVariable(std::string_view name, std::vector<int> allowedValues)
+  {
+    m_variables.push_back({std::string(name), std::move(allowedValues)});
+  }
+
+  void PermutationSpace::AddVariable(const PermutationVariableEntry& variable)
+  {
+    std::vector<int> allowedValues;
+
+    if (variable.m_type == PermutationVariableEntry::Type::Bool)
+    {
+      allowedValues = {0, 1};
+    }
+    else
+    {
+      for (const auto& value : variable.m_allowedValues)
+      {
+        allowedValues.push_back(value.second);
+
+        if (variable.m_type == PermutationVariableEntry::Type::Enum)
+        {
+          AddConstant(variable.m_name + "::" + value.first, value.second);
+        }
+      }
+    }
+
+    AddVariable(variable.m_name, std::move(allowedValues));
+  }
+
+  void PermutationSpace::AddConstant(std::string_view name, int value)
+  {
+    m_constants.push_back({std::string(name), value});
+  }
+
+  uint64_t PermutationSpace::GetNumPermutations() const
+  {
+    uint64_t numPermutations = 1;
+    for (const Variable& variable : m_variables)
+    {
+      numPermutations *= variable.m_allowedValues.size();
+    }
+
+    return numPermutations;
+  }
+
+  void PermutationSpace::GetPermutationValues(uint64_t permutationIndex, ValueTable& out_values) const
+  {
+    for (const auto& constant : m_constants)
+    {
+      out_values[constant.first] = constant.second;
+    }
+
+    for (const Variable& variable : m_variables)
+    {
+      const uint64_t numValues = variable.m_allowedValues.size();
+      out_values[variable.m_name] = variable.m_allowedValues[permutationIndex % numValues];
+      permutationIndex /= numValues;
+    }
+  }
+
+  Result PermutationSpace::EvaluateCondition(const CompiledCondition& condition, std::vector<uint64_t>& out_mask, ILoggingInterface* logger) const
+  {
+    const uint64_t numPermutations = GetNumPermutations();
+    out_mask.assign((numPermutations + BitSlicedEvaluator::NUM_LANES - 1) / BitSlicedEvaluator::NUM_LANES, 0);
+
+    BitSlicedEvaluator evaluator;
+
+    for (const auto& constant : m_constants)
+    {
+      evaluator.SetConstant(constant.first, constant.second);
+    }
+
+    // only the variables that the condition reads need lane values
+    struct UsedVariable
+    {
+      const Variable* m_variable = nullptr;
+      uint64_t m_stride = 0; // number of permutations until the value changes
+    };
+
+    std::vector<UsedVariable> usedVariables;
+    uint64_t stride = 1;
+
+    for (const Variable& variable : m_variables)
+    {
+      if (std::find(condition.GetVariableNames().begin(), condition.GetVariableNames().end(), variable.m_name) != condition.GetVariableNames().end())
+      {
+        usedVariables.push_back({&variable, stride});
+      }
+
+      stride *= variable.m_allowedValues.size();
+    }
+
+    int laneValues[BitSlicedEvaluator::NUM_LANES] = {};
+
+    for (size_t block = 0; block < out_mask.size(); ++block)
+    {
+      const uint64_t firstPermutation = block * BitSlicedEvaluator::NUM_LANES;
+      const uint32_t numLanes = static_cast<uint32_t>(std::min<uint64_t>(BitSlicedEvaluator::NUM_LANES, numPermutations - firstPermutation));
+      const BitSlicedEvaluator::LaneMask activeLanes = (numLanes == BitSlicedEvaluator::NUM_LANES) ? ~BitSlicedEvaluator::LaneMask(0) : ((BitSlicedEvaluator::LaneMask(1) << numLanes) - 1);
+
+      for (const UsedVariable& used : usedVariables)
+      {
+        const std::vector<int>& values = used.m_variable->m_allowedValues;
+
+        for (uint32_t lane = 0; lane < numLanes; ++lane)
+        {
+          laneValues[lane] = values[((firstPermutation + lane) / used.m_stride) % values.size()];
+        }
+
+        evaluator.SetVariable(used.m_variable->m_name, std::span<const int>(laneValues, numLanes));
+      }
+
+      if (evaluator.Evaluate(condition, out_mask[block], activeLanes, logger).Failed())
+      {
+        return HYDRA_FAILURE;
+      }
+    }
+
+    return HYDRA_SUCCESS;
+  }
+
+} // namespace Hydra::Tools
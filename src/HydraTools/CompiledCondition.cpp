@@ -0,0 +1,744 @@
+#include <HydraTools/CompiledCondition.h>
+#include <HydraTools/ConditionOperators.h>
+#include <HydraTools/TokenParsing.h>
+
+#include <HydraRuntime/Logger.h>
+#include <HydraRuntime/PermutationManager.h>
+
+#include <algorithm>
+
+using namespace Hydra::Runtime;
+
+namespace Hydra::Tools
+{
+  namespace
+  {
+    using OpCode = CompiledCondition::OpCode;
+    using Instruction = CompiledCondition::Instruction;
+
+    /// Recursive descent parser with the same grammar as the Evaluator, which emits postfix instructions instead of computing values.
+    class ConditionCompiler
+    {
+    public:
+      ConditionCompiler(const TokenStream& input, std::vector<Instruction>& instructions, std::vector<std::string>& variableNames, ILoggingInterface* logger)
+        : m_input(input)
+        , m_instructions(instructions)
+        , m_variableNames(variableNames)
+        , m_logger(logger)
+      {
+      }
+
+      Result Compile()
+      {
+        SkipComments(m_input, m_currentToken);
+        if (m_currentToken < m_input.size())
+        {
+          if (ParseExpressionOr().Failed())
+            return HYDRA_FAILURE;
+        }
+
+        return ExpectEndOfLineOrInput(m_input, m_currentToken, m_logger);
+      }
+
+    private:
+      void Emit(OpCode opCode, int32_t operand = 0) { m_instructions.push_back({opCode, operand}); }
+
+      bool Accept(Token::Operator op) { return Hydra::Tools::Accept(m_input, m_currentToken, op); }
+
+      /// Parses operands of a left associative binary operator chain.
+      template <typename ParseOperandFunc>
+      Result ParseBinaryChain(ParseOperandFunc parseOperand, std::initializer_list<std::pair<Token::Operator, OpCode>> operators)
+      {
+        if ((this->*parseOperand)().Failed())
+          return HYDRA_FAILURE;
+
+        while (true)
+        {
+          auto it = std::find_if(operators.begin(), operators.end(), [&](const auto& entry)
+            { return Accept(entry.first); });
+
+          if (it == operators.end())
+            break;
+
+          if ((this->*parseOperand)().Failed())
+            return HYDRA_FAILURE;
+
+          Emit(it->second);
+        }
+
+        return HYDRA_SUCCESS;
+      }
+
+      /// Parses operands of '&&' or '||' chains. Each right operand is preceded by a jump over it and normalized to 0 or 1.
+      template <typename ParseOperandFunc>
+      Result ParseShortCircuitChain(ParseOperandFunc parseOperand, Token::Operator op, OpCode jumpOpCode)
+      {
+        if ((this->*parseOperand)().Failed())
+          return HYDRA_FAILURE;
+
+        while (Accept(op))
+        {
+          const size_t jumpIndex = m_instructions.size();
+          Emit(jumpOpCode);
+
+          if ((this->*parseOperand)().Failed())
+            return HYDRA_FAILURE;
+
+          Emit(OpCode::ToBool);
+
+          m_instructions[jumpIndex].m_operand = static_cast<int32_t>(m_instructions.size() - jumpIndex - 1);
+        }
+
+        return HYDRA_SUCCESS;
+      }
+
+      Result ParseFactor()
+      {
+        while (Accept(Token::Operator::Plus))
+        {
+        }
+
+        std::pair<Token::Operator, OpCode> unaryOperators[] = {
+          {Token::Operator::Minus, OpCode::Negate},
+          {Token::Operator::BitNot, OpCode::BitNot},
+          {Token::Operator::LogicalNot, OpCode::LogicalNot},
+        };
+
+        for (const auto& unaryOperator : unaryOperators)
+        {
+          if (Accept(unaryOperator.first))
+          {
+            if (ParseFactor().Failed())
+              return HYDRA_FAILURE;
+
+            Emit(unaryOperator.second);
+            return HYDRA_SUCCESS;
+          }
+        }
+
+        uint32_t valueToken = 0;
+        if (Hydra::Tools::Accept(m_input, m_currentToken, Token::Type::Identifier, &valueToken))
+        {
+          const Token& identifier = m_input[valueToken];
+          if (identifier.m_symbol == SYMBOL_TRUE || (identifier.m_symbol == INVALID_SYMBOL && identifier.m_token == "true"))
+          {
+            Emit(OpCode::PushConstant, 1);
+          }
+          else if (identifier.m_symbol == SYMBOL_FALSE || (identifier.m_symbol == INVALID_SYMBOL && identifier.m_token == "false"))
+          {
+            Emit(OpCode::PushConstant, 0);
+          }
+          else
+          {
+            auto it = std::find(m_variableNames.begin(), m_variableNames.end(), identifier.m_token);
+            if (it == m_variableNames.end())
+            {
+              it = m_variableNames.insert(m_variableNames.end(), std::string(identifier.m_token));
+            }
+
+            Emit(OpCode::PushVariable, static_cast<int32_t>(it - m_variableNames.begin()));
+          }
+
+          return HYDRA_SUCCESS;
+        }
+        else if (Hydra::Tools::Accept(m_input, m_currentToken, Token::Type::Integer, &valueToken))
+        {
+          Emit(OpCode::PushConstant, ParseIntegerToken(m_input[valueToken].m_token));
+          return HYDRA_SUCCESS;
+        }
+        else if (Accept(Token::Operator::OpenParenthesis))
+        {
+          if (ParseExpressionOr().Failed())
+            return HYDRA_FAILURE;
+
+          return Expect(m_input, m_currentToken, Token::Operator::CloseParenthesis, ")", m_logger);
+        }
+
+        Log::Error(m_logger, "Syntax error - expected identifier, number, or '(' instead of '%s'", GetErrorTokenText(m_input, m_currentToken).c_str());
+
+        return HYDRA_FAILURE;
+      }
+
+      Result ParseExpressionMul()
+      {
+        return ParseBinaryChain(&ConditionCompiler::ParseFactor, {{Token::Operator::Multiply, OpCode::Multiply}, {Token::Operator::Divide, OpCode::Divide}, {Token::Operator::Modulo, OpCode::Modulo}});
+      }
+
+      Result ParseExpressionPlus()
+      {
+        return ParseBinaryChain(&ConditionCompiler::ParseExpressionMul, {{Token::Operator::Plus, OpCode::Add}, {Token::Operator::Minus, OpCode::Subtract}});
+      }
+
+      Result ParseExpressionShift()
+      {
+        return ParseBinaryChain(&ConditionCompiler::ParseExpressionPlus, {{Token::Operator::ShiftRight, OpCode::ShiftRight}, {Token::Operator::ShiftLeft, OpCode::ShiftLeft}});
+      }
+
+      Result ParseCondition()
+      {
+        if (ParseExpressionShift().Failed())
+          return HYDRA_FAILURE;
+
+        // Comparisons don't chain
+        std::pair<Token::Operator, OpCode> comparisons[] = {
+          {Token::Operator::Equal, OpCode::Equal},
+          {Token::Operator::NotEqual, OpCode::NotEqual},
+          {Token::Operator::GreaterEqual, OpCode::GreaterEqual},
+          {Token::Operator::LessEqual, OpCode::LessEqual},
+          {Token::Operator::Greater, OpCode::Greater},
+          {Token::Operator::Less, OpCode::Less},
+        };
+
+        for (const auto& comparison : comparisons)
+        {
+          if (Accept(comparison.first))
+          {
+            if (ParseExpressionShift().Failed())
+              return HYDRA_FAILURE;
+
+            Emit(comparison.second);
+            break;
+          }
+        }
+
+        return HYDRA_SUCCESS;
+      }
+
+      Result ParseExpressionBitAnd() { return ParseBinaryChain(&ConditionCompiler::ParseCondition, {{Token::Operator::BitAnd, OpCode::BitAnd}}); }
+      Result ParseExpressionBitXor() { return ParseBinaryChain(&ConditionCompiler::ParseExpressionBitAnd, {{Token::Operator::BitXor, OpCode::BitXor}}); }
+      Result ParseExpressionBitOr() { return ParseBinaryChain(&ConditionCompiler::ParseExpressionBitXor, {{Token::Operator::BitOr, OpCode::BitOr}}); }
+      Result ParseExpressionAnd() { return ParseShortCircuitChain(&ConditionCompiler::ParseExpressionBitOr, Token::Operator::LogicalAnd, OpCode::JumpIfFalse); }
+      Result ParseExpressionOr() { return ParseShortCircuitChain(&ConditionCompiler::ParseExpressionAnd, Token::Operator::LogicalOr, OpCode::JumpIfTrue); }
+
+      const TokenStream& m_input;
+      uint32_t m_currentToken = 0;
+      std::vector<Instruction>& m_instructions;
+      std::vector<std::string>& m_variableNames;
+      ILoggingInterface* m_logger = nullptr;
+    };
+
+    uint32_t ComputeMaxStackDepth(const std::vector<Instruction>& instructions)
+    {
+      uint32_t depth = 0;
+      uint32_t maxDepth = 0;
+
+      for (const Instruction& instruction : instructions)
+      {
+        switch (instruction.m_opCode)
+        {
+          case OpCode::PushConstant:
+          case OpCode::PushVariable:
+          case OpCode::PushSlot:
+            ++depth;
+            maxDepth = std::max(maxDepth, depth);
+            break;
+
+          case OpCode::Negate:
+          case OpCode::BitNot:
+          case OpCode::LogicalNot:
+          case OpCode::ToBool:
+            break;
+
+          default:
+            // binary operators pop two values and push one, jumps pop one value when they don't jump
+            // when they jump, the skipped instructions would have left exactly one value instead, so the linear scan is never exceeded
+            --depth;
+            break;
+        }
+      }
+
+      assert(depth == 1 || instructions.empty());
+      return maxDepth;
+    }
+  } // namespace
+
+  Result CompiledCondition::Compile(std::string_view condition, ILoggingInterface* logger)
+  {
+    return Compile(EvaluationContext::GetThreadLocal().Tokenize(condition, logger), logger);
+  }
+
+  Result CompiledCondition::Compile(const TokenStream& condition, ILoggingInterface* logger)
+  {
+    m_instructions.clear();
+    m_variableNames.clear();
+    m_maxStackDepth = 0;
+
+    ConditionCompiler compiler(condition, m_instructions, m_variableNames, logger);
+    if (compiler.Compile().Failed())
+    {
+      m_instructions.clear();
+      m_variableNames.clear();
+      return HYDRA_FAILURE;
+    }
+
+    m_maxStackDepth = ComputeMaxStackDepth(m_instructions);
+    return HYDRA_SUCCESS;
+  }
+
+  namespace
+  {
+    /// Runs a postfix program. PushVariable instructions are resolved through 'lookupVariable', PushSlot instructions read from 'slotValues'.
+    template <typename LookupFunc>
+    Result ExecuteProgram(const std::vector<Instruction>& instructions, uint32_t maxStackDepth, std::span<const int> slotValues, LookupFunc&& lookupVariable, int& result_out, ILoggingInterface* logger)
+    {
+      assert(!instructions.empty());
+
+      // Conditions are small, so the stack practically always fits on the C++ stack
+      constexpr uint32_t maxInlineStackDepth = 32;
+      int64_t inlineStack[maxInlineStackDepth];
+      std::vector<int64_t> heapStack;
+
+      int64_t* stack = inlineStack;
+      if (maxStackDepth > maxInlineStackDepth)
+      {
+        heapStack.resize(maxStackDepth);
+        stack = heapStack.data();
+      }
+
+      uint32_t top = 0; // Number of values on the stack
+
+      for (size_t ip = 0; ip < instructions.size(); ++ip)
+      {
+        const Instruction& instruction = instructions[ip];
+
+        switch (instruction.m_opCode)
+        {
+          case OpCode::PushConstant:
+            stack[top++] = instruction.m_operand;
+            continue;
+
+          case OpCode::PushVariable:
+          {
+            int64_t value = 0;
+            if (lookupVariable(static_cast<uint32_t>(instruction.m_operand), value).Failed())
+              return HYDRA_FAILURE;
+
+            stack[top++] = value;
+            continue;
+          }
+
+          case OpCode::PushSlot:
+            stack[top++] = slotValues[instruction.m_operand];
+            continue;
+
+          case OpCode::Negate:
+          case OpCode::BitNot:
+          case OpCode::LogicalNot:
+          case OpCode::ToBool:
+            stack[top - 1] = ApplyUnaryOperator(instruction.m_opCode, stack[top - 1]);
+            continue;
+
+          case OpCode::JumpIfFalse:
+            if (stack[top - 1] == 0)
+              ip += instruction.m_operand;
+            else
+              --top;
+            continue;
+
+          case OpCode::JumpIfTrue:
+            if (stack[top - 1] != 0)
+            {
+              stack[top - 1] = 1;
+              ip += instruction.m_operand;
+            }
+            else
+              --top;
+            continue;
+
+          default:
+            break;
+        }
+
+        // Binary operators
+        const int64_t rhs = stack[--top];
+        int64_t& lhs = stack[top - 1];
+
+        if ((instruction.m_opCode == OpCode::Divide || instruction.m_opCode == OpCode::Modulo) && rhs == 0)
+        {
+          Log::Error(logger, "Division by zero in condition");
+          return HYDRA_FAILURE;
+        }
+
+        lhs = ApplyBinaryOperator(instruction.m_opCode, lhs, rhs);
+      }
+
+      assert(top == 1);
+      result_out = static_cast<int>(stack[0]);
+      return HYDRA_SUCCESS;
+    }
+  } // namespace
+
+  Result CompiledCondition::Evaluate(const ValueTable& values, int& result_out, Evaluator::Mode mode, ILoggingInterface* logger) const
+  {
+    if (m_instructions.empty())
+    {
+      if (mode == Evaluator::Mode::Strict)
+      {
+        Log::Error(logger, "Empty expression");
+        return HYDRA_FAILURE;
+      }
+
+      result_out = 0;
+      return HYDRA_SUCCESS;
+    }
+
+    auto lookupVariable = [&](uint32_t variableIndex, int64_t& out_value) -> Result
+    {
+      if (auto it = values.find(m_variableNames[variableIndex]); it != values.end())
+      {
+        out_value = it->second;
+        return HYDRA_SUCCESS;
+      }
+
+      if (mode == Evaluator::Mode::Lenient)
+      {
+        out_value = 0;
+        return HYDRA_SUCCESS;
+      }
+
+      Log::Error(logger, "No value specified for identifier '%s'", m_variableNames[variableIndex].c_str());
+      return HYDRA_FAILURE;
+    };
+
+    return ExecuteProgram(m_instructions, m_maxStackDepth, {}, lookupVariable, result_out, logger);
+  }
+
+  namespace
+  {
+    /// A value on the stack of the partial evaluation: either a known constant, or the code that computes it at evaluation time.
+    struct PartialValue
+    {
+      std::optional<int64_t> m_constant;
+      std::vector<Instruction> m_code;
+
+      static PartialValue Constant(int64_t value, std::vector<Instruction> code)
+      {
+        PartialValue result;
+        result.m_constant = value;
+
+        // operands are only 32 bit, larger intermediate values keep the code that computes them
+        if (value >= INT32_MIN && value <= INT32_MAX)
+          result.m_code = {{OpCode::PushConstant, static_cast<int32_t>(value)}};
+        else
+          result.m_code = std::move(code);
+
+        return result;
+      }
+
+      static PartialValue Residual(std::vector<Instruction> code)
+      {
+        PartialValue result;
+        result.m_code = std::move(code);
+        return result;
+      }
+    };
+
+    /// Whether evaluating 'code' may fail, because it divides or reads a variable that has no known value.
+    bool CanFail(const std::vector<Instruction>& code, const ValueTable& knownValues, const std::vector<std::string>& variableNames)
+    {
+      for (const Instruction& instruction : code)
+      {
+        if (instruction.m_opCode == OpCode::Divide || instruction.m_opCode == OpCode::Modulo)
+          return true;
+
+        if (instruction.m_opCode == OpCode::PushVariable && knownValues.find(variableNames[instruction.m_operand]) == knownValues.end())
+          return true;
+      }
+
+      return false;
+    }
+
+    std::vector<Instruction> Concatenate(std::vector<Instruction>&& lhs, const std::vector<Instruction>& rhs, Instruction op)
+    {
+      lhs.insert(lhs.end(), rhs.begin(), rhs.end());
+      lhs.push_back(op);
+      return std::move(lhs);
+    }
+  } // namespace
+
+  void CompiledCondition::PartiallyEvaluate(const ValueTable& knownValues)
+  {
+    if (m_instructions.empty())
+      return;
+
+    /// A '&&' or '||' whose right operand is still being evaluated
+    struct PendingJump
+    {
+      OpCode m_jumpOpCode;
+      size_t m_endIndex; // index of the instruction after the right operand
+      PartialValue m_lhs;
+    };
+
+    std::vector<PartialValue> stack;
+    std::vector<PendingJump> pendingJumps;
+
+    // combines the operands of the innermost '&&' or '||' once its right operand is complete
+    auto finishJumps = [&](size_t index)
+    {
+      while (!pendingJumps.empty() && pendingJumps.back().m_endIndex == index)
+      {
+        PendingJump jump = std::move(pendingJumps.back());
+        pendingJumps.pop_back();
+
+        PartialValue rhs = std::move(stack.back()); // already normalized by ToBool
+        stack.pop_back();
+
+        const int64_t decidingValue = (jump.m_jumpOpCode == OpCode::JumpIfFalse) ? 0 : 1;
+
+        if (jump.m_lhs.m_constant.has_value())
+        {
+          // a known left operand either decides the result or leaves only the right one
+          if ((*jump.m_lhs.m_constant != 0) == (decidingValue != 0))
+            stack.push_back(PartialValue::Constant(decidingValue, {}));
+          else
+            stack.push_back(std::move(rhs));
+        }
+        else if (rhs.m_constant.has_value() && *rhs.m_constant == decidingValue && !CanFail(jump.m_lhs.m_code, knownValues, m_variableNames))
+        {
+          // the left operand is evaluated first, so it may only be dropped if it can't report an error
+          stack.push_back(PartialValue::Constant(decidingValue, {}));
+        }
+        else if (rhs.m_constant.has_value() && *rhs.m_constant != decidingValue)
+        {
+          jump.m_lhs.m_code.push_back({OpCode::ToBool, 0});
+          stack.push_back(PartialValue::Residual(std::move(jump.m_lhs.m_code)));
+        }
+        else
+        {
+          std::vector<Instruction> code = std::move(jump.m_lhs.m_code);
+          code.push_back({jump.m_jumpOpCode, static_cast<int32_t>(rhs.m_code.size())});
+          code.insert(code.end(), rhs.m_code.begin(), rhs.m_code.end());
+          stack.push_back(PartialValue::Residual(std::move(code)));
+        }
+      }
+    };
+
+    for (size_t index = 0; index < m_instructions.size(); ++index)
+    {
+      finishJumps(index);
+
+      const Instruction& instruction = m_instructions[index];
+
+      switch (instruction.m_opCode)
+      {
+        case OpCode::PushConstant:
+          stack.push_back(PartialValue::Constant(instruction.m_operand, {instruction}));
+          continue;
+
+        case OpCode::PushVariable:
+          if (auto it = knownValues.find(m_variableNames[instruction.m_operand]); it != knownValues.end())
+            stack.push_back(PartialValue::Constant(it->second, {instruction}));
+          else
+            stack.push_back(PartialValue::Residual({instruction}));
+          continue;
+
+        case OpCode::Negate:
+        case OpCode::BitNot:
+        case OpCode::LogicalNot:
+        case OpCode::ToBool:
+        {
+          PartialValue& value = stack.back();
+          value.m_code.push_back(instruction);
+
+          if (value.m_constant.has_value())
+            value = PartialValue::Constant(ApplyUnaryOperator(instruction.m_opCode, *value.m_constant), std::move(value.m_code));
+
+          continue;
+        }
+
+        case OpCode::JumpIfFalse:
+        case OpCode::JumpIfTrue:
+          pendingJumps.push_back({instruction.m_opCode, index + 1 + instruction.m_operand, std::move(stack.back())});
+          stack.pop_back();
+          continue;
+
+        default:
+          break;
+      }
+
+      PartialValue rhs = std::move(stack.back());
+      stack.pop_back();
+      PartialValue lhs = std::move(stack.back());
+      stack.pop_back();
+
+      const bool isDivision = instruction.m_opCode == OpCode::Divide || instruction.m_opCode == OpCode::Modulo;
+
+      if (lhs.m_constant.has_value() && rhs.m_constant.has_value() && !(isDivision && *rhs.m_constant == 0))
+      {
+        const int64_t value = ApplyBinaryOperator(instruction.m_opCode, *lhs.m_constant, *rhs.m_constant);
+        stack.push_back(PartialValue::Constant(value, Concatenate(std::move(lhs.m_code), rhs.m_code, instruction)));
+        continue;
+      }
+
+      stack.push_back(PartialValue::Residual(Concatenate(std::move(lhs.m_code), rhs.m_code, instruction)));
+    }
+
+    finishJumps(m_instructions.size());
+
+    assert(stack.size() == 1 && pendingJumps.empty());
+
+    if (stack.back().m_constant.has_value())
+    {
+      // the final value is truncated to an int anyway
+      m_instructions = {{OpCode::PushConstant, static_cast<int32_t>(*stack.back().m_constant)}};
+    }
+    else
+    {
+      m_instructions = std::move(stack.back().m_code);
+    }
+
+    // only keep the variables that are still read
+    std::vector<std::string> remainingNames;
+    std::vector<int32_t> remap(m_variableNames.size(), -1);
+
+    for (Instruction& instruction : m_instructions)
+    {
+      if (instruction.m_opCode != OpCode::PushVariable)
+        continue;
+
+      int32_t& newIndex = remap[instruction.m_operand];
+      if (newIndex < 0)
+      {
+        newIndex = static_cast<int32_t>(remainingNames.size());
+        remainingNames.push_back(std::move(m_variableNames[instruction.m_operand]));
+      }
+
+      instruction.m_operand = newIndex;
+    }
+
+    m_variableNames = std::move(remainingNames);
+    m_maxStackDepth = ComputeMaxStackDepth(m_instructions);
+  }
+
+  std::optional<int> CompiledCondition::GetConstantValue() const
+  {
+    if (m_instructions.size() == 1 && m_instructions[0].m_opCode == OpCode::PushConstant)
+      return m_instructions[0].m_operand;
+
+    return std::nullopt;
+  }
+
+  Result CompiledCondition::Bind(ConditionVariableSlots& slots, BoundCondition& out_bound, ILoggingInterface* logger) const
+  {
+    std::vector<Instruction> variableInstructions(m_variableNames.size());
+    for (size_t i = 0; i < m_variableNames.size(); ++i)
+    {
+      if (slots.ResolveIdentifier(m_variableNames[i], variableInstructions[i]).Failed())
+      {
+        Log::Error(logger, "Condition uses unknown identifier '%s'", m_variableNames[i].c_str());
+        return HYDRA_FAILURE;
+      }
+    }
+
+    out_bound.m_instructions = m_instructions;
+    out_bound.m_maxStackDepth = m_maxStackDepth;
+    out_bound.m_numRequiredSlots = 0;
+
+    for (Instruction& instruction : out_bound.m_instructions)
+    {
+      if (instruction.m_opCode == OpCode::PushVariable)
+      {
+        instruction = variableInstructions[instruction.m_operand];
+
+        if (instruction.m_opCode == OpCode::PushSlot)
+        {
+          out_bound.m_numRequiredSlots = std::max<uint32_t>(out_bound.m_numRequiredSlots, instruction.m_operand + 1);
+        }
+      }
+    }
+
+    return HYDRA_SUCCESS;
+  }
+
+  //////////////////////////////////////////////////////////////////////////
+
+  Result BoundCondition::Evaluate(std::span<const int> slotValues, int& result_out, ILoggingInterface* logger) const
+  {
+    if (m_instructions.empty())
+    {
+      Log::Error(logger, "Empty expression");
+      return HYDRA_FAILURE;
+    }
+
+    assert(slotValues.size() >= m_numRequiredSlots);
+
+    auto noVariables = [](uint32_t, int64_t&) -> Result
+    {
+      assert(false && "Bound conditions only read slots");
+      return HYDRA_FAILURE;
+    };
+
+    return ExecuteProgram(m_instructions, m_maxStackDepth, slotValues, noVariables, result_out, logger);
+  }
+
+  //////////////////////////////////////////////////////////////////////////
+
+  ConditionVariableSlots::ConditionVariableSlots(const PermutationManager* manager)
+    : m_manager(manager)
+  {
+  }
+
+  uint32_t ConditionVariableSlots::AddVariable(std::string_view name)
+  {
+    if (std::optional<uint32_t> slot = FindSlot(name))
+      return *slot;
+
+    const uint32_t slot = static_cast<uint32_t>(m_slotNames.size());
+    m_slotNames.emplace_back(name);
+    m_slotVariables.push_back(m_manager != nullptr ? m_manager->GetVariable(m_slotNames.back().c_str()) : nullptr);
+    m_nameToSlot.insert({m_slotNames.back(), slot});
+
+    return slot;
+  }
+
+  std::optional<uint32_t> ConditionVariableSlots::FindSlot(std::string_view name) const
+  {
+    if (auto it = m_nameToSlot.find(name); it != m_nameToSlot.end())
+      return it->second;
+
+    return std::nullopt;
+  }
+
+  Result ConditionVariableSlots::ResolveIdentifier(std::string_view name, CompiledCondition::Instruction& out_instruction)
+  {
+    if (std::optional<uint32_t> slot = FindSlot(name))
+    {
+      out_instruction = {OpCode::PushSlot, static_cast<int32_t>(*slot)};
+      return HYDRA_SUCCESS;
+    }
+
+    if (m_manager == nullptr)
+    {
+      out_instruction = {OpCode::PushSlot, static_cast<int32_t>(AddVariable(name))};
+      return HYDRA_SUCCESS;
+    }
+
+    const std::string nameString(name);
+    if (m_manager->GetVariable(nameString.c_str()) != nullptr)
+    {
+      out_instruction = {OpCode::PushSlot, static_cast<int32_t>(AddVariable(name))};
+      return HYDRA_SUCCESS;
+    }
+
+    // 'Enum::Value' identifiers are constants
+    const size_t separator = nameString.find("::");
+    if (separator != std::string::npos)
+    {
+      const std::string enumName = nameString.substr(0, separator);
+      const std::string valueName = nameString.substr(separator + 2);
+
+      if (const PermutationVariableEntry* enumVariable = m_manager->GetVariable(enumName.c_str()); enumVariable != nullptr && enumVariable->m_type == PermutationVariableEntry::Type::Enum)
+      {
+        uint32_t encodedValue = 0;
+        if (enumVariable->GetEncodedValue(valueName.c_str(), encodedValue).Succeeded())
+        {
+          out_instruction = {OpCode::PushConstant, enumVariable->GetValueInt(encodedValue)};
+          return HYDRA_SUCCESS;
+        }
+      }
+    }
+
+    return HYDRA_FAILURE;
+  }
+
+} // namespace Hydra::Tools
@@ -0,0 +1,118 @@
+#include <HydraTools/CompiledCondition.h>
+#include <HydraTools/ConditionCache.h>
+
+#include <cstring>
+
+namespace Hydra::Tools
+{
+  namespace
+  {
+    /// Trims the text and turns every run of whitespace into a single space.
+    std::string NormalizeConditionText(std::string_view text)
+    {
+      std::string result;
+      result.reserve(text.size());
+
+      bool pendingSpace = false;
+      for (const char c : text)
+      {
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+        {
+          pendingSpace = !result.empty();
+          continue;
+        }
+
+        if (pendingSpace)
+        {
+          result += ' ';
+          pendingSpace = false;
+        }
+
+        result += c;
+      }
+
+      return result;
+    }
+
+    /// A key that is equal for two conditions exactly if they have the same variables and instructions.
+    std::string GetProgramKey(const CompiledCondition& condition)
+    {
+      std::string key;
+
+      for (const std::string& name : condition.GetVariableNames())
+      {
+        key += name;
+        key += '\0';
+      }
+
+      key += '\0';
+
+      for (const CompiledCondition::Instruction& instruction : condition.GetInstructions())
+      {
+        char bytes[1 + sizeof(int32_t)];
+        bytes[0] = static_cast<char>(instruction.m_opCode);
+        std::memcpy(bytes + 1, &instruction.m_operand, sizeof(int32_t));
+        key.append(bytes, sizeof(bytes));
+      }
+
+      return key;
+    }
+  } // namespace
+
+  ConditionCache::ConditionCache() = default;
+  ConditionCache::~ConditionCache() = default;
+
+  std::shared_ptr<const CompiledCondition> ConditionCache::GetCondition(std::string_view text)
+  {
+    std::string normalizedText = NormalizeConditionText(text);
+
+    {
+      std::scoped_lock<std::mutex> lock(m_mutex);
+
+      if (auto it = m_conditionsByText.find(normalizedText); it != m_conditionsByText.end())
+        return it->second;
+    }
+
+    // compile outside the lock, two threads may compile the same text, but only the first result is kept
+    std::shared_ptr<const CompiledCondition> condition;
+    auto compiledCondition = std::make_shared<CompiledCondition>();
+    if (compiledCondition->Compile(normalizedText, nullptr).Succeeded())
+    {
+      condition = std::move(compiledCondition);
+    }
+
+    std::scoped_lock<std::mutex> lock(m_mutex);
+
+    if (condition)
+    {
+      condition = GetConditionInternal(std::move(condition));
+    }
+
+    return m_conditionsByText.emplace(std::move(normalizedText), std::move(condition)).first->second;
+  }
+
+  std::shared_ptr<const CompiledCondition> ConditionCache::GetCondition(std::shared_ptr<const CompiledCondition> condition)
+  {
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return GetConditionInternal(std::move(condition));
+  }
+
+  std::shared_ptr<const CompiledCondition> ConditionCache::GetConditionInternal(std::shared_ptr<const CompiledCondition> condition)
+  {
+    return m_conditionsByProgram.try_emplace(GetProgramKey(*condition), std::move(condition)).first->second;
+  }
+
+  size_t ConditionCache::GetNumConditions() const
+  {
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_conditionsByProgram.size();
+  }
+
+  void ConditionCache::Clear()
+  {
+    std::scoped_lock<std::mutex> lock(m_mutex);
+    m_conditionsByText.clear();
+    m_conditionsByProgram.clear();
+  }
+
+} // namespace Hydra::Tools
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <HydraTools/CompiledCondition.h>
+
+#include <assert.h>
+#include <cstdint>
+
+// The operators of compiled conditions, shared by all code that executes them, so that every evaluation computes the same values.
+
+namespace Hydra::Tools
+{
+  inline int64_t ApplyUnaryOperator(CompiledCondition::OpCode opCode, int64_t value)
+  {
+    switch (opCode)
+    {
+      case CompiledCondition::OpCode::Negate:
+        return -value;
+      case CompiledCondition::OpCode::BitNot:
+        return ~value;
+      case CompiledCondition::OpCode::LogicalNot:
+        return (value != 0) ? 0 : 1;
+      case CompiledCondition::OpCode::ToBool:
+        return (value != 0) ? 1 : 0;
+      default:
+        assert(false);
+        return 0;
+    }
+  }
+
+  /// Divisions by zero have to be handled by the caller.
+  inline int64_t ApplyBinaryOperator(CompiledCondition::OpCode opCode, int64_t lhs, int64_t rhs)
+  {
+    switch (opCode)
+    {
+      case CompiledCondition::OpCode::Multiply:
+        return lhs * rhs;
+      case CompiledCondition::OpCode::Divide:
+        return lhs / rhs;
+      case CompiledCondition::OpCode::Modulo:
+        return lhs % rhs;
+      case CompiledCondition::OpCode::Add:
+        return lhs + rhs;
+      case CompiledCondition::OpCode::Subtract:
+        return lhs - rhs;
+      case CompiledCondition::OpCode::ShiftLeft:
+        return lhs << rhs;
+      case CompiledCondition::OpCode::ShiftRight:
+        return lhs >> rhs;
+      case CompiledCondition::OpCode::Less:
+        return (lhs < rhs) ? 1 : 0;
+      case CompiledCondition::OpCode::LessEqual:
+        return (lhs <= rhs) ? 1 : 0;
+      case CompiledCondition::OpCode::Greater:
+        return (lhs > rhs) ? 1 : 0;
+      case CompiledCondition::OpCode::GreaterEqual:
+        return (lhs >= rhs) ? 1 : 0;
+      case CompiledCondition::OpCode::Equal:
+        return (lhs == rhs) ? 1 : 0;
+      case CompiledCondition::OpCode::NotEqual:
+        return (lhs != rhs) ? 1 : 0;
+      case CompiledCondition::OpCode::BitAnd:
+        return lhs & rhs;
+      case CompiledCondition::OpCode::BitXor:
+        return lhs ^ rhs;
+      case CompiledCondition::OpCode::BitOr:
+        return lhs | rhs;
+      default:
+        assert(false);
+        return 0;
+    }
+  }
+} // namespace Hydra::Tools
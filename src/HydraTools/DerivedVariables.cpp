@@ -0,0 +1,51 @@
+#include <HydraTools/DerivedVariables.h>
+
+#include <HydraRuntime/Logger.h>
+#include <HydraRuntime/PermutationManager.h>
+#include <HydraTools/CompiledCondition.h>
+
+#include <memory>
+
+namespace Hydra::Tools
+{
+  Runtime::Result RegisterDerivedVariable(Runtime::PermutationManager& manager, const char* variableName, std::string_view expression, Runtime::ILoggingInterface* logger)
+  {
+    const Runtime::PermutationVariableEntry* variable = manager.GetVariable(variableName);
+    if (variable == nullptr)
+    {
+      Runtime::Log::Error(logger, "Derived permutation variable '%s' is not registered.", variableName);
+      return Runtime::HYDRA_FAILURE;
+    }
+
+    CompiledCondition condition;
+    if (condition.Compile(expression, logger).Failed() || condition.IsEmpty())
+    {
+      Runtime::Log::Error(logger, "Invalid expression for derived permutation variable '%s': '%s'", variableName, std::string(expression).c_str());
+      return Runtime::HYDRA_FAILURE;
+    }
+
+    // Every variable that the expression reads gets a slot and the slots are passed to the manager as the inputs,
+    // so the input values can be used as the slot values directly
+    ConditionVariableSlots slots(&manager);
+    auto bound = std::make_shared<BoundCondition>();
+    if (condition.Bind(slots, *bound, logger).Failed())
+    {
+      Runtime::Log::Error(logger, "Expression for derived permutation variable '%s' uses unknown identifiers: '%s'", variableName, std::string(expression).c_str());
+      return Runtime::HYDRA_FAILURE;
+    }
+
+    std::vector<const Runtime::PermutationVariableEntry*> inputs;
+    for (uint32_t slot = 0; slot < slots.GetNumSlots(); ++slot)
+    {
+      inputs.push_back(slots.GetSlotVariable(slot));
+    }
+
+    auto deriveFunc = [bound, logger](std::span<const int> inputValues, int& out_value) -> Runtime::Result
+    {
+      return bound->Evaluate(inputValues, out_value, logger);
+    };
+
+    return manager.RegisterDerivedVariable(*variable, inputs, deriveFunc);
+  }
+
+} // namespace Hydra::Tools
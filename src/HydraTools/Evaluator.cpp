@@ -1,4 +1,5 @@
 #include <HydraTools/Evaluator.h>
+#include <HydraTools/TokenParsing.h>
 #include <HydraTools/Tokenizer.h>
 
 #include <HydraRuntime/HydraRuntime.h>
@@ -6,6 +7,7 @@
 #include <assert.h>
 #include <charconv>
 #include <iostream>
+#include <optional>
 #include <string_view>
 
 
@@ -27,131 +29,26 @@ namespace
     GreaterThanEqual
   };
 
-  void SkipComments(const TokenStream& input, uint32_t& currentToken)
-  {
-    while (currentToken < input.size() &&
-           (input[currentToken].m_type == Token::Type::LineComment || input[currentToken].m_type == Token::Type::BlockComment))
-    {
-      ++currentToken;
-    }
-  }
-
-  bool Accept(const TokenStream& input, uint32_t& currentToken, std::string_view token)
-  {
-    SkipComments(input, currentToken);
-
-    if (currentToken >= input.size())
-      return false;
-
-    if (input[currentToken].m_token == token)
-    {
-      ++currentToken;
-      return true;
-    }
-
-    return false;
-  }
-
-  bool Accept(const TokenStream& input, uint32_t& currentToken, std::string_view token1, std::string_view token2)
-  {
-    SkipComments(input, currentToken);
-
-    if (currentToken + 1 >= input.size())
-    {
-      return false;
-    }
-
-    if (input[currentToken].m_token == token1 && input[currentToken + 1].m_token == token2)
-    {
-      currentToken += 2;
-      return true;
-    }
-
-    return false;
-  }
-
-  bool AcceptUnless(const TokenStream& input, uint32_t& currentToken, std::string_view token1, std::string_view token2)
-  {
-    SkipComments(input, currentToken);
-
-    if (currentToken + 1 >= input.size())
-      return false;
-
-    if (input[currentToken].m_token == token1 && input[currentToken + 1].m_token != token2)
-    {
-      currentToken += 1;
-      return true;
-    }
-
-    return false;
-  }
-
-  bool Accept(const TokenStream& input, uint32_t& currentToken, Token::Type tokenType, uint32_t* pAccepted)
-  {
-    SkipComments(input, currentToken);
-
-    if (currentToken >= input.size())
-      return false;
-
-    if (input[currentToken].m_type == tokenType)
-    {
-      if (pAccepted)
-        *pAccepted = currentToken;
-
-      ++currentToken;
-      return true;
-    }
-
-    return false;
-  }
-
-  Result Expect(const TokenStream& input, uint32_t& currentToken, std::string_view token, ILoggingInterface* logger)
-  {
-    if (Accept(input, currentToken, token))
-      return HYDRA_SUCCESS;
-
-    Log::Error(logger, "Evaluator expected token '%s' instead of '%s'",
-      std::string(token).c_str(),
-      std::string(input[std::min<size_t>(currentToken, input.size() - 1)].m_token).c_str());
-
-    return HYDRA_FAILURE;
-  }
-
-  Result ExpectEndOfLineOrInput(const TokenStream& input, uint32_t& currentToken, ILoggingInterface* logger)
-  {
-    SkipComments(input, currentToken);
-
-    if (currentToken >= input.size())
-      return HYDRA_SUCCESS;
-
-    if (Accept(input, currentToken, Token::Type::NewLine, nullptr))
-      return HYDRA_SUCCESS;
-
-    Log::Error(logger,
-      "Evaluator expected end-of-line token or end of input instead of token '%s'",
-      std::string(input[std::min<size_t>(currentToken, input.size() - 1)].m_token).c_str());
-
-    return HYDRA_FAILURE;
-  }
-
   struct ParseInput
   {
     const TokenStream& input;
-    const ValueTable& values;
+    const ValueTable* values;
+    const SymbolValueTable* symbolValues; // Used instead of 'values' if set
     Evaluator::Mode mode;
     ValueList* usedValues_out;
     ILoggingInterface* logger;
+    bool skip = false; // Set for operands that '&&' and '||' short-circuit: these are only parsed, and identifiers are only recorded
   };
 
   Result ParseExpressionOr(const ParseInput& pi, uint32_t& currentToken, int64_t& result);
 
   Result ParseFactor(const ParseInput& pi, uint32_t& currentToken, int64_t& result)
   {
-    while (Accept(pi.input, currentToken, "+"))
+    while (Accept(pi.input, currentToken, Token::Operator::Plus))
     {
     }
 
-    if (Accept(pi.input, currentToken, "-"))
+    if (Accept(pi.input, currentToken, Token::Operator::Minus))
     {
       if (ParseFactor(pi, currentToken, result).Failed())
         return HYDRA_FAILURE;
@@ -160,7 +57,7 @@ namespace
       return HYDRA_SUCCESS;
     }
 
-    if (Accept(pi.input, currentToken, "~"))
+    if (Accept(pi.input, currentToken, Token::Operator::BitNot))
     {
       if (ParseFactor(pi, currentToken, result).Failed())
         return HYDRA_FAILURE;
@@ -169,7 +66,7 @@ namespace
       return HYDRA_SUCCESS;
     }
 
-    if (Accept(pi.input, currentToken, "!"))
+    if (Accept(pi.input, currentToken, Token::Operator::LogicalNot))
     {
       if (ParseFactor(pi, currentToken, result).Failed())
         return HYDRA_FAILURE;
@@ -182,12 +79,13 @@ namespace
     if (Accept(pi.input, currentToken, Token::Type::Identifier, &valueToken))
     {
       using namespace std::literals;
-      std::string_view token = pi.input[valueToken].m_token;
-      if (token == "true")
+      const Token& identifier = pi.input[valueToken];
+      std::string_view token = identifier.m_token;
+      if (identifier.m_symbol == SYMBOL_TRUE || (identifier.m_symbol == INVALID_SYMBOL && token == "true"))
       {
         result = 1;
       }
-      else if (token == "false")
+      else if (identifier.m_symbol == SYMBOL_FALSE || (identifier.m_symbol == INVALID_SYMBOL && token == "false"))
       {
         result = 0;
       }
@@ -198,10 +96,27 @@ namespace
           pi.usedValues_out->insert(token);
         }
 
+        if (pi.skip)
+        {
+          result = 0;
+          return HYDRA_SUCCESS;
+        }
+
         // Try to find variable name in value table...
-        if (auto it = pi.values.find(token); it != pi.values.end())
+        std::optional<int> value;
+        if (pi.symbolValues != nullptr)
+        {
+          if (auto it = pi.symbolValues->find(identifier.m_symbol); it != pi.symbolValues->end())
+            value = it->second;
+        }
+        else if (auto it = pi.values->find(token); it != pi.values->end())
         {
-          result = it->second;
+          value = it->second;
+        }
+
+        if (value.has_value())
+        {
+          result = *value;
         }
         else if (pi.mode == Evaluator::Mode::Lenient)
         {
@@ -219,32 +134,20 @@ namespace
     }
     else if (Accept(pi.input, currentToken, Token::Type::Integer, &valueToken))
     {
-      std::string_view token = pi.input[valueToken].m_token;
-      int value = 0;
-      if (token.starts_with("0x") || token.starts_with("0X"))
-      {
-        auto ret = std::from_chars(token.data() + 2, token.data() + token.size(), value, 16);
-        assert(ret.ec != std::errc::invalid_argument);
-      }
-      else
-      {
-        auto ret = std::from_chars(token.data(), token.data() + token.size(), value);
-        assert(ret.ec != std::errc::invalid_argument);
-      }
-      result = static_cast<int64_t>(value);
+      result = static_cast<int64_t>(ParseIntegerToken(pi.input[valueToken].m_token));
       return HYDRA_SUCCESS;
     }
-    else if (Accept(pi.input, currentToken, "("))
+    else if (Accept(pi.input, currentToken, Token::Operator::OpenParenthesis))
     {
       if (ParseExpressionOr(pi, currentToken, result).Failed())
         return HYDRA_FAILURE;
 
-      return Expect(pi.input, currentToken, ")", pi.logger);
+      return Expect(pi.input, currentToken, Token::Operator::CloseParenthesis, ")", pi.logger);
     }
 
     Log::Error(pi.logger,
       "Syntax error - expected identifier, number, or '(' instead of '%s'",
-      std::string(pi.input[std::min<size_t>(currentToken, pi.input.size() - 1)].m_token).c_str());
+      GetErrorTokenText(pi.input, currentToken).c_str());
 
     return HYDRA_FAILURE;
   }
@@ -256,7 +159,7 @@ namespace
 
     while (true)
     {
-      if (Accept(pi.input, currentToken, "*"))
+      if (Accept(pi.input, currentToken, Token::Operator::Multiply))
       {
         int64_t nextValue = 0;
         if (ParseFactor(pi, currentToken, nextValue).Failed())
@@ -264,20 +167,38 @@ namespace
 
         result *= nextValue;
       }
-      else if (Accept(pi.input, currentToken, "/"))
+      else if (Accept(pi.input, currentToken, Token::Operator::Divide))
       {
         int64_t nextValue = 0;
         if (ParseFactor(pi, currentToken, nextValue).Failed())
           return HYDRA_FAILURE;
 
+        if (nextValue == 0)
+        {
+          if (pi.skip)
+            continue;
+
+          Log::Error(pi.logger, "Division by zero in condition");
+          return HYDRA_FAILURE;
+        }
+
         result /= nextValue;
       }
-      else if (Accept(pi.input, currentToken, "%"))
+      else if (Accept(pi.input, currentToken, Token::Operator::Modulo))
       {
         int64_t nextValue = 0;
         if (ParseFactor(pi, currentToken, nextValue).Failed())
           return HYDRA_FAILURE;
 
+        if (nextValue == 0)
+        {
+          if (pi.skip)
+            continue;
+
+          Log::Error(pi.logger, "Division by zero in condition");
+          return HYDRA_FAILURE;
+        }
+
         result %= nextValue;
       }
       else
@@ -294,7 +215,7 @@ namespace
 
     while (true)
     {
-      if (Accept(pi.input, currentToken, "+"))
+      if (Accept(pi.input, currentToken, Token::Operator::Plus))
       {
         int64_t nextValue = 0;
         if (ParseExpressionMul(pi, currentToken, nextValue).Failed())
@@ -302,7 +223,7 @@ namespace
 
         result += nextValue;
       }
-      else if (Accept(pi.input, currentToken, "-"))
+      else if (Accept(pi.input, currentToken, Token::Operator::Minus))
       {
         int64_t nextValue = 0;
         if (ParseExpressionMul(pi, currentToken, nextValue).Failed())
@@ -324,7 +245,7 @@ namespace
 
     while (true)
     {
-      if (Accept(pi.input, currentToken, ">", ">"))
+      if (Accept(pi.input, currentToken, Token::Operator::ShiftRight))
       {
         int64_t nextValue = 0;
         if (ParseExpressionPlus(pi, currentToken, nextValue).Failed())
@@ -332,7 +253,7 @@ namespace
 
         result >>= nextValue;
       }
-      else if (Accept(pi.input, currentToken, "<", "<"))
+      else if (Accept(pi.input, currentToken, Token::Operator::ShiftLeft))
       {
         int64_t nextValue = 0;
         if (ParseExpressionPlus(pi, currentToken, nextValue).Failed())
@@ -355,17 +276,17 @@ namespace
 
     Comparison Operator = Comparison::None;
 
-    if (Accept(pi.input, currentToken, "=", "="))
+    if (Accept(pi.input, currentToken, Token::Operator::Equal))
       Operator = Comparison::Equal;
-    else if (Accept(pi.input, currentToken, "!", "="))
+    else if (Accept(pi.input, currentToken, Token::Operator::NotEqual))
       Operator = Comparison::Unequal;
-    else if (Accept(pi.input, currentToken, ">", "="))
+    else if (Accept(pi.input, currentToken, Token::Operator::GreaterEqual))
       Operator = Comparison::GreaterThanEqual;
-    else if (Accept(pi.input, currentToken, "<", "="))
+    else if (Accept(pi.input, currentToken, Token::Operator::LessEqual))
       Operator = Comparison::LessThanEqual;
-    else if (AcceptUnless(pi.input, currentToken, ">", ">"))
+    else if (Accept(pi.input, currentToken, Token::Operator::Greater))
       Operator = Comparison::GreaterThan;
-    else if (AcceptUnless(pi.input, currentToken, "<", "<"))
+    else if (Accept(pi.input, currentToken, Token::Operator::Less))
       Operator = Comparison::LessThan;
     else
     {
@@ -400,7 +321,7 @@ namespace
       case Comparison::None:
         Log::Error(pi.logger,
           "Unknown operator '%s'",
-          std::string(pi.input[std::min<size_t>(currentToken, pi.input.size() - 1)].m_token).c_str());
+          GetErrorTokenText(pi.input, currentToken).c_str());
         return HYDRA_FAILURE;
     }
 
@@ -412,7 +333,7 @@ namespace
     if (ParseCondition(pi, currentToken, result).Failed())
       return HYDRA_FAILURE;
 
-    while (AcceptUnless(pi.input, currentToken, "&", "&"))
+    while (Accept(pi.input, currentToken, Token::Operator::BitAnd))
     {
       int64_t nextValue = 0;
       if (ParseCondition(pi, currentToken, nextValue).Failed())
@@ -429,7 +350,7 @@ namespace
     if (ParseExpressionBitAnd(pi, currentToken, result).Failed())
       return HYDRA_FAILURE;
 
-    while (Accept(pi.input, currentToken, "^"))
+    while (Accept(pi.input, currentToken, Token::Operator::BitXor))
     {
       int64_t nextValue = 0;
       if (ParseExpressionBitAnd(pi, currentToken, nextValue).Failed())
@@ -446,7 +367,7 @@ namespace
     if (ParseExpressionBitXor(pi, currentToken, result).Failed())
       return HYDRA_FAILURE;
 
-    while (AcceptUnless(pi.input, currentToken, "|", "|"))
+    while (Accept(pi.input, currentToken, Token::Operator::BitOr))
     {
       int64_t nextValue = 0;
       if (ParseExpressionBitXor(pi, currentToken, nextValue).Failed())
@@ -459,18 +380,32 @@ namespace
   }
 
 
+  /// Parses the right operand of '&&' or '||'. If 'isDecided', it is only parsed, but not evaluated.
+  template <typename ParseOperandFunc>
+  Result ParseShortCircuitOperand(const ParseInput& pi, uint32_t& currentToken, bool isDecided, ParseOperandFunc parseOperand, int64_t& result)
+  {
+    if (!isDecided || pi.skip)
+      return parseOperand(pi, currentToken, result);
+
+    ParseInput skipInput = pi;
+    skipInput.skip = true;
+    return parseOperand(skipInput, currentToken, result);
+  }
+
   Result ParseExpressionAnd(const ParseInput& pi, uint32_t& currentToken, int64_t& result)
   {
     if (ParseExpressionBitOr(pi, currentToken, result).Failed())
       return HYDRA_FAILURE;
 
-    while (Accept(pi.input, currentToken, "&", "&"))
+    while (Accept(pi.input, currentToken, Token::Operator::LogicalAnd))
     {
+      const bool isDecided = (result == 0);
+
       int64_t nextValue = 0;
-      if (ParseExpressionBitOr(pi, currentToken, nextValue).Failed())
+      if (ParseShortCircuitOperand(pi, currentToken, isDecided, ParseExpressionBitOr, nextValue).Failed())
         return HYDRA_FAILURE;
 
-      result = (result != 0 && nextValue != 0) ? 1 : 0;
+      result = (!isDecided && nextValue != 0) ? 1 : 0;
     }
 
     return HYDRA_SUCCESS;
@@ -481,13 +416,15 @@ namespace
     if (ParseExpressionAnd(pi, currentToken, result).Failed())
       return HYDRA_FAILURE;
 
-    while (Accept(pi.input, currentToken, "|", "|"))
+    while (Accept(pi.input, currentToken, Token::Operator::LogicalOr))
     {
+      const bool isDecided = (result != 0);
+
       int64_t nextValue = 0;
-      if (ParseExpressionAnd(pi, currentToken, nextValue).Failed())
+      if (ParseShortCircuitOperand(pi, currentToken, isDecided, ParseExpressionAnd, nextValue).Failed())
         return HYDRA_FAILURE;
 
-      result = (result != 0 || nextValue != 0) ? 1 : 0;
+      result = (isDecided || nextValue != 0) ? 1 : 0;
     }
 
     return HYDRA_SUCCESS;
@@ -499,8 +436,22 @@ namespace Hydra
   namespace Tools
   {
 
-    Evaluator::Evaluator(Hydra::Runtime::ILoggingInterface* logger)
+    const TokenStream& EvaluationContext::Tokenize(std::string_view input, Hydra::Runtime::ILoggingInterface* logger)
+    {
+      m_tokenizer.SetLogger(logger);
+      m_tokenizer.Tokenize(input);
+      return m_tokenizer.GetResult();
+    }
+
+    EvaluationContext& EvaluationContext::GetThreadLocal()
+    {
+      thread_local EvaluationContext s_context;
+      return s_context;
+    }
+
+    Evaluator::Evaluator(Hydra::Runtime::ILoggingInterface* logger, EvaluationContext* context)
       : m_logger(logger)
+      , m_context(context)
     {
     }
 
@@ -508,6 +459,18 @@ namespace Hydra
 
     Result Evaluator::EvaluateCondition(
       const TokenStream& input, const ValueTable& values, int& result_out, Mode mode, ValueList* usedValues_out)
+    {
+      return EvaluateConditionInternal(input, &values, nullptr, result_out, mode, usedValues_out);
+    }
+
+    Result Evaluator::EvaluateCondition(
+      const TokenStream& input, const SymbolValueTable& values, int& result_out, Mode mode, ValueList* usedValues_out)
+    {
+      return EvaluateConditionInternal(input, nullptr, &values, result_out, mode, usedValues_out);
+    }
+
+    Result Evaluator::EvaluateConditionInternal(
+      const TokenStream& input, const ValueTable* values, const SymbolValueTable* symbolValues, int& result_out, Mode mode, ValueList* usedValues_out)
     {
       int64_t result = 0;
       uint32_t currentToken = 0;
@@ -523,7 +486,7 @@ namespace Hydra
       }
       else
       {
-        ParseInput state = {input, values, mode, usedValues_out, m_logger};
+        ParseInput state = {input, values, symbolValues, mode, usedValues_out, m_logger};
         if (ParseExpressionOr(state, currentToken, result).Failed())
         {
           return HYDRA_FAILURE;
@@ -537,9 +500,8 @@ namespace Hydra
     Result Evaluator::EvaluateCondition(
       std::string_view input, const ValueTable& values, int& result_out, Mode mode, ValueList* usedValues_out)
     {
-      Tokenizer tokenizer;
-      tokenizer.Tokenize(input);
-      return EvaluateCondition(tokenizer.GetResult(), values, result_out, mode, usedValues_out);
+      EvaluationContext& context = (m_context != nullptr) ? *m_context : EvaluationContext::GetThreadLocal();
+      return EvaluateCondition(context.Tokenize(input, m_logger), values, result_out, mode, usedValues_out);
     }
 
 
@@ -1,3 +1,4 @@
+#include <HydraRuntime/Profiler.h>
 #include <HydraTools/FileCache.h>
 #include <assert.h>
 #include <filesystem>
@@ -19,27 +20,44 @@ namespace Hydra::Tools
     return ExistsFileOnDisk(normalizedPath);
   }
 
-  const std::string& FileCache::GetFileContent(std::string_view normalizedPath)
+  std::string_view FileCache::GetFileContent(std::string_view normalizedPath)
   {
     std::scoped_lock<std::recursive_mutex> lock(m_mutex);
+    return GetCachedFile(normalizedPath).m_content;
+  }
 
+  uint64_t FileCache::GetFileContentHash(std::string_view normalizedPath)
+  {
+    std::scoped_lock<std::recursive_mutex> lock(m_mutex);
+    return GetCachedFile(normalizedPath).m_contentHash;
+  }
+
+  const FileCache::CachedFile& FileCache::GetCachedFile(std::string_view normalizedPath)
+  {
     auto it = m_fileContents.find(normalizedPath);
     if (it != m_fileContents.end())
     {
       return it->second;
     }
 
-    std::string& content = m_fileContents[std::string(normalizedPath)]; // TODO: can we not convert to std::string ?
+    HYDRA_PROFILE_SCOPE("FileCache::ReadFile");
+
+    const std::string content = ReadFileFromDisk(normalizedPath);
 
-    content = std::move(ReadFileFromDisk(normalizedPath));
+    CachedFile& file = m_fileContents[String(normalizedPath)];
+    file.m_content.assign(content.data(), content.size());
+    file.m_contentHash = Runtime::Core::Hash64(content.data(), content.size());
 
-    return content;
+    m_numCachedBytes += content.size();
+    Runtime::Profiler::SetCounter("FileCache bytes", m_numCachedBytes);
+    return file;
   }
 
   void FileCache::ClearCache()
   {
     std::scoped_lock<std::recursive_mutex> lock(m_mutex);
     m_fileContents.clear();
+    m_numCachedBytes = 0;
   }
 
   //////////////////////////////////////////////////////////////////////////
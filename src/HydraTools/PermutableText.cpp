@@ -1,9 +1,14 @@
 #include <HydraRuntime/Logger.h>
+#include <HydraRuntime/Profiler.h>
 #include <HydraRuntime/Result.h>
+#include <HydraTools/CompiledCondition.h>
+#include <HydraTools/ConditionCache.h>
 #include <HydraTools/Evaluator.h>
 #include <HydraTools/PermutableText.h>
 #include <HydraTools/StringUtils.h>
+#include <algorithm>
 #include <cassert>
+#include <cctype>
 
 namespace Hydra::Tools
 {
@@ -47,49 +52,77 @@ namespace Hydra::Tools
     return piece;
   }
 
-  static PermutableTextPiece::Type DeterminePieceType(std::string_view& line)
+  static uint32_t GetLineNumber(std::string_view text, const char* position)
+  {
+    return 1 + static_cast<uint32_t>(std::count(text.data(), position, '\n'));
+  }
+
+  /// Determines the type of the directive in 'line' (the text after '#[') and reduces 'line' to the condition of #[if] and #[elif].
+  /// The keyword is the longest run of identifier characters and has to match exactly, so '#[if(A)]' is an #[if], but '#[ifdef A]' is unknown.
+  /// On failure, 'out_problem' describes the error.
+  static Runtime::Result DeterminePieceType(std::string_view& line, PermutableTextPiece::Type& out_type, const char*& out_problem)
   {
     SkipWhitespace(line);
-    PermutableTextPiece::Type result = PermutableTextPiece::Type::Unconditional;
+    TrimWhitespaceAtEnd(line);
+    out_type = PermutableTextPiece::Type::Unconditional;
 
-    if (Accept(line, "if"))
+    // remove expected ']' at end
+    if (line.empty() || line.back() != ']')
     {
-      result = PermutableTextPiece::Type::If;
+      out_problem = "is missing the closing ']'";
+      return Runtime::HYDRA_FAILURE;
     }
 
-    if (Accept(line, "elif"))
-    {
-      result = PermutableTextPiece::Type::Elif;
-    }
+    line.remove_suffix(1);
 
-    if (Accept(line, "else"))
+    size_t keywordLength = 0;
+    while (keywordLength < line.size() && (std::isalnum(static_cast<unsigned char>(line[keywordLength])) || line[keywordLength] == '_'))
     {
-      result = PermutableTextPiece::Type::Else;
+      ++keywordLength;
     }
 
-    if (Accept(line, "endif"))
-    {
-      result = PermutableTextPiece::Type::Endif;
-    }
+    const std::string_view keyword = line.substr(0, keywordLength);
+    line.remove_prefix(keywordLength);
 
     SkipWhitespace(line);
-    TrimWhitespaceAtEnd(line);
 
-    // remove expected ']' at end
-    // TODO: currently not an error, if the ] is missing
-    if (!line.empty() && line.back() == ']')
+    if (keyword == "if")
+    {
+      out_type = PermutableTextPiece::Type::If;
+    }
+    else if (keyword == "elif")
+    {
+      out_type = PermutableTextPiece::Type::Elif;
+    }
+    else if (keyword == "else")
+    {
+      out_type = PermutableTextPiece::Type::Else;
+    }
+    else if (keyword == "endif")
+    {
+      out_type = PermutableTextPiece::Type::Endif;
+    }
+    else
     {
-      line.remove_suffix(1);
+      out_problem = "is not a known directive";
+      return Runtime::HYDRA_FAILURE;
     }
 
-    TrimWhitespaceAtEnd(line);
+    if ((out_type == PermutableTextPiece::Type::Else || out_type == PermutableTextPiece::Type::Endif) && !line.empty())
+    {
+      out_problem = "must not have anything after its keyword";
+      return Runtime::HYDRA_FAILURE;
+    }
 
-    return result;
+    return Runtime::HYDRA_SUCCESS;
   }
 
-  void PermutableText::SetText(const std::string& fullText)
+  Runtime::Result PermutableText::SetText(const std::string& fullText, Runtime::ILoggingInterface* logger, ConditionCache* conditionCache)
   {
-    m_text = fullText;
+    m_text.assign(fullText.data(), fullText.size());
+    m_pieces.clear();
+    m_conditionCache = conditionCache;
+    m_isMalformed = false;
 
     std::string_view text = m_text;
 
@@ -109,11 +142,41 @@ namespace Hydra::Tools
       if (!nextCondition.empty())
       {
         PermutableTextPiece cb;
-        cb.m_type = DeterminePieceType(nextCondition);
         cb.m_text = nextCondition;
+
+        const char* problem = nullptr;
+        if (DeterminePieceType(cb.m_text, cb.m_type, problem).Failed())
+        {
+          std::string_view directive = nextCondition;
+          TrimWhitespaceAtEnd(directive);
+
+          Runtime::Log::Error(logger, "Permutable text structure is malformed in line %u: the directive '#[%.*s' %s.", GetLineNumber(m_text, nextCondition.data()), static_cast<int>(directive.size()), directive.data(), problem);
+          m_isMalformed = true;
+        }
+
+        if (cb.m_type == PermutableTextPiece::Type::If || cb.m_type == PermutableTextPiece::Type::Elif)
+        {
+          // Errors are reported when the condition is evaluated
+          if (m_conditionCache)
+          {
+            cb.m_condition = m_conditionCache->GetCondition(cb.m_text);
+          }
+          else if (auto condition = std::make_shared<CompiledCondition>(); condition->Compile(cb.m_text, nullptr).Succeeded())
+          {
+            cb.m_condition = std::move(condition);
+          }
+        }
+
         m_pieces.push_back(cb);
       }
     }
+
+    if (m_isMalformed)
+    {
+      return Runtime::HYDRA_FAILURE;
+    }
+
+    return LinkBranches(logger);
   }
 
   std::string_view PermutableText::GetOriginalText() const
@@ -121,189 +184,523 @@ namespace Hydra::Tools
     return m_text;
   }
 
-  Runtime::Result PermutableText::EnterBlock(const ValueTable& permutationVariables, size_t& blockIdx, std::string& output, Runtime::ILoggingInterface* logger) const
+  Runtime::Result PermutableText::LinkBranches(Runtime::ILoggingInterface* logger)
   {
-    bool foundIf = false;
-    bool foundTrueCondition = false;
+    struct OpenIf
+    {
+      uint32_t m_ifIdx = 0;
+      uint32_t m_lastBranchIdx = 0;
+    };
 
-    Evaluator evaluator(logger);
+    std::vector<OpenIf> openIfs;
 
-    while (blockIdx < m_pieces.size())
+    auto reportError = [&](uint32_t pieceIdx, const char* problem)
     {
-      const PermutableTextPiece& block = m_pieces[blockIdx];
+      Runtime::Log::Error(logger, "Permutable text structure is malformed in line %u: %s", GetLineNumber(m_text, m_pieces[pieceIdx].m_text.data()), problem);
+      m_isMalformed = true;
+      return Runtime::HYDRA_FAILURE;
+    };
 
-      switch (block.m_type)
+    for (uint32_t pieceIdx = 0; pieceIdx < m_pieces.size(); ++pieceIdx)
+    {
+      switch (m_pieces[pieceIdx].m_type)
       {
         case PermutableTextPiece::Type::Unconditional:
-        {
-          output += block.m_text;
-          ++blockIdx;
           break;
-        }
 
         case PermutableTextPiece::Type::If:
+          openIfs.push_back({pieceIdx, pieceIdx});
+          break;
 
-          if (foundIf)
-          {
-            Runtime::Log::Error(logger, "Permutable text structure is malformed.");
-            return Runtime::HYDRA_FAILURE;
-          }
+        case PermutableTextPiece::Type::Elif:
+        case PermutableTextPiece::Type::Else:
+          if (openIfs.empty())
+            return reportError(pieceIdx, "#[elif] or #[else] without #[if].");
 
-          foundIf = true;
-          foundTrueCondition = false;
-          [[fallthrough]];
+          if (m_pieces[openIfs.back().m_lastBranchIdx].m_type == PermutableTextPiece::Type::Else)
+            return reportError(pieceIdx, "#[elif] or #[else] after #[else].");
 
-        case PermutableTextPiece::Type::Elif:
+          m_pieces[openIfs.back().m_lastBranchIdx].m_nextBranchIdx = pieceIdx;
+          openIfs.back().m_lastBranchIdx = pieceIdx;
+          break;
+
+        case PermutableTextPiece::Type::Endif:
         {
-          if (!foundIf)
-          {
-            return Runtime::HYDRA_SUCCESS;
-          }
+          if (openIfs.empty())
+            return reportError(pieceIdx, "#[endif] without #[if].");
 
-          int conditionValue = 0;
-          if (!foundTrueCondition)
-          {
-            if (evaluator.EvaluateCondition(block.m_text, permutationVariables, conditionValue).Failed())
-            {
-              return Runtime::HYDRA_FAILURE;
-            }
-          }
+          const OpenIf openIf = openIfs.back();
+          openIfs.pop_back();
 
-          if (!foundTrueCondition && conditionValue != 0)
-          {
-            foundTrueCondition = true;
+          m_pieces[openIf.m_lastBranchIdx].m_nextBranchIdx = pieceIdx;
 
-            ++blockIdx;
-            if (EnterBlock(permutationVariables, blockIdx, output, logger).Failed())
-            {
-              return Runtime::HYDRA_FAILURE;
-            }
-          }
-          else
+          for (uint32_t branchIdx = openIf.m_ifIdx; branchIdx != pieceIdx; branchIdx = m_pieces[branchIdx].m_nextBranchIdx)
           {
-            ++blockIdx;
-            if (SkipBlock(blockIdx, logger).Failed())
-            {
-              return Runtime::HYDRA_FAILURE;
-            }
+            m_pieces[branchIdx].m_endifIdx = pieceIdx;
           }
-
           break;
         }
+      }
+    }
 
-        case PermutableTextPiece::Type::Else:
-        {
-          if (!foundIf)
-          {
-            return Runtime::HYDRA_SUCCESS;
-          }
+    if (!openIfs.empty())
+      return reportError(openIfs.back().m_ifIdx, "#[if] without #[endif].");
 
-          if (!foundTrueCondition)
-          {
-            ++blockIdx;
-            if (EnterBlock(permutationVariables, blockIdx, output, logger).Failed())
-            {
-              return Runtime::HYDRA_FAILURE;
-            }
-          }
-          else
+    return Runtime::HYDRA_SUCCESS;
+  }
+
+  template <typename EvaluateFunc>
+  Runtime::Result PermutableText::AppendPieces(const EvaluateFunc& evaluate, std::string& inout_text, Runtime::ILoggingInterface* logger) const
+  {
+    if (m_isMalformed)
+    {
+      Runtime::Log::Error(logger, "Permutable text structure is malformed.");
+      return Runtime::HYDRA_FAILURE;
+    }
+
+    size_t pieceIdx = 0;
+
+    while (pieceIdx < m_pieces.size())
+    {
+      const PermutableTextPiece& piece = m_pieces[pieceIdx];
+
+      switch (piece.m_type)
+      {
+        case PermutableTextPiece::Type::Unconditional:
+          inout_text += piece.m_text;
+          ++pieceIdx;
+          break;
+
+        case PermutableTextPiece::Type::If:
+        {
+          // jump from branch to branch, until one is taken or the #[else] or #[endif] is reached
+          while (m_pieces[pieceIdx].m_type == PermutableTextPiece::Type::If || m_pieces[pieceIdx].m_type == PermutableTextPiece::Type::Elif)
           {
-            ++blockIdx;
-            if (SkipBlock(blockIdx, logger).Failed())
+            int conditionValue = 0;
+            if (evaluate(pieceIdx, conditionValue).Failed())
             {
               return Runtime::HYDRA_FAILURE;
             }
+
+            if (conditionValue != 0)
+              break;
+
+            pieceIdx = m_pieces[pieceIdx].m_nextBranchIdx;
           }
 
+          // continue inside the branch, or after the #[endif]
+          ++pieceIdx;
           break;
         }
 
+        case PermutableTextPiece::Type::Elif:
+        case PermutableTextPiece::Type::Else:
+          // the end of the branch that was taken
+          pieceIdx = piece.m_endifIdx + 1;
+          break;
+
         case PermutableTextPiece::Type::Endif:
-        {
-          if (foundIf)
-          {
-            ++blockIdx;
-            foundIf = false;
-            foundTrueCondition = false;
-            break;
-          }
-          else
-          {
-            return Runtime::HYDRA_SUCCESS;
-          }
-        }
+          ++pieceIdx;
+          break;
       }
     }
 
-    if (foundIf)
+    return Runtime::HYDRA_SUCCESS;
+  }
+
+  std::optional<std::string> PermutableText::GenerateTextPermutation(const PermutationVariableValues& permutationVariables, Runtime::ILoggingInterface* logger) const
+  {
+    std::string result;
+    if (GenerateTextPermutation(permutationVariables, result, logger).Failed())
+    {
+      return {};
+    }
+
+    return result;
+  }
+
+  Runtime::Result PermutableText::GenerateTextPermutation(const PermutationVariableValues& permutationVariables, std::string& out_text, Runtime::ILoggingInterface* logger) const
+  {
+    HYDRA_PROFILE_SCOPE("GenerateTextPermutation");
+
+    out_text.clear();
+
+    Evaluator evaluator(logger);
+
+    auto evaluate = [&](size_t pieceIdx, int& out_value) -> Runtime::Result
     {
-      Runtime::Log::Error(logger, "Permutable text structure is not finished properly.");
+      const PermutableTextPiece& piece = m_pieces[pieceIdx];
+
+      if (piece.m_condition)
+      {
+        return piece.m_condition->Evaluate(permutationVariables, out_value, Evaluator::Mode::Strict, logger);
+      }
+
+      return evaluator.EvaluateCondition(piece.m_text, permutationVariables, out_value);
+    };
+
+    if (AppendPieces(evaluate, out_text, logger).Failed())
+    {
+      Runtime::Log::Error(logger, "Failed to generate text permutation.");
       return Runtime::HYDRA_FAILURE;
     }
 
     return Runtime::HYDRA_SUCCESS;
   }
 
-  Runtime::Result PermutableText::SkipBlock(size_t& blockIdx, Runtime::ILoggingInterface* logger) const
+  Runtime::Result PermutableText::BindConditions(ConditionVariableSlots& slots, std::vector<BoundCondition>& out_conditions, Runtime::ILoggingInterface* logger) const
   {
-    int32_t nesting = 0;
+    out_conditions.clear();
+    out_conditions.resize(m_pieces.size());
 
-    for (; blockIdx < m_pieces.size(); ++blockIdx)
+    for (size_t pieceIdx = 0; pieceIdx < m_pieces.size(); ++pieceIdx)
     {
-      const PermutableTextPiece& block = m_pieces[blockIdx];
+      const PermutableTextPiece& piece = m_pieces[pieceIdx];
+
+      if (piece.m_type != PermutableTextPiece::Type::If && piece.m_type != PermutableTextPiece::Type::Elif)
+        continue;
 
-      switch (block.m_type)
+      if (!piece.m_condition)
       {
-        case PermutableTextPiece::Type::If:
-          ++nesting;
-          break;
+        // compile again, to report the errors
+        CompiledCondition condition;
+        condition.Compile(piece.m_text, logger).IgnoreResult();
 
-        case PermutableTextPiece::Type::Endif:
+        Runtime::Log::Error(logger, "Failed to compile condition '%.*s'", static_cast<int>(piece.m_text.size()), piece.m_text.data());
+        return Runtime::HYDRA_FAILURE;
+      }
+
+      if (piece.m_condition->Bind(slots, out_conditions[pieceIdx], logger).Failed())
+      {
+        Runtime::Log::Error(logger, "Failed to bind condition '%.*s'", static_cast<int>(piece.m_text.size()), piece.m_text.data());
+        return Runtime::HYDRA_FAILURE;
+      }
+    }
+
+    return Runtime::HYDRA_SUCCESS;
+  }
+
+  Runtime::Result PermutableText::AppendTextPermutation(std::span<const BoundCondition> conditions, std::span<const int> slotValues, std::string& inout_text, Runtime::ILoggingInterface* logger) const
+  {
+    HYDRA_PROFILE_SCOPE("AppendTextPermutation");
+
+    if (conditions.size() != m_pieces.size())
+    {
+      Runtime::Log::Error(logger, "The bound conditions don't belong to this text.");
+      return Runtime::HYDRA_FAILURE;
+    }
+
+    auto evaluate = [&](size_t pieceIdx, int& out_value) -> Runtime::Result
+    {
+      return conditions[pieceIdx].Evaluate(slotValues, out_value, logger);
+    };
+
+    if (AppendPieces(evaluate, inout_text, logger).Failed())
+    {
+      Runtime::Log::Error(logger, "Failed to generate text permutation.");
+      return Runtime::HYDRA_FAILURE;
+    }
+
+    return Runtime::HYDRA_SUCCESS;
+  }
+
+  Runtime::Result PermutableText::PruneDecidedBranches(const PermutationVariableValues& knownValues, Runtime::ILoggingInterface* logger)
+  {
+    auto decide = [&](const PermutableTextPiece& piece, size_t, std::optional<int>& out_constantValue, std::shared_ptr<const CompiledCondition>& out_condition)
+    {
+      if (piece.m_type == PermutableTextPiece::Type::Else)
+      {
+        out_constantValue = 1;
+      }
+      else if (piece.m_condition)
+      {
+        auto foldedCondition = std::make_shared<CompiledCondition>(*piece.m_condition);
+        foldedCondition->PartiallyEvaluate(knownValues);
+        out_constantValue = foldedCondition->GetConstantValue();
+
+        if (foldedCondition->GetInstructions() == piece.m_condition->GetInstructions() && foldedCondition->GetVariableNames() == piece.m_condition->GetVariableNames())
+        {
+          // nothing was folded, keep sharing the condition
+          out_condition = piece.m_condition;
+        }
+        else if (m_conditionCache)
+        {
+          out_condition = m_conditionCache->GetCondition(std::move(foldedCondition));
+        }
+        else
+        {
+          out_condition = std::move(foldedCondition);
+        }
+      }
+      // conditions that don't compile are kept as they are, to report their errors during generation
+    };
+
+    return PrunePieces(decide, logger);
+  }
+
+  Runtime::Result PermutableText::PrunePieces(const DecideBranchFunc& decide, Runtime::ILoggingInterface* logger)
+  {
+    PieceList prunedPieces;
+    size_t pieceIdx = 0;
 
-          if (nesting == 0)
+    // a top-level block only ends early at an #[elif], #[else] or #[endif] without an #[if]
+    if (PruneBlock(m_pieces, pieceIdx, decide, prunedPieces).Failed() || pieceIdx < m_pieces.size())
+    {
+      Runtime::Log::Error(logger, "Permutable text structure is malformed.");
+      return Runtime::HYDRA_FAILURE;
+    }
+
+    m_pieces = std::move(prunedPieces);
+    return LinkBranches(logger);
+  }
+
+  Runtime::Result PermutableText::PruneBlock(const PieceList& pieces, size_t& pieceIdx, const DecideBranchFunc& decide, PieceList& out_pieces)
+  {
+    while (pieceIdx < pieces.size())
+    {
+      const PermutableTextPiece& piece = pieces[pieceIdx];
+
+      switch (piece.m_type)
+      {
+        case PermutableTextPiece::Type::Unconditional:
+          out_pieces.push_back(piece);
+          ++pieceIdx;
+          break;
+
+        case PermutableTextPiece::Type::If:
+          if (PruneBranches(pieces, pieceIdx, decide, out_pieces).Failed())
           {
-            return Runtime::HYDRA_SUCCESS;
+            return Runtime::HYDRA_FAILURE;
           }
-
-          --nesting;
           break;
 
-        case PermutableTextPiece::Type::Elif:
-        case PermutableTextPiece::Type::Else:
+        default:
+          // the end of the block, handled by the caller
+          return Runtime::HYDRA_SUCCESS;
+      }
+    }
+
+    return Runtime::HYDRA_SUCCESS;
+  }
+
+  Runtime::Result PermutableText::PruneBranches(const PieceList& pieces, size_t& pieceIdx, const DecideBranchFunc& decide, PieceList& out_pieces)
+  {
+    bool hasUndecidedBranch = false; // whether a branch with a residual condition was kept, which needs the #[endif]
+    bool isDecided = false;          // whether an earlier branch is known to be taken
+    PieceList droppedPieces;
+
+    while (pieceIdx < pieces.size())
+    {
+      const PermutableTextPiece& piece = pieces[pieceIdx];
+      const size_t branchIdx = pieceIdx;
+      ++pieceIdx;
+
+      if (piece.m_type == PermutableTextPiece::Type::Endif)
+      {
+        if (hasUndecidedBranch)
+        {
+          out_pieces.push_back(piece);
+        }
+
+        return Runtime::HYDRA_SUCCESS;
+      }
+
+      std::optional<int> constantValue;
+      std::shared_ptr<const CompiledCondition> condition;
+      decide(piece, branchIdx, constantValue, condition);
+
+      PieceList* target = &out_pieces;
+
+      if (isDecided || constantValue == 0)
+      {
+        target = &droppedPieces;
+      }
+      else if (constantValue.has_value())
+      {
+        isDecided = true;
+
+        if (hasUndecidedBranch)
+        {
+          PermutableTextPiece elsePiece;
+          elsePiece.m_type = PermutableTextPiece::Type::Else;
+          out_pieces.push_back(elsePiece);
+        }
+      }
+      else
+      {
+        PermutableTextPiece branch = piece;
+        branch.m_type = hasUndecidedBranch ? PermutableTextPiece::Type::Elif : PermutableTextPiece::Type::If;
+        branch.m_condition = std::move(condition);
+        out_pieces.push_back(branch);
+
+        hasUndecidedBranch = true;
+      }
+
+      if (PruneBlock(pieces, pieceIdx, decide, *target).Failed())
+      {
+        return Runtime::HYDRA_FAILURE;
+      }
+    }
+
+    // missing #[endif]
+    return Runtime::HYDRA_FAILURE;
+  }
+
+  Runtime::Result PermutableText::ClassifyBranches(BddManager& bdd, const Runtime::PermutationManager& manager, BddManager::Node validPermutations, std::vector<BranchLiveness>& out_liveness) const
+  {
+    out_liveness.assign(m_pieces.size(), BranchLiveness::Live);
+    size_t pieceIdx = 0;
+
+    if (ClassifyBlock(bdd, manager, pieceIdx, validPermutations, out_liveness).Failed() || pieceIdx < m_pieces.size())
+    {
+      return Runtime::HYDRA_FAILURE;
+    }
 
-          if (nesting == 0)
+    return Runtime::HYDRA_SUCCESS;
+  }
+
+  Runtime::Result PermutableText::ClassifyBlock(BddManager& bdd, const Runtime::PermutationManager& manager, size_t& pieceIdx, BddManager::Node reachingPermutations, std::vector<BranchLiveness>& inout_liveness) const
+  {
+    while (pieceIdx < m_pieces.size())
+    {
+      switch (m_pieces[pieceIdx].m_type)
+      {
+        case PermutableTextPiece::Type::Unconditional:
+          ++pieceIdx;
+          break;
+
+        case PermutableTextPiece::Type::If:
+          if (ClassifyIfBranches(bdd, manager, pieceIdx, reachingPermutations, inout_liveness).Failed())
           {
-            return Runtime::HYDRA_SUCCESS;
+            return Runtime::HYDRA_FAILURE;
           }
-
           break;
+
+        default:
+          // the end of the block, handled by the caller
+          return Runtime::HYDRA_SUCCESS;
       }
     }
 
-    if (nesting == 0)
+    return Runtime::HYDRA_SUCCESS;
+  }
+
+  Runtime::Result PermutableText::ClassifyIfBranches(BddManager& bdd, const Runtime::PermutationManager& manager, size_t& pieceIdx, BddManager::Node reachingPermutations, std::vector<BranchLiveness>& inout_liveness) const
+  {
+    // The permutations that reach the current branch, because no earlier branch was taken.
+    // Where a condition can't be converted, this keeps more permutations than necessary, which can only make branches look live.
+    BddManager::Node remainingPermutations = reachingPermutations;
+
+    while (pieceIdx < m_pieces.size())
     {
-      return Runtime::HYDRA_SUCCESS;
+      const PermutableTextPiece& piece = m_pieces[pieceIdx];
+      const size_t branchIdx = pieceIdx;
+      ++pieceIdx;
+
+      if (piece.m_type == PermutableTextPiece::Type::Endif)
+        return Runtime::HYDRA_SUCCESS;
+
+      BddManager::Node takenPermutations = remainingPermutations;
+      BddManager::Node condition = BddManager::TRUE_NODE;
+      bool isConverted = false;
+
+      // errors are reported when permutations are generated
+      if (piece.m_type != PermutableTextPiece::Type::Else && piece.m_condition && bdd.ConvertCondition(*piece.m_condition, manager, condition, nullptr).Succeeded())
+      {
+        takenPermutations = bdd.And(remainingPermutations, condition);
+        isConverted = true;
+      }
+
+      if (reachingPermutations == BddManager::FALSE_NODE)
+      {
+        inout_liveness[branchIdx] = BranchLiveness::Unreachable;
+      }
+      else if (takenPermutations == BddManager::FALSE_NODE)
+      {
+        inout_liveness[branchIdx] = BranchLiveness::NeverTaken;
+      }
+      else if (isConverted && takenPermutations == remainingPermutations)
+      {
+        inout_liveness[branchIdx] = BranchLiveness::AlwaysTaken;
+      }
+
+      if (ClassifyBlock(bdd, manager, pieceIdx, takenPermutations, inout_liveness).Failed())
+      {
+        return Runtime::HYDRA_FAILURE;
+      }
+
+      if (isConverted)
+      {
+        remainingPermutations = bdd.And(remainingPermutations, bdd.Not(condition));
+      }
     }
 
-    Runtime::Log::Error(logger, "Permutable text structure is malformed.");
+    // missing #[endif]
     return Runtime::HYDRA_FAILURE;
   }
 
-  std::optional<std::string> PermutableText::GenerateTextPermutation(const PermutationVariableValues& permutationVariables, Runtime::ILoggingInterface* logger) const
+  Runtime::Result PermutableText::RemoveDeadBranches(std::span<const BranchLiveness> liveness, Runtime::ILoggingInterface* logger)
   {
-    std::string result;
-    size_t blockIdx = 0;
+    if (liveness.size() != m_pieces.size())
+    {
+      Runtime::Log::Error(logger, "The branch classification doesn't match the text.");
+      return Runtime::HYDRA_FAILURE;
+    }
 
-    while (blockIdx < m_pieces.size())
+    auto decide = [&](const PermutableTextPiece& piece, size_t pieceIdx, std::optional<int>& out_constantValue, std::shared_ptr<const CompiledCondition>& out_condition)
     {
-      if (EnterBlock(permutationVariables, blockIdx, result, logger).Failed())
+      switch (liveness[pieceIdx])
       {
-        Runtime::Log::Error(logger, "Failed to generate text permutation.");
-        return {};
+        case BranchLiveness::NeverTaken:
+        case BranchLiveness::Unreachable:
+          out_constantValue = 0;
+          break;
+
+        case BranchLiveness::AlwaysTaken:
+          out_constantValue = 1;
+          break;
+
+        case BranchLiveness::Live:
+          if (piece.m_type == PermutableTextPiece::Type::Else)
+            out_constantValue = 1;
+          else
+            out_condition = piece.m_condition;
+          break;
       }
+    };
+
+    // the pieces are replaced, but their text stays in m_text
+    std::vector<std::pair<BranchLiveness, PermutableTextPiece>> decidedBranches;
+    for (size_t pieceIdx = 0; pieceIdx < liveness.size(); ++pieceIdx)
+    {
+      if (liveness[pieceIdx] == BranchLiveness::NeverTaken || liveness[pieceIdx] == BranchLiveness::AlwaysTaken)
+        decidedBranches.push_back({liveness[pieceIdx], m_pieces[pieceIdx]});
     }
 
-    return result;
+    if (PrunePieces(decide, logger).Failed())
+    {
+      return Runtime::HYDRA_FAILURE;
+    }
+
+    for (const auto& [branchLiveness, piece] : decidedBranches)
+    {
+      [[maybe_unused]] const int textLength = static_cast<int>(piece.m_text.size());
+
+      if (piece.m_type == PermutableTextPiece::Type::Else)
+      {
+        HYDRA_LOG_WARNING(logger, "An #[else] branch is never taken, its code is removed.");
+      }
+      else if (branchLiveness == BranchLiveness::NeverTaken)
+      {
+        HYDRA_LOG_WARNING(logger, "The condition '%.*s' is never true for the allowed values, its code is removed.", textLength, piece.m_text.data());
+      }
+      else
+      {
+        HYDRA_LOG_WARNING(logger, "The condition '%.*s' is always true where it is checked, its code is made unconditional.", textLength, piece.m_text.data());
+      }
+    }
+
+    return Runtime::HYDRA_SUCCESS;
   }
 
   Runtime::Result PermutableText::DetermineUsedPermutationVariables(std::vector<std::string>& foundVars, Runtime::ILoggingInterface* logger)
@@ -319,7 +716,15 @@ namespace Hydra::Tools
 
     for (const PermutableTextPiece& piece : m_pieces)
     {
-      if (piece.m_type == PermutableTextPiece::Type::If || piece.m_type == PermutableTextPiece::Type::Elif)
+      if (piece.m_condition)
+      {
+        // after PruneDecidedBranches() the compiled condition may read fewer variables than its text
+        for (const std::string& varName : piece.m_condition->GetVariableNames())
+        {
+          evaluatedVars.insert(varName);
+        }
+      }
+      else if (piece.m_type == PermutableTextPiece::Type::If || piece.m_type == PermutableTextPiece::Type::Elif)
       {
         int result = 0;
         if (evaluator.EvaluateCondition(piece.m_text, {}, result, Evaluator::Mode::Lenient, &evaluatedVars).Succeeded())
@@ -25,6 +25,12 @@ namespace Hydra::Tools
     m_fileLocator = locator;
   }
 
+  void PermutationShaderLibrary::SetPermutationManager(const Runtime::PermutationManager* manager)
+  {
+    std::scoped_lock<std::recursive_mutex> lk(m_mutex);
+    m_permutationManager = manager;
+  }
+
   const Hydra::Tools::PermutationShader* PermutationShaderLibrary::GetLoadedPermutationShader(std::string_view path) const
   {
     if (m_fileCache == nullptr || m_fileLocator == nullptr)
@@ -42,7 +48,7 @@ namespace Hydra::Tools
     if (!filePath.has_value())
     {
       // file not found -> not an error here
-      Runtime::Log::Info(m_logger, "PermutationShaderLibrary::GetLoadedPermutationShader: File '%s' does not exist.", finalPath.c_str());
+      HYDRA_LOG_INFO(m_logger, "PermutationShaderLibrary::GetLoadedPermutationShader: File '%s' does not exist.", finalPath.c_str());
       return nullptr;
     }
 
@@ -50,14 +56,14 @@ namespace Hydra::Tools
 
     std::scoped_lock<std::recursive_mutex> lk(m_mutex);
 
-    std::map<std::string, PermutationShader>::const_iterator it = m_loadedShaders.find(finalPath);
+    auto it = m_loadedShaders.find(finalPath);
 
     if (it != m_loadedShaders.end())
     {
       return &it->second;
     }
 
-    Runtime::Log::Info(m_logger, "PermutationShaderLibrary::GetLoadedPermutationShader: File '%s' has not been loaded before.", finalPath.c_str());
+    HYDRA_LOG_INFO(m_logger, "PermutationShaderLibrary::GetLoadedPermutationShader: File '%s' has not been loaded before.", finalPath.c_str());
     return nullptr;
   }
 
@@ -1,4 +1,7 @@
 #include <HydraRuntime/Logger.h>
+#include <HydraRuntime/PermutationManager.h>
+#include <HydraRuntime/Profiler.h>
+#include <HydraTools/BddManager.h>
 #include <HydraTools/FileCache.h>
 #include <HydraTools/FileLocator.h>
 #include <HydraTools/PermutationShaderLibrary.h>
@@ -6,6 +9,8 @@
 #include <HydraTools/TextSectionizer.h>
 #include <HydraTools/Tokenizer.h>
 
+#include <charconv>
+
 namespace Hydra::Tools
 {
   const char* ShaderFileSection::SectionNames[ShaderFileSection::MAX_SECTIONS] = {
@@ -171,8 +176,54 @@ namespace Hydra::Tools
     }
   }
 
-  Runtime::Result PermutationShaderLibrary::ParseShaderFile(PermutationShader& shader, const std::string& content)
+  void PermutationShaderLibrary::GetFixedVariableValues(const std::map<std::string, std::string>& allowedPermutations, PermutationVariableValues& out_values) const
+  {
+    out_values.clear();
+
+    for (const auto& iter : allowedPermutations)
+    {
+      if (iter.second.empty())
+        continue;
+
+      if (m_permutationManager == nullptr)
+      {
+        // without the variable types only unambiguous values can be used
+        if (iter.second == "true" || iter.second == "false")
+        {
+          out_values[iter.first] = (iter.second == "true") ? 1 : 0;
+        }
+        else if (iter.second.find_first_not_of("0123456789") == std::string::npos)
+        {
+          out_values[iter.first] = atoi(iter.second.c_str());
+        }
+
+        continue;
+      }
+
+      const Runtime::PermutationVariableEntry* variable = m_permutationManager->GetVariable(iter.first.c_str());
+      if (variable == nullptr)
+        continue;
+
+      if (std::optional<int> value = ParseFixedValue(*variable, iter.second))
+      {
+        out_values[iter.first] = value.value();
+
+        // conditions compare enum variables against their values
+        if (variable->m_type == Runtime::PermutationVariableEntry::Type::Enum)
+        {
+          for (const auto& allowedValue : variable->m_allowedValues)
+          {
+            out_values[iter.first + "::" + allowedValue.first] = allowedValue.second;
+          }
+        }
+      }
+    }
+  }
+
+  Runtime::Result PermutationShaderLibrary::ParseShaderFile(PermutationShader& shader, std::string_view content)
   {
+    HYDRA_PROFILE_SCOPE("ParseShaderFile");
+
     TextSectionizer sectionizer;
 
     // split the shader file into the expected sections
@@ -207,8 +258,12 @@ namespace Hydra::Tools
 
     // read all of the shader + user sections
     // replace #include statements
+    // remove the branches that the fixed values decide
     // figure out which permutation variables are used
     {
+      PermutationVariableValues fixedValues;
+      GetFixedVariableValues(shader.m_allowedVariablePermutations, fixedValues);
+
       // load the common shader text
       const std::string_view textCommon = sectionizer.GetSectionContent(2);
 
@@ -233,7 +288,16 @@ namespace Hydra::Tools
 
         alreadyIncluded.clear();
         fullSection = ReplaceHashIncludes(shader.m_normalizedPath, fullSection, alreadyIncluded, *m_fileLocator, *m_fileCache, m_logger);
-        shader.m_shaderSection[sectionIdx].SetText(std::move(fullSection));
+        if (shader.m_shaderSection[sectionIdx].SetText(std::move(fullSection), m_logger, &m_conditionCache).Failed())
+        {
+          Runtime::Log::Error(m_logger, "The shader section '%s' has a malformed #[if] structure.", ShaderFileSection::SectionNames[sectionIdx]);
+          return Runtime::HYDRA_FAILURE;
+        }
+
+        if (!fixedValues.empty() && shader.m_shaderSection[sectionIdx].PruneDecidedBranches(fixedValues, m_logger).Failed())
+        {
+          return Runtime::HYDRA_FAILURE;
+        }
 
         // keep track of all the files that were #include'd
         for (const auto& file : alreadyIncluded)
@@ -254,6 +318,8 @@ namespace Hydra::Tools
 
   const Hydra::Tools::PermutationShader* PermutationShaderLibrary::LoadPermutationShader(std::string_view path)
   {
+    HYDRA_PROFILE_SCOPE("LoadPermutationShader");
+
     if (m_fileCache == nullptr || m_fileLocator == nullptr)
     {
       Runtime::Log::Error(m_logger, "PermutationShaderLibrary: FileCache and FileLocator are not set up.");
@@ -269,7 +335,7 @@ namespace Hydra::Tools
     if (!filePath.has_value())
     {
       // file not found -> not an error here
-      Runtime::Log::Info(m_logger, "LoadPermutationShader: File '%s' does not exist.", finalPath.c_str());
+      HYDRA_LOG_INFO(m_logger, "LoadPermutationShader: File '%s' does not exist.", finalPath.c_str());
       return nullptr;
     }
 
@@ -277,16 +343,16 @@ namespace Hydra::Tools
 
     std::scoped_lock<std::recursive_mutex> lk(m_mutex);
 
-    std::map<std::string, PermutationShader>::const_iterator it = m_loadedShaders.find(finalPath);
+    auto it = m_loadedShaders.find(finalPath);
 
     if (it != m_loadedShaders.end())
     {
-      Runtime::Log::Info(m_logger, "Permutation shader '%s' already loaded.", finalPath.c_str());
+      HYDRA_LOG_INFO(m_logger, "Permutation shader '%s' already loaded.", finalPath.c_str());
       return &it->second;
     }
 
     {
-      Runtime::Log::Info(m_logger, "Loading permutation shader '%s'", finalPath.c_str());
+      HYDRA_LOG_INFO(m_logger, "Loading permutation shader '%s'", finalPath.c_str());
 
       PermutationShader& shader = m_loadedShaders[finalPath];
       shader.m_normalizedPath = finalPath;
@@ -307,7 +373,7 @@ namespace Hydra::Tools
         return nullptr;
       }
 
-      Runtime::Log::Info(m_logger, "Successfully loaded permutation shader '%s'", finalPath.c_str());
+      HYDRA_LOG_INFO(m_logger, "Successfully loaded permutation shader '%s'", finalPath.c_str());
       return &shader;
     }
   }
@@ -317,12 +383,17 @@ namespace Hydra::Tools
     // since imports are loaded the same way, they are already validated, and we don't need to validate the full chain here
 
     // TODO: check that imports have no cycles
-    // TODO: check that fixed values are in range / type
-    // TODO: check that used enum values are valid
     // TODO: check that all used vars are registered
 
     Runtime::Result res = Runtime::HYDRA_SUCCESS;
 
+    // fixed values and enum values can only be checked against the registered variables
+    // remove the branches that can't be taken first, so that the variables they use don't count as used
+    if (m_permutationManager != nullptr && RemoveDeadBranches(shader).Failed())
+    {
+      res = Runtime::HYDRA_FAILURE;
+    }
+
     std::set<std::string> usedVariables;
     GetAllUsedPermutationVariables(shader, usedVariables);
 
@@ -333,9 +404,23 @@ namespace Hydra::Tools
 
       for (const std::string& usedVar : usedVariables)
       {
-        if (usedVar.find("::") != std::string::npos)
+        if (const size_t separator = usedVar.find("::"); separator != std::string::npos)
         {
-          // TODO: validate enum values better
+          if (m_permutationManager != nullptr)
+          {
+            const Runtime::PermutationVariableEntry* variable = m_permutationManager->GetVariable(usedVar.substr(0, separator).c_str());
+            const std::string_view valueName = std::string_view(usedVar).substr(separator + 2);
+
+            if (variable != nullptr && variable->m_type == Runtime::PermutationVariableEntry::Type::Enum &&
+                std::none_of(variable->m_allowedValues.begin(), variable->m_allowedValues.end(), [&](const auto& value)
+                  { return value.first == valueName; }))
+            {
+              res = Runtime::HYDRA_FAILURE;
+
+              Runtime::Log::Error(m_logger, "Shader uses '%s', but '%.*s' is not a value of the enum variable '%s'.", usedVar.c_str(), static_cast<int>(valueName.size()), valueName.data(), variable->m_name.c_str());
+            }
+          }
+
           continue;
         }
 
@@ -346,21 +431,36 @@ namespace Hydra::Tools
           Runtime::Log::Error(m_logger, "Shader uses permutation variable '%s' that isn't declared in its [PERMUTATIONS] section.", usedVar.c_str());
         }
       }
-
-      return res;
     }
 
     // check that declared variables only restrict their values, compared to imported shaders
+    // imports are simplified with their own fixed values, so these have to hold for every shader that imports them
     {
       std::map<std::string, std::string> allowedValues;
-      GetAllowedVariablePermutations(shader, allowedValues);
 
       for (const std::string& dependency : shader.m_imports)
       {
         const PermutationShader* subShader = GetLoadedPermutationShader(dependency);
         assert(subShader != nullptr);
 
-        GetAllowedVariablePermutations(*subShader, allowedValues);
+        std::map<std::string, std::string> importAllowedValues;
+        GetAllowedVariablePermutations(*subShader, importAllowedValues);
+
+        for (const auto& iter : importAllowedValues)
+        {
+          // keep the most restrictive value
+          std::string& value = allowedValues[iter.first];
+          if (value.empty())
+          {
+            value = iter.second;
+          }
+          else if (!iter.second.empty() && value != iter.second)
+          {
+            res = Runtime::HYDRA_FAILURE;
+
+            Runtime::Log::Error(m_logger, "Imported shaders use conflicting fixed values for '%s': '%s' != '%s'", iter.first.c_str(), value.c_str(), iter.second.c_str());
+          }
+        }
       }
 
       for (const auto iterNew : shader.m_allowedVariablePermutations)
@@ -395,4 +495,84 @@ namespace Hydra::Tools
     return res;
   }
 
+  Runtime::Result PermutationShaderLibrary::RemoveDeadBranches(PermutationShader& shader) const
+  {
+    std::map<std::string, std::string> allowedValues;
+    GetAllowedVariablePermutations(shader, allowedValues);
+
+    BddManager bdd;
+
+    // every permutation of the allowed values, with the fixed values applied
+    BddManager::Node validPermutations = BddManager::TRUE_NODE;
+
+    for (const auto& iter : allowedValues)
+    {
+      const Runtime::PermutationVariableEntry* variable = m_permutationManager->GetVariable(iter.first.c_str());
+      if (variable == nullptr)
+        continue;
+
+      if (iter.second.empty())
+      {
+        validPermutations = bdd.And(validPermutations, bdd.GetDomainConstraint(*variable));
+        continue;
+      }
+
+      // ParseFixedValue() is lenient, only accept values that are spelled out exactly
+      bool isWellFormed = true;
+      if (variable->m_type == Runtime::PermutationVariableEntry::Type::Bool)
+      {
+        isWellFormed = (iter.second == "true" || iter.second == "false");
+      }
+      else if (variable->m_type == Runtime::PermutationVariableEntry::Type::Int)
+      {
+        int parsedValue = 0;
+        const char* end = iter.second.data() + iter.second.size();
+        const std::from_chars_result result = std::from_chars(iter.second.data(), end, parsedValue);
+        isWellFormed = (result.ec == std::errc() && result.ptr == end);
+      }
+
+      const std::optional<int> value = ParseFixedValue(*variable, iter.second);
+      uint32_t encodedValue = 0;
+
+      if (!isWellFormed || !value.has_value() || variable->GetEncodedValue(value.value(), encodedValue).Failed())
+      {
+        Runtime::Log::Error(m_logger, "The fixed value '%s' of permutation variable '%s' is not one of its allowed values.", iter.second.c_str(), iter.first.c_str());
+        return Runtime::HYDRA_FAILURE;
+      }
+
+      validPermutations = bdd.And(validPermutations, bdd.GetValueCondition(*variable, encodedValue));
+    }
+
+    shader.m_usedPermutationVariables.clear();
+
+    for (uint32_t sectionIdx = 0; sectionIdx < ShaderFileSection::MAX_SECTIONS; ++sectionIdx)
+    {
+      PermutableText& text = shader.m_shaderSection[sectionIdx];
+
+      // malformed #[if] structures were already reported during parsing
+      std::vector<BranchLiveness> liveness;
+      if (text.ClassifyBranches(bdd, *m_permutationManager, validPermutations, liveness).Succeeded())
+      {
+        if (std::any_of(liveness.begin(), liveness.end(), [](BranchLiveness value)
+              { return value == BranchLiveness::NeverTaken || value == BranchLiveness::AlwaysTaken; }))
+        {
+          HYDRA_LOG_WARNING(m_logger, "The shader section '%s' of '%s' has branches that are decided by the allowed values.", ShaderFileSection::SectionNames[sectionIdx], shader.m_normalizedPath.c_str());
+        }
+
+        if (text.RemoveDeadBranches(liveness, m_logger).Failed())
+        {
+          return Runtime::HYDRA_FAILURE;
+        }
+      }
+
+      if (text.DetermineUsedPermutationVariables(shader.m_usedPermutationVariables, m_logger).Failed())
+      {
+        Runtime::Log::Error(m_logger, "The shader section '%s' has an erroneous permutation condition.", ShaderFileSection::SectionNames[sectionIdx]);
+        return Runtime::HYDRA_FAILURE;
+      }
+    }
+
+    return Runtime::HYDRA_SUCCESS;
+  }
+
 } // namespace Hydra::Tools
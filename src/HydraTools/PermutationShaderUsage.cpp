@@ -1,5 +1,6 @@
 #include <HydraRuntime/Logger.h>
 #include <HydraRuntime/PermutationManager.h>
+#include <HydraRuntime/Profiler.h>
 #include <HydraTools/PermutationShaderLibrary.h>
 #include <assert.h>
 
@@ -84,6 +85,100 @@ namespace Hydra::Tools
     return result;
   }
 
+  Runtime::Result PermutationShaderLibrary::BindPermutationShader(const PermutationShader& shader, const Runtime::PermutationManager& manager, BoundPermutationShader& out_bound) const
+  {
+    out_bound = BoundPermutationShader();
+    out_bound.m_shader = &shader;
+    out_bound.m_slots = ConditionVariableSlots(&manager);
+
+    if (BindShaderTexts(shader, out_bound).Failed())
+    {
+      Runtime::Log::Error(m_logger, "Failed to bind permutation shader '%s'", shader.m_normalizedPath.c_str());
+      out_bound = BoundPermutationShader();
+      return Runtime::HYDRA_FAILURE;
+    }
+
+    // like SetupVariableValuesWithFixedValues(), only the top-level [PERMUTATIONS] section is considered
+    out_bound.m_fixedSlotValues.resize(out_bound.m_slots.GetNumSlots());
+
+    for (const auto& iter : shader.m_allowedVariablePermutations)
+    {
+      if (iter.second.empty())
+        continue;
+
+      if (std::optional<uint32_t> slot = out_bound.m_slots.FindSlot(iter.first))
+      {
+        out_bound.m_fixedSlotValues[slot.value()] = ParseFixedValue(*out_bound.m_slots.GetSlotVariable(slot.value()), iter.second);
+      }
+    }
+
+    return Runtime::HYDRA_SUCCESS;
+  }
+
+  Runtime::Result PermutationShaderLibrary::BindShaderTexts(const PermutationShader& shader, BoundPermutationShader& bound) const
+  {
+    for (const std::string& importedShader : shader.m_imports)
+    {
+      const PermutationShader* subShader = GetLoadedPermutationShader(importedShader);
+      assert(subShader != nullptr);
+
+      if (BindShaderTexts(*subShader, bound).Failed())
+      {
+        Runtime::Log::Error(m_logger, "Failed to bind import '%s'", subShader->m_normalizedPath.c_str());
+        return Runtime::HYDRA_FAILURE;
+      }
+    }
+
+    for (uint32_t section = 0; section < ShaderFileSection::MAX_SECTIONS; ++section)
+    {
+      BoundPermutationShader::BoundText& boundText = bound.m_sectionTexts[section].emplace_back();
+      boundText.m_text = &shader.m_shaderSection[section];
+
+      if (boundText.m_text->BindConditions(bound.m_slots, boundText.m_conditions, m_logger).Failed())
+      {
+        Runtime::Log::Error(m_logger, "Failed to bind section %s of '%s'", ShaderFileSection::SectionNames[section], shader.m_normalizedPath.c_str());
+        return Runtime::HYDRA_FAILURE;
+      }
+    }
+
+    return Runtime::HYDRA_SUCCESS;
+  }
+
+  Runtime::Result PermutationShaderLibrary::GeneratePermutedShaderCode(const BoundPermutationShader& shader, ShaderFileSection::Enum stage, const Runtime::PermutationVariableSelection& selection, std::string& out_code) const
+  {
+    HYDRA_PROFILE_SCOPE("GeneratePermutedShaderCode");
+
+    out_code.clear();
+
+    // reused across calls, so that generating permutations doesn't allocate anything apart from the code itself
+    thread_local std::vector<int> slotValues;
+    slotValues.resize(shader.m_slots.GetNumSlots());
+
+    for (uint32_t slot = 0; slot < shader.m_slots.GetNumSlots(); ++slot)
+    {
+      if (shader.m_fixedSlotValues[slot].has_value())
+      {
+        slotValues[slot] = shader.m_fixedSlotValues[slot].value();
+      }
+      else if (!selection.GetVariableValue(*shader.m_slots.GetSlotVariable(slot), slotValues[slot]))
+      {
+        Runtime::Log::Error(m_logger, "Permutation variable '%s' has no value in the selection. Shader = '%s'", shader.m_slots.GetSlotName(slot).c_str(), shader.m_shader->m_normalizedPath.c_str());
+        return Runtime::HYDRA_FAILURE;
+      }
+    }
+
+    for (const BoundPermutationShader::BoundText& text : shader.m_sectionTexts[stage])
+    {
+      if (text.m_text->AppendTextPermutation(text.m_conditions, slotValues, out_code, m_logger).Failed())
+      {
+        Runtime::Log::Error(m_logger, "Failed to generate text permutation for '%s'", shader.m_shader->m_normalizedPath.c_str());
+        return Runtime::HYDRA_FAILURE;
+      }
+    }
+
+    return Runtime::HYDRA_SUCCESS;
+  }
+
   Hydra::Runtime::PermutationVariableSet PermutationShaderLibrary::CreatePermutationVariableSet(const PermutationShader& shader, const Runtime::PermutationManager& permutationManager)
   {
     std::map<std::string, std::string> allowedVarValues;
@@ -180,6 +275,34 @@ namespace Hydra::Tools
     return Runtime::HYDRA_SUCCESS;
   }
 
+  // static
+  std::optional<int> PermutationShaderLibrary::ParseFixedValue(const Runtime::PermutationVariableEntry& variable, const std::string& value)
+  {
+    // unknown enum values yield no value
+
+    switch (variable.m_type)
+    {
+      case Runtime::PermutationVariableEntry::Type::Bool:
+        return value == "true" ? 1 : 0;
+
+      case Runtime::PermutationVariableEntry::Type::Int:
+        return atoi(value.c_str());
+
+      case Runtime::PermutationVariableEntry::Type::Enum:
+        for (const auto& allowedValue : variable.m_allowedValues)
+        {
+          if (allowedValue.first == value)
+            return allowedValue.second;
+        }
+        break;
+
+      default:
+        break;
+    }
+
+    return std::nullopt;
+  }
+
   Runtime::Result PermutationShaderLibrary::SetupVariableValuesWithFixedValues(PermutationVariableValues& variables, const PermutationShader& shader, const Runtime::PermutationManager& manager, const std::map<std::string, std::string>& allowedValues)
   {
     for (const auto iter : allowedValues)
@@ -195,27 +318,9 @@ namespace Hydra::Tools
         return Runtime::HYDRA_FAILURE;
       }
 
-      if (permVar->m_type == Runtime::PermutationVariableEntry::Type::Bool)
-      {
-        if (iter.second == "true")
-          variables[iter.first] = 1;
-        else
-          variables[iter.first] = 0;
-      }
-      else if (permVar->m_type == Runtime::PermutationVariableEntry::Type::Int)
+      if (std::optional<int> value = ParseFixedValue(*permVar, iter.second))
       {
-        variables[iter.first] = atoi(iter.second.c_str());
-      }
-      else if (permVar->m_type == Runtime::PermutationVariableEntry::Type::Enum)
-      {
-        for (const auto& value : permVar->m_allowedValues)
-        {
-          if (value.first == iter.second)
-          {
-            variables[iter.first] = value.second;
-            break;
-          }
-        }
+        variables[iter.first] = value.value();
       }
     }
 
@@ -270,7 +270,7 @@ namespace Hydra::Tools
       return HYDRA_FAILURE;
     }
 
-    std::string contentString = m_fileCache->GetFileContent(*filePath);
+    std::string contentString(m_fileCache->GetFileContent(*filePath));
 
     using json = nlohmann::json;
     json content = json::parse(contentString, nullptr, false, ignoreComments);
@@ -312,7 +312,7 @@ namespace Hydra::Tools
 
     if (returnValue.Succeeded())
     {
-      Runtime::Log::Info(m_logger, "Successfully registered permutation variables from '%s'", finalPath.c_str());
+      HYDRA_LOG_INFO(m_logger, "Successfully registered permutation variables from '%s'", finalPath.c_str());
     }
     else
     {
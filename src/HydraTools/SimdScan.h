@@ -0,0 +1,160 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <string_view>
+
+// The vector width is selected at build time, based on the instruction sets the compiler is allowed to use.
+// Enable HYDRA_ENABLE_AVX2 in CMake (or pass the respective compiler flags) to get the 32 byte wide code paths.
+#if defined(__AVX2__)
+#  define HYDRA_SIMD_AVX2 1
+#  include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define HYDRA_SIMD_SSE2 1
+#  include <emmintrin.h>
+#endif
+
+namespace Hydra::Tools::Simd
+{
+#if defined(HYDRA_SIMD_AVX2)
+
+  using Vector = __m256i;
+  constexpr size_t VECTOR_SIZE = 32;
+
+  inline Vector Load(const char* data) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)); }
+  inline Vector Equal(Vector v, char c) { return _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c)); }
+  inline Vector Or(Vector a, Vector b) { return _mm256_or_si256(a, b); }
+  inline Vector InRange(Vector v, char lo, char hi) { return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(lo - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8(hi + 1), v)); }
+  inline uint32_t MoveMask(Vector v) { return static_cast<uint32_t>(_mm256_movemask_epi8(v)); }
+
+#elif defined(HYDRA_SIMD_SSE2)
+
+  using Vector = __m128i;
+  constexpr size_t VECTOR_SIZE = 16;
+
+  inline Vector Load(const char* data) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)); }
+  inline Vector Equal(Vector v, char c) { return _mm_cmpeq_epi8(v, _mm_set1_epi8(c)); }
+  inline Vector Or(Vector a, Vector b) { return _mm_or_si128(a, b); }
+  inline Vector InRange(Vector v, char lo, char hi) { return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1)), _mm_cmpgt_epi8(_mm_set1_epi8(hi + 1), v)); }
+  inline uint32_t MoveMask(Vector v) { return static_cast<uint32_t>(_mm_movemask_epi8(v)); }
+
+#endif
+
+  /// Full mask for the bits returned by MoveMask()
+#if defined(HYDRA_SIMD_AVX2) || defined(HYDRA_SIMD_SSE2)
+  constexpr uint32_t FULL_MASK = VECTOR_SIZE == 32 ? 0xFFFFFFFFu : 0xFFFFu;
+#endif
+
+  /// Returns the position of the '*' of the first "*/" at or after 'pos', or text.size() if there is none.
+  inline size_t FindBlockCommentEnd(std::string_view text, size_t pos)
+  {
+    const char* data = text.data();
+    const size_t size = text.size();
+
+#if defined(HYDRA_SIMD_AVX2) || defined(HYDRA_SIMD_SSE2)
+    // Compare two overlapping loads, so that a terminator crossing the vector boundary is found as well
+    while (pos + VECTOR_SIZE + 1 <= size)
+    {
+      const uint32_t mask = MoveMask(Equal(Load(data + pos), '*')) & MoveMask(Equal(Load(data + pos + 1), '/'));
+      if (mask != 0)
+        return pos + std::countr_zero(mask);
+
+      pos += VECTOR_SIZE;
+    }
+#endif
+
+    while (pos + 1 < size)
+    {
+      if (data[pos] == '*' && data[pos + 1] == '/')
+        return pos;
+
+      ++pos;
+    }
+
+    return size;
+  }
+
+  /// Returns the position of the first '\n' or '\r' at or after 'pos', or text.size() if there is none.
+  inline size_t FindLineEnd(std::string_view text, size_t pos)
+  {
+    const char* data = text.data();
+    const size_t size = text.size();
+
+#if defined(HYDRA_SIMD_AVX2) || defined(HYDRA_SIMD_SSE2)
+    while (pos + VECTOR_SIZE <= size)
+    {
+      const Vector v = Load(data + pos);
+      const uint32_t mask = MoveMask(Or(Equal(v, '\n'), Equal(v, '\r')));
+      if (mask != 0)
+        return pos + std::countr_zero(mask);
+
+      pos += VECTOR_SIZE;
+    }
+#endif
+
+    while (pos < size && data[pos] != '\n' && data[pos] != '\r')
+      ++pos;
+
+    return pos;
+  }
+
+  /// Returns the position of the first character at or after 'pos' that isn't part of an identifier ([a-zA-Z0-9_]), or text.size().
+  inline size_t SkipIdentifierChars(std::string_view text, size_t pos)
+  {
+    const char* data = text.data();
+    const size_t size = text.size();
+
+#if defined(HYDRA_SIMD_AVX2) || defined(HYDRA_SIMD_SSE2)
+    while (pos + VECTOR_SIZE <= size)
+    {
+      const Vector v = Load(data + pos);
+      const Vector isDigit = InRange(v, '0', '9');
+      const Vector isLower = InRange(v, 'a', 'z');
+      const Vector isUpper = InRange(v, 'A', 'Z');
+      const Vector isUnderscore = Equal(v, '_');
+      const uint32_t mask = ~MoveMask(Or(Or(isDigit, isUnderscore), Or(isLower, isUpper))) & FULL_MASK;
+      if (mask != 0)
+        return pos + std::countr_zero(mask);
+
+      pos += VECTOR_SIZE;
+    }
+#endif
+
+    while (pos < size)
+    {
+      const char c = data[pos];
+      const bool isIdentifierChar = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+      if (!isIdentifierChar)
+        break;
+
+      ++pos;
+    }
+
+    return pos;
+  }
+
+  /// Returns the position of the first character at or after 'pos' that is neither a space nor a tab, or text.size().
+  inline size_t SkipSpacesAndTabs(std::string_view text, size_t pos)
+  {
+    const char* data = text.data();
+    const size_t size = text.size();
+
+#if defined(HYDRA_SIMD_AVX2) || defined(HYDRA_SIMD_SSE2)
+    while (pos + VECTOR_SIZE <= size)
+    {
+      const Vector v = Load(data + pos);
+      const uint32_t mask = ~MoveMask(Or(Equal(v, ' '), Equal(v, '\t'))) & FULL_MASK;
+      if (mask != 0)
+        return pos + std::countr_zero(mask);
+
+      pos += VECTOR_SIZE;
+    }
+#endif
+
+    while (pos < size && (data[pos] == ' ' || data[pos] == '\t'))
+      ++pos;
+
+    return pos;
+  }
+
+} // namespace Hydra::Tools::Simd
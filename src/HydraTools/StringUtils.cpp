@@ -1,4 +1,5 @@
 #include <HydraRuntime/Logger.h>
+#include <HydraRuntime/Profiler.h>
 #include <HydraTools/FileCache.h>
 #include <HydraTools/FileLocator.h>
 #include <HydraTools/StringUtils.h>
@@ -71,6 +72,8 @@ namespace Hydra::Tools
 
   std::string ReplaceHashIncludes(std::string_view parentPath, std::string_view original, std::set<std::string>& alreadyIncluded, const FileLocator& fileLocator, FileCache& fileCache, Runtime::ILoggingInterface* logger)
   {
+    HYDRA_PROFILE_SCOPE("ReplaceHashIncludes");
+
     std::string result;
 
     while (!original.empty())
@@ -97,7 +100,7 @@ namespace Hydra::Tools
             {
               alreadyIncluded.insert(targetFile.value());
 
-              const std::string& targetFileContent = fileCache.GetFileContent(targetFile.value());
+              const std::string_view targetFileContent = fileCache.GetFileContent(targetFile.value());
 
               // recursively replace #includes in the dependent files
               result += ReplaceHashIncludes(targetFile.value(), targetFileContent, alreadyIncluded, fileLocator, fileCache, logger);
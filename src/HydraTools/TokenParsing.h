@@ -0,0 +1,109 @@
+#pragma once
+
+#include <HydraRuntime/Logger.h>
+#include <HydraRuntime/Result.h>
+#include <HydraTools/Tokenizer.h>
+
+#include <assert.h>
+#include <charconv>
+#include <string>
+
+// Helpers for the recursive descent parsers of the Evaluator and the condition compiler, so that both accept the same syntax and report the same errors.
+
+namespace Hydra::Tools
+{
+  inline void SkipComments(const TokenStream& input, uint32_t& currentToken)
+  {
+    while (currentToken < input.size() &&
+           (input[currentToken].m_type == Token::Type::LineComment || input[currentToken].m_type == Token::Type::BlockComment))
+    {
+      ++currentToken;
+    }
+  }
+
+  inline bool Accept(const TokenStream& input, uint32_t& currentToken, Token::Operator op)
+  {
+    SkipComments(input, currentToken);
+
+    if (currentToken >= input.size())
+      return false;
+
+    if (input[currentToken].m_operator == op)
+    {
+      ++currentToken;
+      return true;
+    }
+
+    return false;
+  }
+
+  inline bool Accept(const TokenStream& input, uint32_t& currentToken, Token::Type tokenType, uint32_t* pAccepted)
+  {
+    SkipComments(input, currentToken);
+
+    if (currentToken >= input.size())
+      return false;
+
+    if (input[currentToken].m_type == tokenType)
+    {
+      if (pAccepted)
+        *pAccepted = currentToken;
+
+      ++currentToken;
+      return true;
+    }
+
+    return false;
+  }
+
+  /// Returns the text of the current token (or the last one, at the end of the input) for error messages.
+  inline std::string GetErrorTokenText(const TokenStream& input, uint32_t currentToken)
+  {
+    return std::string(input[std::min<size_t>(currentToken, input.size() - 1)].m_token);
+  }
+
+  inline Runtime::Result Expect(const TokenStream& input, uint32_t& currentToken, Token::Operator op, const char* opString, Runtime::ILoggingInterface* logger)
+  {
+    if (Accept(input, currentToken, op))
+      return Runtime::HYDRA_SUCCESS;
+
+    Runtime::Log::Error(logger, "Evaluator expected token '%s' instead of '%s'", opString, GetErrorTokenText(input, currentToken).c_str());
+
+    return Runtime::HYDRA_FAILURE;
+  }
+
+  inline Runtime::Result ExpectEndOfLineOrInput(const TokenStream& input, uint32_t& currentToken, Runtime::ILoggingInterface* logger)
+  {
+    SkipComments(input, currentToken);
+
+    if (currentToken >= input.size())
+      return Runtime::HYDRA_SUCCESS;
+
+    if (Accept(input, currentToken, Token::Type::NewLine, nullptr))
+      return Runtime::HYDRA_SUCCESS;
+
+    Runtime::Log::Error(logger,
+      "Evaluator expected end-of-line token or end of input instead of token '%s'",
+      GetErrorTokenText(input, currentToken).c_str());
+
+    return Runtime::HYDRA_FAILURE;
+  }
+
+  /// Returns the value of an Integer token (decimal or hex).
+  inline int ParseIntegerToken(std::string_view token)
+  {
+    int value = 0;
+    if (token.starts_with("0x") || token.starts_with("0X"))
+    {
+      [[maybe_unused]] auto ret = std::from_chars(token.data() + 2, token.data() + token.size(), value, 16);
+      assert(ret.ec != std::errc::invalid_argument);
+    }
+    else
+    {
+      [[maybe_unused]] auto ret = std::from_chars(token.data(), token.data() + token.size(), value);
+      assert(ret.ec != std::errc::invalid_argument);
+    }
+
+    return value;
+  }
+} // namespace Hydra::Tools
@@ -1,28 +1,170 @@
 #include <HydraTools/Tokenizer.h>
 
 #include <HydraRuntime/HydraRuntime.h>
+#include <HydraTools/SimdScan.h>
+
+#include <array>
 
 namespace
 {
-  bool isIdentifierDelimiter(char curChar)
+  enum CharClass : uint8_t
+  {
+    CC_DIGIT = 1 << 0,      // 0-9
+    CC_LETTER = 1 << 1,     // a-z, A-Z and _
+    CC_HEX_DIGIT = 1 << 2,  // 0-9, a-f, A-F
+    CC_WHITESPACE = 1 << 3, // space and tab, but not newlines
+    CC_IDENTIFIER = CC_DIGIT | CC_LETTER,
+  };
+
+  constexpr std::array<uint8_t, 256> CreateCharClassTable()
   {
-    if ((curChar >= 'a') && (curChar <= 'z'))
-      return false;
-    if ((curChar >= 'A') && (curChar <= 'Z'))
-      return false;
-    if ((curChar >= '0') && (curChar <= '9'))
-      return false;
-    if (curChar == '_')
-      return false;
-
-    return true;
+    std::array<uint8_t, 256> table = {};
+
+    for (int c = '0'; c <= '9'; ++c)
+      table[c] |= CC_DIGIT | CC_HEX_DIGIT;
+
+    for (int c = 'a'; c <= 'z'; ++c)
+      table[c] |= CC_LETTER;
+
+    for (int c = 'A'; c <= 'Z'; ++c)
+      table[c] |= CC_LETTER;
+
+    for (int c = 'a'; c <= 'f'; ++c)
+      table[c] |= CC_HEX_DIGIT;
+
+    for (int c = 'A'; c <= 'F'; ++c)
+      table[c] |= CC_HEX_DIGIT;
+
+    table['_'] |= CC_LETTER;
+    table[' '] |= CC_WHITESPACE;
+    table['\t'] |= CC_WHITESPACE;
+
+    return table;
+  }
+
+  // Unlike std::isdigit etc. this doesn't depend on the locale and is well-defined for all chars
+  constexpr std::array<uint8_t, 256> s_charClasses = CreateCharClassTable();
+
+  inline bool hasCharClass(char curChar, uint8_t charClass)
+  {
+    return (s_charClasses[static_cast<uint8_t>(curChar)] & charClass) != 0;
+  }
+
+  /// Returns the position of the first character at or after 'pos' that doesn't have the given class.
+  inline uint32_t skipCharClass(std::string_view input, uint32_t pos, uint8_t charClass)
+  {
+    const char* data = input.data();
+    const uint32_t size = static_cast<uint32_t>(input.size());
+
+    while (pos < size && hasCharClass(data[pos], charClass))
+      ++pos;
+
+    return pos;
+  }
+
+  /// Returns the operator starting at 'pos', and how many characters it spans.
+  inline Hydra::Tools::Token::Operator classifyOperator(std::string_view input, uint32_t pos, uint32_t& length_out)
+  {
+    using Operator = Hydra::Tools::Token::Operator;
+
+    const char curChar = input[pos];
+    const char nextChar = pos + 1 < input.size() ? input[pos + 1] : '\0';
+
+    length_out = 2;
+    switch (curChar)
+    {
+      case '=':
+        if (nextChar == '=')
+          return Operator::Equal;
+        break;
+      case '!':
+        if (nextChar == '=')
+          return Operator::NotEqual;
+        break;
+      case '<':
+        if (nextChar == '=')
+          return Operator::LessEqual;
+        if (nextChar == '<')
+          return Operator::ShiftLeft;
+        break;
+      case '>':
+        if (nextChar == '=')
+          return Operator::GreaterEqual;
+        if (nextChar == '>')
+          return Operator::ShiftRight;
+        break;
+      case '&':
+        if (nextChar == '&')
+          return Operator::LogicalAnd;
+        break;
+      case '|':
+        if (nextChar == '|')
+          return Operator::LogicalOr;
+        break;
+    }
+
+    length_out = 1;
+    switch (curChar)
+    {
+      case '+':
+        return Operator::Plus;
+      case '-':
+        return Operator::Minus;
+      case '*':
+        return Operator::Multiply;
+      case '/':
+        return Operator::Divide;
+      case '%':
+        return Operator::Modulo;
+      case '~':
+        return Operator::BitNot;
+      case '&':
+        return Operator::BitAnd;
+      case '|':
+        return Operator::BitOr;
+      case '^':
+        return Operator::BitXor;
+      case '!':
+        return Operator::LogicalNot;
+      case '<':
+        return Operator::Less;
+      case '>':
+        return Operator::Greater;
+      case '=':
+        return Operator::Assign;
+      case '(':
+        return Operator::OpenParenthesis;
+      case ')':
+        return Operator::CloseParenthesis;
+    }
+
+    return Operator::None;
+  }
+
+  /// Variant of skipCharClass() for runs that may get long. Most identifiers and whitespace runs are short,
+  /// so the first few characters are checked with the lookup table and only long runs use the vectorized scan.
+  template <size_t (*SimdSkip)(std::string_view, size_t)>
+  inline uint32_t skipCharClassRun(std::string_view input, uint32_t pos, uint8_t charClass)
+  {
+    constexpr uint32_t maxScalarChars = 16;
+
+    const uint32_t size = static_cast<uint32_t>(input.size());
+    const uint32_t scalarEnd = std::min(size, pos + maxScalarChars);
+
+    pos = skipCharClass(input.substr(0, scalarEnd), pos, charClass);
+
+    if (pos == scalarEnd && pos < size)
+      return static_cast<uint32_t>(SimdSkip(input, pos));
+
+    return pos;
   }
 } // namespace
 
 namespace Hydra::Tools
 {
-  Tokenizer::Tokenizer(Hydra::Runtime::ILoggingInterface* logger)
+  Tokenizer::Tokenizer(Hydra::Runtime::ILoggingInterface* logger, Hydra::Runtime::SymbolTable* symbolTable)
     : m_logger(logger)
+    , m_symbolTable(symbolTable)
   {
   }
 
@@ -79,18 +221,20 @@ namespace Hydra::Tools
       return Token::Type::BlockComment;
     }
 
-    if (curChar == ' ' || curChar == '\t')
+    const uint8_t charClass = s_charClasses[static_cast<uint8_t>(curChar)];
+
+    if (charClass & CC_WHITESPACE)
     {
-      ++m_currentPos;
+      m_currentPos = skipCharClassRun<Simd::SkipSpacesAndTabs>(m_currentInput, m_currentPos + 1, CC_WHITESPACE);
       return Token::Type::Unknown;
     }
 
-    if (std::isdigit(curChar))
+    if (charClass & CC_DIGIT)
     {
       return Token::Type::Integer;
     }
 
-    if (!isIdentifierDelimiter(curChar))
+    if (charClass & CC_LETTER)
     {
       return Token::Type::Identifier;
     }
@@ -101,27 +245,29 @@ namespace Hydra::Tools
   Hydra::Tools::Token Tokenizer::HandleIdentifier()
   {
     uint32_t startPos = m_currentPos;
-    ++m_currentPos;
-    char curChar;
-    while (m_currentPos < m_currentInput.size())
+
+    while (true)
     {
-      if (isIdentifierDelimiter(m_currentInput[m_currentPos]))
+      m_currentPos = skipCharClassRun<Simd::SkipIdentifierChars>(m_currentInput, m_currentPos + 1, CC_IDENTIFIER);
+
+      // Check if we have an expression of type <Identifier>::<Identifier>, which we concatenate and treat as a single identifier
+      if ((m_currentPos + 2 < m_currentInput.size()) && m_currentInput[m_currentPos] == ':' && m_currentInput[m_currentPos + 1] == ':' && hasCharClass(m_currentInput[m_currentPos + 2], CC_LETTER))
       {
-        // Check if we have an expression of type <Identifier>::<Identifier>, which we concatenate and treat as a single identifier
-        if (m_currentInput.substr(m_currentPos).starts_with("::") && (m_currentPos + 2 < m_currentInput.size()) && !isIdentifierDelimiter(m_currentInput[m_currentPos + 2]) && !std::isdigit(m_currentInput[m_currentPos + 2]))
-        {
-          m_currentPos += 2;
-        }
-        else
-        {
-          break;
-        }
+        m_currentPos += 2;
       }
+      else
+      {
+        break;
+      }
+    }
 
-      ++m_currentPos;
+    Token result = GetToken(startPos);
+    if (m_symbolTable != nullptr)
+    {
+      result.m_symbol = m_symbolTable->Intern(result.m_token);
     }
 
-    return GetToken(startPos);
+    return result;
   }
 
   Token Tokenizer::HandleNonIdentifierAndNewLine()
@@ -136,6 +282,16 @@ namespace Hydra::Tools
       ++m_currentPos;
       m_currentType = Token::Type::NewLine;
     }
+    else
+    {
+      uint32_t length = 1;
+      Token::Operator op = classifyOperator(m_currentInput, startPos, length);
+
+      m_currentPos += length;
+      Token result = GetToken(startPos);
+      result.m_operator = op;
+      return result;
+    }
 
     ++m_currentPos;
     return GetToken(startPos);
@@ -145,20 +301,13 @@ namespace Hydra::Tools
   {
     uint32_t startPos = m_currentPos;
 
-    if (m_currentInput[startPos] == '0' && (startPos + 2 < m_currentInput.size()) && (m_currentInput[startPos + 1] == 'x' || m_currentInput[startPos + 1] == 'X') && std::isxdigit(m_currentInput[startPos + 2]))
+    if (m_currentInput[startPos] == '0' && (startPos + 2 < m_currentInput.size()) && (m_currentInput[startPos + 1] == 'x' || m_currentInput[startPos + 1] == 'X') && hasCharClass(m_currentInput[startPos + 2], CC_HEX_DIGIT))
     {
-      m_currentPos = startPos + 2;
-      do
-      {
-        ++m_currentPos;
-      } while (m_currentPos < m_currentInput.size() && std::isxdigit(m_currentInput[m_currentPos]));
+      m_currentPos = skipCharClass(m_currentInput, startPos + 3, CC_HEX_DIGIT);
     }
     else
     {
-      do
-      {
-        ++m_currentPos;
-      } while (m_currentPos < m_currentInput.size() && std::isdigit(m_currentInput[m_currentPos]));
+      m_currentPos = skipCharClass(m_currentInput, startPos + 1, CC_DIGIT);
     }
 
     return GetToken(startPos);
@@ -167,15 +316,7 @@ namespace Hydra::Tools
   Hydra::Tools::Token Tokenizer::HandleLineComment()
   {
     uint32_t startPos = m_currentPos;
-    m_currentPos += 2;
-    while (m_currentPos < m_currentInput.size())
-    {
-      if (m_currentInput[m_currentPos] == '\n' || m_currentInput[m_currentPos] == '\r')
-      {
-        break;
-      }
-      ++m_currentPos;
-    }
+    m_currentPos = static_cast<uint32_t>(Simd::FindLineEnd(m_currentInput, startPos + 2));
 
     return GetToken(startPos);
   }
@@ -183,21 +324,17 @@ namespace Hydra::Tools
   Hydra::Tools::Token Tokenizer::HandleBlockComment()
   {
     uint32_t startPos = m_currentPos;
-    m_currentPos += 2;
-    while (m_currentPos + 1 < m_currentInput.size())
+    const size_t endPos = Simd::FindBlockCommentEnd(m_currentInput, startPos + 2);
+    if (endPos < m_currentInput.size())
     {
-      if (m_currentInput[m_currentPos] == '*' && m_currentInput[m_currentPos + 1] == '/')
-      {
-        m_currentPos += 2;
-        return GetToken(startPos);
-      }
-      ++m_currentPos;
+      m_currentPos = static_cast<uint32_t>(endPos + 2);
+      return GetToken(startPos);
     }
 
-    // Consume the last remaining character if necessary
-    m_currentPos = std::min<size_t>(m_currentPos + 1, m_currentInput.size());
+    // Consume everything that is left
+    m_currentPos = static_cast<uint32_t>(m_currentInput.size());
 
-    Hydra::Runtime::Log::Warning(m_logger, "Unclosed block comment: '%s'", std::string(m_currentInput.substr(startPos)).c_str());
+    HYDRA_LOG_WARNING(m_logger, "Unclosed block comment: '%s'", std::string(m_currentInput.substr(startPos)).c_str());
 
     return GetToken(startPos);
   }
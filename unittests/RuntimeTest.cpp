@@ -1,9 +1,16 @@
 #include "RuntimeTest.h"
 
+#include <HydraRuntime/Allocator.h>
+#include <HydraRuntime/AsyncLogger.h>
 #include <HydraRuntime/PermutationManager.h>
+#include <HydraRuntime/Profiler.h>
+#include <HydraRuntime/SymbolTable.h>
 
 #include <string>
+#include <thread>
 #include <type_traits>
+#include <unordered_set>
+#include <vector>
 
 namespace
 {
@@ -351,14 +358,26 @@ MunitResult RuntimeTests::PermutationTest(const MunitParameter params[], void* f
       CheckExpectedVars(usedVarsSet, expectedVars);
     }
 
+    // Only BOOL_A and ENUM have no default value
+    {
+      const Hydra::Runtime::BitSet& requiredMask = usedVarsSet.GetRequiredMask();
+      munit_assert_true(requiredMask.GetBitValue(boolAVar->m_startBitIndex));
+      munit_assert_false(requiredMask.GetBitValue(boolBVar->m_startBitIndex));
+      munit_assert_false(requiredMask.GetBitValue(boolCVar->m_startBitIndex));
+      munit_assert_uint64(requiredMask.GetBitValues(intVar->m_startBitIndex, intVar->m_numBits), ==, 0);
+      munit_assert_uint64(requiredMask.GetBitValues(enumVar->m_startBitIndex, enumVar->m_numBits), ==, (1u << enumVar->m_numBits) - 1);
+    }
+
     // Try to finalize with missing var
     ResetLoggingStats();
+    munit_assert_false(usedVarsSet.HasAllRequiredValues(vars));
     Hydra::Runtime::PermutationVariableSelection selection;
     munit_assert_true(permManager.FinalizeState(vars, usedVarsSet, selection).Failed());
     munit_assert_uint32(s_loggingStats.numErrors, ==, 1);
 
     // Add missing var
     munit_assert_true(vars.SetVariable(*boolAVar, false).Succeeded());
+    munit_assert_true(usedVarsSet.HasAllRequiredValues(vars));
     munit_assert_true(permManager.FinalizeState(vars, usedVarsSet, selection).Succeeded());
 
     {
@@ -476,3 +495,718 @@ MunitResult RuntimeTests::PerformanceTest(const MunitParameter params[], void* f
 
   return MUNIT_OK;
 }
+
+MunitResult RuntimeTests::ConstraintsTest(const MunitParameter params[], void* fixture)
+{
+  std::vector<std::pair<std::string, int>> lightingValues;
+  lightingValues.push_back({"NONE", 0});
+  lightingValues.push_back({"PHONG", 1});
+  lightingValues.push_back({"PBR", 2});
+
+  TestLoggingImpl logger;
+
+  Hydra::Runtime::PermutationManager permManager(&logger);
+
+  auto lightingVar = permManager.RegisterVariable("LIGHTING_MODE", lightingValues);
+  auto normalMapVar = permManager.RegisterVariable("USE_NORMALMAP", true);
+  auto fogVar = permManager.RegisterVariable("USE_FOG");
+  auto wireframeVar = permManager.RegisterVariable("WIREFRAME", false);
+  auto depthOnlyVar = permManager.RegisterVariable("DEPTHONLY", false);
+
+  Hydra::Runtime::PermutationVariableSet usedVarsSet;
+  usedVarsSet.AddVariable(*lightingVar);
+  usedVarsSet.AddVariable(*normalMapVar);
+  usedVarsSet.AddVariable(*fogVar);
+  usedVarsSet.AddVariable(*wireframeVar);
+  usedVarsSet.AddVariable(*depthOnlyVar);
+
+  // 3 * 2 * 2 * 2 * 2 combinations without any constraints
+  munit_assert_uint32(permManager.EnumeratePermutations(usedVarsSet, nullptr), ==, 48);
+
+  // Invalid rules
+  ResetLoggingStats();
+  munit_assert_true(permManager.AddImplication(*lightingVar, 7, *fogVar, 0).Failed());
+  const Hydra::Runtime::PermutationVariableEntry* invalidGroup[] = {wireframeVar, lightingVar};
+  munit_assert_true(permManager.AddMutuallyExclusiveGroup(invalidGroup).Failed());
+  munit_assert_uint32(s_loggingStats.numErrors, ==, 2);
+
+  munit_assert_true(permManager.AddDontCareRule(*normalMapVar, *lightingVar, 0).Succeeded());
+  munit_assert_true(permManager.AddImplication(*depthOnlyVar, 1, *lightingVar, 0).Succeeded());
+  const Hydra::Runtime::PermutationVariableEntry* exclusiveGroup[] = {wireframeVar, depthOnlyVar};
+  munit_assert_true(permManager.AddMutuallyExclusiveGroup(exclusiveGroup).Succeeded());
+
+  // Normal map is irrelevant without lighting
+  {
+    Hydra::Runtime::PermutationVariableState vars;
+    munit_assert_true(vars.SetVariable(*lightingVar, "NONE").Succeeded());
+    munit_assert_true(vars.SetVariable(*normalMapVar, false).Succeeded());
+    munit_assert_true(vars.SetVariable(*fogVar, true).Succeeded());
+
+    Hydra::Runtime::PermutationVariableSelection selection;
+    munit_assert_true(permManager.FinalizeState(vars, usedVarsSet, selection).Succeeded());
+
+    Hydra::Runtime::PermutationVariableState vars2;
+    munit_assert_true(vars2.SetVariable(*lightingVar, "NONE").Succeeded());
+    munit_assert_true(vars2.SetVariable(*fogVar, true).Succeeded());
+
+    Hydra::Runtime::PermutationVariableSelection selection2;
+    munit_assert_true(permManager.FinalizeState(vars2, usedVarsSet, selection2).Succeeded());
+    munit_assert_true(selection == selection2);
+    munit_assert_uint32(selection.Hash(), ==, selection2.Hash());
+
+    ExpectedVar expectedVars[] = {
+      {"LIGHTING_MODE", "NONE", 0},
+      {"USE_NORMALMAP", "TRUE", 1},
+      {"USE_FOG", "TRUE", 1},
+      {"WIREFRAME", "FALSE", 0},
+      {"DEPTHONLY", "FALSE", 0},
+    };
+
+    CheckExpectedVars(selection, expectedVars);
+  }
+
+  // Implications chain into don't-care rules
+  {
+    Hydra::Runtime::PermutationVariableState vars;
+    munit_assert_true(vars.SetVariable(*lightingVar, "PBR").Succeeded());
+    munit_assert_true(vars.SetVariable(*normalMapVar, false).Succeeded());
+    munit_assert_true(vars.SetVariable(*fogVar, false).Succeeded());
+    munit_assert_true(vars.SetVariable(*depthOnlyVar, true).Succeeded());
+
+    Hydra::Runtime::PermutationVariableSelection selection;
+    munit_assert_true(permManager.FinalizeState(vars, usedVarsSet, selection).Succeeded());
+
+    ExpectedVar expectedVars[] = {
+      {"LIGHTING_MODE", "NONE", 0},
+      {"USE_NORMALMAP", "TRUE", 1},
+      {"USE_FOG", "FALSE", 0},
+      {"WIREFRAME", "FALSE", 0},
+      {"DEPTHONLY", "TRUE", 1},
+    };
+
+    CheckExpectedVars(selection, expectedVars);
+
+    // Violating the exclusive group
+    ResetLoggingStats();
+    munit_assert_true(vars.SetVariable(*wireframeVar, true).Succeeded());
+    munit_assert_true(permManager.FinalizeState(vars, usedVarsSet, selection).Failed());
+    munit_assert_uint32(s_loggingStats.numErrors, ==, 1);
+  }
+
+  // Enumeration only reports distinct, valid selections
+  {
+    // LIGHTING_MODE != NONE: 2 * 2 (normal map) * 2 (fog) * 2 (wireframe) = 16
+    // LIGHTING_MODE == NONE, DEPTHONLY == false: 2 (fog) * 2 (wireframe) = 4
+    // DEPTHONLY == true: 2 (fog) = 2
+    ResetLoggingStats();
+    uint32_t numCallbacks = 0;
+    const uint32_t numPermutations = permManager.EnumeratePermutations(usedVarsSet, [&](const Hydra::Runtime::PermutationVariableSelection& selection)
+      { ++numCallbacks; });
+
+    munit_assert_uint32(numPermutations, ==, 22);
+    munit_assert_uint32(numCallbacks, ==, 22);
+    munit_assert_uint32(s_loggingStats.numErrors, ==, 0);
+  }
+
+  return MUNIT_OK;
+}
+
+MunitResult RuntimeTests::StatisticsTest(const MunitParameter params[], void* fixture)
+{
+  TestLoggingImpl logger;
+
+  Hydra::Runtime::PermutationManager permManager(&logger);
+
+  auto fogVar = permManager.RegisterVariable("USE_FOG");
+  auto shadowsVar = permManager.RegisterVariable("USE_SHADOWS", false);
+  auto skinningVar = permManager.RegisterVariable("USE_SKINNING", false);
+
+  Hydra::Runtime::PermutationVariableSet usedVarsSet;
+  usedVarsSet.AddVariable(*fogVar);
+  usedVarsSet.AddVariable(*shadowsVar);
+
+  Hydra::Runtime::PermutationVariableSet otherVarsSet;
+  otherVarsSet.AddVariable(*skinningVar);
+
+  Hydra::Runtime::PermutationVariableState vars;
+  Hydra::Runtime::PermutationVariableSelection selection;
+
+  // Nothing is recorded while disabled
+  munit_assert_false(permManager.IsStatisticsEnabled());
+  munit_assert_true(vars.SetVariable(*fogVar, true).Succeeded());
+  munit_assert_true(permManager.FinalizeState(vars, usedVarsSet, selection).Succeeded());
+  munit_assert_uint64(permManager.GetStatistics().m_numFinalizeCalls, ==, 0);
+  munit_assert_uint64(permManager.GetStatistics().m_numSetVariableCalls, ==, 0);
+
+  permManager.SetStatisticsEnabled(true);
+
+  for (uint32_t i = 0; i < 10; ++i)
+  {
+    munit_assert_true(vars.SetVariable(*shadowsVar, (i % 2) == 0).Succeeded());
+    munit_assert_true(permManager.FinalizeState(vars, usedVarsSet, selection).Succeeded());
+  }
+
+  munit_assert_true(permManager.FinalizeState(vars, otherVarsSet, selection).Succeeded());
+
+  Hydra::Runtime::PermutationVariableState emptyVars;
+  ResetLoggingStats();
+  munit_assert_true(permManager.FinalizeState(emptyVars, usedVarsSet, selection).Failed());
+  munit_assert_true(permManager.FinalizeState(emptyVars, usedVarsSet, selection).Failed());
+  munit_assert_uint32(s_loggingStats.numErrors, ==, 2);
+
+  Hydra::Runtime::PermutationVariableState mergedVars;
+  munit_assert_true(Hydra::Runtime::PermutationVariableState::MergeBontoA(vars, emptyVars, usedVarsSet, mergedVars).Succeeded());
+
+  // Enumeration doesn't count as usage
+  munit_assert_uint32(permManager.EnumeratePermutations(usedVarsSet, nullptr), ==, 4);
+
+  {
+    Hydra::Runtime::PermutationStatistics stats = permManager.GetStatistics();
+    munit_assert_uint64(stats.m_numFinalizeCalls, ==, 13);
+    munit_assert_uint64(stats.m_numFinalizeFailures, ==, 2);
+    munit_assert_uint64(stats.m_numMerges, ==, 1);
+    munit_assert_uint64(stats.m_numSetVariableCalls, ==, 10);
+
+    munit_assert_size(stats.m_missingValueFailures.size(), ==, 1);
+    munit_assert_uint64(stats.m_missingValueFailures["USE_FOG"], ==, 2);
+
+    munit_assert_size(stats.m_setVariableCounts.size(), ==, 1);
+    munit_assert_uint64(stats.m_setVariableCounts["USE_SHADOWS"], ==, 10);
+
+    munit_assert_size(stats.m_sets.size(), ==, 2);
+    for (const auto& set : stats.m_sets)
+    {
+      if (set.m_variableNames == "USE_FOG, USE_SHADOWS")
+      {
+        munit_assert_uint64(set.m_numFinalizeCalls, ==, 10);
+        munit_assert_uint64(set.m_numDistinctSelections, ==, 2);
+      }
+      else
+      {
+        munit_assert_string_equal(set.m_variableNames.c_str(), "USE_SKINNING");
+        munit_assert_uint64(set.m_numFinalizeCalls, ==, 1);
+        munit_assert_uint64(set.m_numDistinctSelections, ==, 1);
+      }
+    }
+
+    ResetLoggingStats();
+    stats.DumpToLog(&logger);
+    munit_assert_uint32(s_loggingStats.numInfos, >, 0);
+  }
+
+  permManager.ResetStatistics();
+  munit_assert_uint64(permManager.GetStatistics().m_numFinalizeCalls, ==, 0);
+  munit_assert_size(permManager.GetStatistics().m_sets.size(), ==, 0);
+
+  return MUNIT_OK;
+}
+
+MunitResult RuntimeTests::AllocatorTest(const MunitParameter params[], void* fixture)
+{
+  // Legacy functions with over-aligned allocations
+  {
+    Hydra::Runtime::Core::SetCustomFunctions(&TestAlloc, &TestDealloc, nullptr);
+
+    void* ptr = Hydra::Runtime::Core::Allocate(100, 256);
+    munit_assert_uint64(reinterpret_cast<uintptr_t>(ptr) % 256, ==, 0);
+    munit_assert_uint64(s_numAllocs, ==, 1);
+    Hydra::Runtime::Core::Deallocate(ptr, 100, 256);
+    munit_assert_uint64(s_numAllocs, ==, 0);
+
+    Hydra::Runtime::Core::SetDefaultFunctions();
+  }
+
+  // Arena allocations and reset
+  {
+    Hydra::Runtime::ArenaAllocator arena(1024);
+
+    void* ptr1 = arena.Allocate(10, 1);
+    void* ptr2 = arena.Allocate(16, 64);
+    munit_assert_not_null(ptr1);
+    munit_assert_uint64(reinterpret_cast<uintptr_t>(ptr2) % 64, ==, 0);
+    munit_assert_size(arena.GetNumReservedBytes(), ==, 1024);
+
+    // doesn't fit into the first chunk
+    void* ptr3 = arena.Allocate(4000, 8);
+    munit_assert_not_null(ptr3);
+    const size_t reservedBytes = arena.GetNumReservedBytes();
+    munit_assert_size(reservedBytes, >, 5000);
+
+    arena.Reset();
+    munit_assert_size(arena.GetNumUsedBytes(), ==, 0);
+
+    // chunks are reused after the reset
+    munit_assert_ptr_equal(arena.Allocate(10, 1), ptr1);
+    munit_assert_not_null(arena.Allocate(4000, 8));
+    munit_assert_size(arena.GetNumReservedBytes(), ==, reservedBytes);
+  }
+
+  // Thread allocator scopes
+  {
+    Hydra::Runtime::Core::SetCustomFunctions(&TestAlloc, &TestDealloc, nullptr);
+
+    Hydra::Runtime::ArenaAllocator arena;
+    munit_assert_uint64(s_numAllocs, ==, 0);
+
+    std::vector<int, Hydra::Runtime::StlAllocator<int>> outerVector;
+
+    {
+      Hydra::Runtime::ScopedThreadAllocator scope(&arena);
+      munit_assert_ptr_equal(Hydra::Runtime::Core::GetAllocator(), &arena);
+
+      Hydra::Runtime::BitSet bitSet;
+      bitSet.SetBitValue(500, true);
+
+      std::vector<int, Hydra::Runtime::StlAllocator<int>> vector;
+      vector.resize(100);
+
+      // containers created outside the scope keep using the allocator they were created with
+      outerVector.resize(100);
+      munit_assert_uint64(s_numAllocs, ==, 2); // arena chunk and outer vector
+    }
+
+    munit_assert_ptr_not_equal(Hydra::Runtime::Core::GetAllocator(), &arena);
+
+    // a set that grew inside the arena scope returns its memory to the arena
+    Hydra::Runtime::BitSet arenaBitSet;
+    {
+      Hydra::Runtime::ScopedThreadAllocator scope(&arena);
+      arenaBitSet.SetBitValue(700, true);
+      arenaBitSet.SetBitValue(100, true);
+    }
+    arenaBitSet.Clear();
+    arenaBitSet.SetBitValue(900, true);
+    munit_assert_true(arenaBitSet.GetBitValue(900));
+
+    outerVector.clear();
+    outerVector.shrink_to_fit();
+    arenaBitSet = Hydra::Runtime::BitSet();
+    munit_assert_uint64(s_numAllocs, ==, 1); // only the arena chunk is left
+
+    Hydra::Runtime::Core::SetDefaultFunctions();
+  }
+
+  return MUNIT_OK;
+}
+
+MunitResult RuntimeTests::MemoryTrackingTest(const MunitParameter params[], void* fixture)
+{
+  using Hydra::Runtime::MemoryTag;
+  using Hydra::Runtime::MemoryTracking;
+
+  const uint64_t bitSetBytes = MemoryTracking::GetStats(MemoryTag::BitSet).m_liveBytes;
+  const uint64_t tableBytes = MemoryTracking::GetStats(MemoryTag::ManagerTables).m_liveBytes;
+  const uint64_t tableAllocations = MemoryTracking::GetStats(MemoryTag::ManagerTables).m_numTotalAllocations;
+
+  MemoryTracking::ResetPeaks();
+
+  {
+    Hydra::Runtime::PermutationManager permManager;
+
+    Hydra::Runtime::PermutationVariableSet usedVarsSet;
+    for (uint32_t i = 0; i < 200; ++i)
+    {
+      const std::string name = "VAR_" + std::to_string(i);
+      usedVarsSet.AddVariable(*permManager.RegisterVariable(name.c_str(), false));
+    }
+
+    munit_assert_uint64(MemoryTracking::GetStats(MemoryTag::ManagerTables).m_liveBytes, >, tableBytes);
+    munit_assert_uint64(MemoryTracking::GetStats(MemoryTag::ManagerTables).m_numTotalAllocations, >, tableAllocations);
+
+    // 200 bits don't fit into the inline block
+    munit_assert_uint64(MemoryTracking::GetStats(MemoryTag::BitSet).m_liveBytes, >, bitSetBytes);
+  }
+
+  // everything was given back, but the peak remains
+  munit_assert_uint64(MemoryTracking::GetStats(MemoryTag::ManagerTables).m_liveBytes, ==, tableBytes);
+  munit_assert_uint64(MemoryTracking::GetStats(MemoryTag::BitSet).m_liveBytes, ==, bitSetBytes);
+  munit_assert_uint64(MemoryTracking::GetStats(MemoryTag::ManagerTables).m_peakBytes, >, tableBytes);
+
+  // explicitly tagged allocations
+  {
+    void* ptr = Hydra::Runtime::Core::Allocate(1000, Hydra::Runtime::Core::DEFAULT_ALIGNMENT, MemoryTag::ShaderLibrary);
+    munit_assert_uint64(MemoryTracking::GetStats(MemoryTag::ShaderLibrary).m_liveBytes, >=, 1000);
+    Hydra::Runtime::Core::Deallocate(ptr, 1000, Hydra::Runtime::Core::DEFAULT_ALIGNMENT, MemoryTag::ShaderLibrary);
+  }
+
+  TestLoggingImpl logger;
+  ResetLoggingStats();
+  MemoryTracking::DumpToLog(&logger);
+  munit_assert_uint32(s_loggingStats.numInfos, ==, (uint32_t)MemoryTag::ENUM_COUNT + 1);
+
+  return MUNIT_OK;
+}
+
+MunitResult RuntimeTests::HashTest(const MunitParameter params[], void* fixture)
+{
+  using Hydra::Runtime::Core;
+
+  uint8_t data[256 + 8];
+  for (uint32_t i = 0; i < sizeof(data); ++i)
+  {
+    data[i] = static_cast<uint8_t>(i * 37 + 11);
+  }
+
+  // every length hits a different code path, all hashes must be distinct
+  std::unordered_set<uint64_t> hashes;
+  for (uint32_t length = 0; length <= 256; ++length)
+  {
+    const uint64_t hash = Core::Hash64(data, length);
+    munit_assert_true(hashes.insert(hash).second);
+
+    munit_assert_uint64(hash, ==, Core::Hash64(data, length));
+    munit_assert_uint64(hash, !=, Core::Hash64(data, length, 1));
+    munit_assert_uint32(Core::Hash(data, length), ==, static_cast<uint32_t>(hash ^ (hash >> 32)));
+
+    // unaligned input gives the same hash as aligned input
+    uint8_t copy[256 + 8];
+    memcpy(copy + 3, data, length);
+    munit_assert_uint64(Core::Hash64(copy + 3, length), ==, hash);
+  }
+
+  // single bit changes affect the hash
+  for (uint32_t bit = 0; bit < 100 * 8; bit += 7)
+  {
+    uint8_t modified[100];
+    memcpy(modified, data, sizeof(modified));
+    modified[bit / 8] ^= static_cast<uint8_t>(1 << (bit % 8));
+    munit_assert_uint64(Core::Hash64(modified, sizeof(modified)), !=, Core::Hash64(data, sizeof(modified)));
+  }
+
+  // the previous hash is still available
+  Core::SetCustomFunctions(nullptr, nullptr, &Core::MurmurHash3);
+  munit_assert_uint32(Core::Hash("Hydra", 5), ==, Core::MurmurHash3("Hydra", 5));
+  Core::SetDefaultFunctions();
+  munit_assert_uint32(Core::Hash("Hydra", 5), ==, Core::DefaultHash("Hydra", 5));
+
+  return MUNIT_OK;
+}
+
+MunitResult RuntimeTests::LogLevelTest(const MunitParameter params[], void* fixture)
+{
+  using Hydra::Runtime::Log;
+  using Hydra::Runtime::LogLevel;
+
+  // the threshold is up to the implementation, the interface itself has no state
+  struct FilteringLogger : public TestLoggingImpl
+  {
+    LogLevel GetLogLevel() const override { return m_logLevel; }
+
+    LogLevel m_logLevel = LogLevel::Info;
+  };
+
+  static_assert(std::is_copy_constructible_v<TestLoggingImpl> && std::is_copy_assignable_v<TestLoggingImpl>);
+
+  FilteringLogger logger;
+  ResetLoggingStats();
+
+  uint32_t numEvaluations = 0;
+  auto countEvaluation = [&]()
+  {
+    ++numEvaluations;
+    return "text";
+  };
+
+  Log::Info(&logger, "info");
+  Log::Warning(&logger, "warning");
+  Log::Error(&logger, "error");
+  HYDRA_LOG_INFO(&logger, "%s", countEvaluation());
+  HYDRA_LOG_WARNING(&logger, "%s", countEvaluation());
+
+#if HYDRA_COMPILE_TIME_LOG_LEVEL == 0
+  munit_assert_uint32(s_loggingStats.numInfos, ==, 2);
+  munit_assert_uint32(s_loggingStats.numWarnings, ==, 2);
+  munit_assert_uint32(numEvaluations, ==, 2);
+#endif
+  munit_assert_uint32(s_loggingStats.numErrors, ==, 1);
+
+  // messages below the threshold are dropped, without evaluating the arguments of the macros
+  ResetLoggingStats();
+  numEvaluations = 0;
+  logger.m_logLevel = LogLevel::Error;
+  munit_assert_false(Log::IsEnabled(&logger, LogLevel::Warning));
+  munit_assert_true(Log::IsEnabled(&logger, LogLevel::Error));
+
+  Log::Info(&logger, "info");
+  Log::Warning(&logger, "warning");
+  Log::Error(&logger, "error");
+  HYDRA_LOG_INFO(&logger, "%s", countEvaluation());
+  HYDRA_LOG_WARNING(&logger, "%s", countEvaluation());
+
+  munit_assert_uint32(s_loggingStats.numInfos, ==, 0);
+  munit_assert_uint32(s_loggingStats.numWarnings, ==, 0);
+  munit_assert_uint32(s_loggingStats.numErrors, ==, 1);
+  munit_assert_uint32(numEvaluations, ==, 0);
+
+  logger.m_logLevel = LogLevel::None;
+  Log::Error(&logger, "error");
+  munit_assert_uint32(s_loggingStats.numErrors, ==, 1);
+
+  munit_assert_false(Log::IsEnabled(nullptr, LogLevel::Error));
+
+  return MUNIT_OK;
+}
+
+MunitResult RuntimeTests::AsyncLoggerTest(const MunitParameter params[], void* fixture)
+{
+  using Hydra::Runtime::Log;
+
+  struct CapturingLogger : public Hydra::Runtime::ILoggingInterface
+  {
+    void LogInfo(const char* message) override { m_messages.push_back(std::string("I:") + message); }
+    void LogWarning(const char* message) override { m_messages.push_back(std::string("W:") + message); }
+    void LogError(const char* message) override { m_messages.push_back(std::string("E:") + message); }
+
+    std::vector<std::string> m_messages;
+  };
+
+  // Deferred formatting gives the same result as printf
+  {
+    CapturingLogger target;
+    Hydra::Runtime::AsyncLogger logger(&target);
+
+    char expected[1024];
+    snprintf(expected, sizeof(expected), "I:%d %5d %-4d| %#x %lld %zu %hhu '%s' %-6s| %c %.2f %e %*d %.*s %% end", 42, -7, 3, 255u, -1234567890123ll, (size_t)77, 300, "text", "ab", 'z', 3.14159, 0.5, 6, 12, 2, "xyz");
+
+    char mutableString[] = "text";
+    Log::Info(&logger, "%d %5d %-4d| %#x %lld %zu %hhu '%s' %-6s| %c %.2f %e %*d %.*s %% end", 42, -7, 3, 255u, -1234567890123ll, (size_t)77, 300, mutableString, "ab", 'z', 3.14159, 0.5, 6, 12, 2, "xyz");
+
+    // strings are copied when the message is queued
+    mutableString[0] = 'X';
+
+    Log::Warning(&logger, "no arguments");
+    logger.LogError("already formatted");
+
+    logger.Flush();
+
+    munit_assert_size(target.m_messages.size(), ==, 3);
+    munit_assert_string_equal(target.m_messages[0].c_str(), expected);
+    munit_assert_string_equal(target.m_messages[1].c_str(), "W:no arguments");
+    munit_assert_string_equal(target.m_messages[2].c_str(), "E:already formatted");
+
+    // arguments that don't fit into a queue entry are formatted right away and truncated
+    const std::string longString(2000, 'a');
+    Log::Info(&logger, "%s", longString.c_str());
+    logger.Flush();
+
+    munit_assert_size(target.m_messages.size(), ==, 4);
+    munit_assert_size(target.m_messages[3].size(), >, 100);
+    munit_assert_size(target.m_messages[3].size(), <, longString.size());
+    munit_assert_uint64(logger.GetNumDroppedMessages(), ==, 0);
+  }
+
+  // Strings with a precision don't need to be null-terminated and only the referenced part is copied
+  {
+    CapturingLogger target;
+    Hydra::Runtime::AsyncLogger logger(&target);
+
+    // a view into a long text, like the conditions of a shader; copying all of the text wouldn't fit into a queue entry,
+    // and formatting right away would truncate the padded message to the size of a queue entry
+    const std::string shaderText = "cond" + std::string(2000, 'x');
+    const std::string_view view(shaderText.data(), 4);
+    Log::Info(&logger, "%.*s|%600d", static_cast<int>(view.size()), view.data(), 7);
+
+    const char unterminated[4] = {'a', 'b', 'c', 'd'};
+    Log::Info(&logger, "%.*s %.2s %.9s %.*s", 3, unterminated, unterminated, "short", -1, "negative");
+    logger.Flush();
+
+    char expected[1024];
+    snprintf(expected, sizeof(expected), "I:cond|%600d", 7);
+
+    munit_assert_size(target.m_messages.size(), ==, 2);
+    munit_assert_string_equal(target.m_messages[0].c_str(), expected);
+    munit_assert_string_equal(target.m_messages[1].c_str(), "I:abc ab short negative");
+  }
+
+  // The level of the target is only read at construction on the calling thread, messages below it aren't queued
+  {
+    struct FilteringTarget : public CapturingLogger
+    {
+      Hydra::Runtime::LogLevel GetLogLevel() const override
+      {
+        if (std::this_thread::get_id() == m_ownerThread)
+        {
+          ++m_numCallsFromOwner;
+        }
+
+        return Hydra::Runtime::LogLevel::Warning;
+      }
+
+      std::thread::id m_ownerThread = std::this_thread::get_id();
+      mutable uint32_t m_numCallsFromOwner = 0;
+    };
+
+    FilteringTarget target;
+    Hydra::Runtime::AsyncLogger logger(&target);
+    munit_assert_uint32(target.m_numCallsFromOwner, ==, 1);
+
+    Log::Info(&logger, "dropped %d", 1);
+    Log::Warning(&logger, "kept %d", 2);
+    logger.Flush();
+
+    munit_assert_uint32(target.m_numCallsFromOwner, ==, 1);
+    munit_assert_size(target.m_messages.size(), ==, 1);
+    munit_assert_string_equal(target.m_messages[0].c_str(), "W:kept 2");
+  }
+
+  // Many producers on a small queue drop messages, but never lose count
+  {
+    CapturingLogger target;
+    constexpr uint32_t numThreads = 4;
+    constexpr uint32_t numMessagesPerThread = 2000;
+
+    uint64_t numDropped = 0;
+    {
+      Hydra::Runtime::AsyncLogger logger(&target, 16);
+
+      std::vector<std::thread> threads;
+      for (uint32_t t = 0; t < numThreads; ++t)
+      {
+        threads.emplace_back([&logger, t]()
+          {
+            for (uint32_t i = 0; i < numMessagesPerThread; ++i)
+            {
+              Log::Info(&logger, "thread %u message %u", t, i);
+            } });
+      }
+
+      for (std::thread& thread : threads)
+      {
+        thread.join();
+      }
+
+      logger.Flush();
+      numDropped = logger.GetNumDroppedMessages();
+    }
+
+    munit_assert_uint64(target.m_messages.size() + numDropped, ==, numThreads * numMessagesPerThread);
+  }
+
+  return MUNIT_OK;
+}
+
+MunitResult RuntimeTests::ProfilerTest(const MunitParameter params[], void* fixture)
+{
+  Hydra::Runtime::PermutationManager permManager;
+  auto fogVar = permManager.RegisterVariable("USE_FOG", false);
+
+  Hydra::Runtime::PermutationVariableSet usedVarsSet;
+  usedVarsSet.AddVariable(*fogVar);
+
+  Hydra::Runtime::PermutationVariableState vars;
+  Hydra::Runtime::PermutationVariableSelection selection;
+
+  Hydra::Runtime::ChromeTraceRecorder recorder;
+
+  // nothing is recorded without a profiler
+  munit_assert_null(Hydra::Runtime::Profiler::GetProfiler());
+  munit_assert_true(permManager.FinalizeState(vars, usedVarsSet, selection).Succeeded());
+  munit_assert_uint32(recorder.GetNumEvents(), ==, 0);
+
+  Hydra::Runtime::Profiler::SetProfiler(&recorder);
+
+  munit_assert_true(permManager.FinalizeState(vars, usedVarsSet, selection).Succeeded());
+
+  {
+    HYDRA_PROFILE_SCOPE("Outer \"scope\"");
+    munit_assert_true(permManager.FinalizeState(vars, usedVarsSet, selection).Succeeded());
+    Hydra::Runtime::Profiler::SetCounter("Counter", 17);
+  }
+
+  std::thread otherThread([&]()
+    { HYDRA_PROFILE_SCOPE("Other thread"); });
+  otherThread.join();
+
+  Hydra::Runtime::Profiler::SetProfiler(nullptr);
+
+  munit_assert_uint32(recorder.GetNumEvents(), ==, 9);
+
+  const std::string json = recorder.ToJson();
+  munit_assert_true(json.starts_with("{\"traceEvents\":["));
+  munit_assert_true(json.find("\"name\":\"FinalizeState\",\"ph\":\"B\"") != std::string::npos);
+  munit_assert_true(json.find("\"name\":\"FinalizeState\",\"ph\":\"E\"") != std::string::npos);
+  munit_assert_true(json.find("\"name\":\"Outer \\\"scope\\\"\"") != std::string::npos);
+  munit_assert_true(json.find("\"args\":{\"value\":17}") != std::string::npos);
+
+  // the other thread gets its own id
+  const std::string mainThread = "\"tid\":" + std::to_string(Hydra::Runtime::Profiler::GetCurrentThreadId());
+  const size_t otherThreadPos = json.find("Other thread");
+  munit_assert_true(otherThreadPos != std::string::npos);
+  munit_assert_true(json.find(mainThread, otherThreadPos) > json.find("\n", otherThreadPos));
+
+  recorder.Clear();
+  munit_assert_uint32(recorder.GetNumEvents(), ==, 0);
+
+  return MUNIT_OK;
+}
+
+MunitResult RuntimeTests::SymbolTableTest(const MunitParameter params[], void* fixture)
+{
+  using namespace Hydra::Runtime;
+
+  SymbolTable symbols;
+
+  // true and false are reserved
+  munit_assert_uint32(symbols.GetNumSymbols(), ==, 2);
+  munit_assert_uint32(symbols.Find("true"), ==, SYMBOL_TRUE);
+  munit_assert_uint32(symbols.Find("false"), ==, SYMBOL_FALSE);
+
+  const SymbolId a = symbols.Intern("A");
+  const SymbolId b = symbols.Intern(std::string("B"));
+  munit_assert_uint32(a, !=, b);
+  munit_assert_uint32(symbols.Intern("A"), ==, a);
+  munit_assert_uint32(symbols.Find("B"), ==, b);
+  munit_assert_uint32(symbols.Find("C"), ==, INVALID_SYMBOL);
+  munit_assert_true(symbols.GetName(a) == "A");
+  munit_assert_true(symbols.GetName(INVALID_SYMBOL).empty());
+
+  // Names stay valid while the table grows
+  std::string_view nameA = symbols.GetName(a);
+
+  // Concurrent interning hands out a single id per name
+  constexpr uint32_t numThreads = 4;
+  constexpr uint32_t numNames = 1000;
+  std::vector<std::vector<SymbolId>> threadSymbols(numThreads);
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < numThreads; ++t)
+  {
+    threads.emplace_back([&, t]()
+      {
+        for (uint32_t i = 0; i < numNames; ++i)
+        {
+          threadSymbols[t].push_back(symbols.Intern("VAR_" + std::to_string(i)));
+        } });
+  }
+  for (std::thread& thread : threads)
+  {
+    thread.join();
+  }
+
+  for (uint32_t t = 1; t < numThreads; ++t)
+  {
+    munit_assert_true(threadSymbols[t] == threadSymbols[0]);
+  }
+  munit_assert_uint32(symbols.GetNumSymbols(), ==, 4 + numNames);
+  munit_assert_true(nameA == "A");
+
+  // Variable names of a manager use its symbol table
+  TestLoggingImpl logger;
+  PermutationManager permManager(&logger, &symbols);
+  std::vector<std::pair<std::string, int>> qualityValues = {{"LOW", 0}, {"HIGH", 1}};
+  const PermutationVariableEntry* boolVar = permManager.RegisterVariable("VAR_7");
+  const PermutationVariableEntry* enumVar = permManager.RegisterVariable("QUALITY", qualityValues);
+
+  munit_assert_uint32(boolVar->m_nameSymbol, ==, threadSymbols[0][7]);
+  munit_assert_ptr_equal(permManager.GetVariableBySymbol(threadSymbols[0][7]), boolVar);
+  munit_assert_ptr_equal(permManager.GetVariableBySymbol(symbols.Find("QUALITY")), enumVar);
+  munit_assert_null(permManager.GetVariableBySymbol(a));
+  munit_assert_size(enumVar->m_qualifiedValueSymbols.size(), ==, 2);
+  munit_assert_uint32(enumVar->m_qualifiedValueSymbols[1], ==, symbols.Find("QUALITY::HIGH"));
+  munit_assert_true(boolVar->m_qualifiedValueSymbols.empty());
+
+  // Managers use the global table by default
+  PermutationManager defaultManager(&logger);
+  munit_assert_ptr_equal(&defaultManager.GetSymbolTable(), &SymbolTable::GetGlobal());
+
+  return MUNIT_OK;
+}
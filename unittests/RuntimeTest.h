@@ -7,11 +7,29 @@ namespace RuntimeTests
   MunitResult BitSetTest(const MunitParameter params[], void* fixture);
   MunitResult PermutationTest(const MunitParameter params[], void* fixture);
   MunitResult PerformanceTest(const MunitParameter params[], void* fixture);
+  MunitResult ConstraintsTest(const MunitParameter params[], void* fixture);
+  MunitResult StatisticsTest(const MunitParameter params[], void* fixture);
+  MunitResult AllocatorTest(const MunitParameter params[], void* fixture);
+  MunitResult MemoryTrackingTest(const MunitParameter params[], void* fixture);
+  MunitResult HashTest(const MunitParameter params[], void* fixture);
+  MunitResult LogLevelTest(const MunitParameter params[], void* fixture);
+  MunitResult AsyncLoggerTest(const MunitParameter params[], void* fixture);
+  MunitResult ProfilerTest(const MunitParameter params[], void* fixture);
+  MunitResult SymbolTableTest(const MunitParameter params[], void* fixture);
 
   static MunitTest tests[] = {
     {.name = "/BitSet", .test = &BitSetTest},
     {.name = "/Permutation", .test = &PermutationTest},
     {.name = "/Performance", .test = &PerformanceTest},
+    {.name = "/Constraints", .test = &ConstraintsTest},
+    {.name = "/Statistics", .test = &StatisticsTest},
+    {.name = "/Allocator", .test = &AllocatorTest},
+    {.name = "/MemoryTracking", .test = &MemoryTrackingTest},
+    {.name = "/Hash", .test = &HashTest},
+    {.name = "/LogLevel", .test = &LogLevelTest},
+    {.name = "/AsyncLogger", .test = &AsyncLoggerTest},
+    {.name = "/Profiler", .test = &ProfilerTest},
+    {.name = "/SymbolTable", .test = &SymbolTableTest},
     {.test = nullptr},
   };
 
@@ -1,11 +1,49 @@
 #include "ToolsTest.h"
 
 #include <HydraRuntime/Logger.h>
+#include <HydraRuntime/PermutationManager.h>
+#include <HydraTools/BddManager.h>
+#include <HydraTools/BitSlicedEvaluator.h>
+#include <HydraTools/CompiledCondition.h>
+#include <HydraTools/ConditionCache.h>
+#include <HydraTools/DerivedVariables.h>
 #include <HydraTools/Evaluator.h>
+#include <HydraTools/PermutableText.h>
 #include <HydraTools/Tokenizer.h>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <optional>
+#include <sstream>
+#include <new>
 #include <span>
+#include <thread>
 
+// Counts all allocations of the test executable, so that tests can check that code paths don't allocate
+static std::atomic<uint64_t> s_numGlobalAllocations = 0;
+
+void* operator new(size_t numBytes)
+{
+  s_numGlobalAllocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(numBytes != 0 ? numBytes : 1))
+    return ptr;
+
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t numBytes) noexcept
+{
+  std::free(ptr);
+}
 
 namespace
 {
@@ -106,6 +144,37 @@ MunitResult ToolsTests::TokenizerTest(const MunitParameter params[], void* fixtu
   tokenizer.Tokenize("A: B: C");
   munit_assert_true(ConfirmTokenTypes(tokenizer, {Type::Identifier, Type::NonIdentifier, Type::Identifier, Type::NonIdentifier, Type::Identifier}));
 
+  // Multi-character operators are a single token
+  {
+    using Operator = Hydra::Tools::Token::Operator;
+
+    tokenizer.Tokenize("A==B&&C<<2 || !D>=0x1 != (E >> F) <= G & H | ~I ^ J = K<L>M%N/O*P-Q+R");
+    const std::vector<Operator> expectedOperators = {
+      Operator::None, Operator::Equal, Operator::None, Operator::LogicalAnd, Operator::None, Operator::ShiftLeft, Operator::None, Operator::LogicalOr,
+      Operator::LogicalNot, Operator::None, Operator::GreaterEqual, Operator::None, Operator::NotEqual, Operator::OpenParenthesis, Operator::None,
+      Operator::ShiftRight, Operator::None, Operator::CloseParenthesis, Operator::LessEqual, Operator::None, Operator::BitAnd, Operator::None,
+      Operator::BitOr, Operator::BitNot, Operator::None, Operator::BitXor, Operator::None, Operator::Assign, Operator::None, Operator::Less,
+      Operator::None, Operator::Greater, Operator::None, Operator::Modulo, Operator::None, Operator::Divide, Operator::None, Operator::Multiply,
+      Operator::None, Operator::Minus, Operator::None, Operator::Plus, Operator::None};
+
+    const Hydra::Tools::TokenStream& tokens = tokenizer.GetResult();
+    munit_assert_size(tokens.size(), ==, expectedOperators.size());
+    for (size_t i = 0; i < tokens.size(); ++i)
+    {
+      munit_assert_true(tokens[i].m_operator == expectedOperators[i]);
+    }
+    munit_assert_true(tokens[1].m_token == "==");
+    munit_assert_true(tokens[3].m_token == "&&");
+
+    // Separated characters don't form an operator
+    tokenizer.Tokenize("A = = B");
+    munit_assert_true(tokenizer.GetResult()[1].m_operator == Operator::Assign);
+    munit_assert_true(tokenizer.GetResult()[2].m_operator == Operator::Assign);
+
+    tokenizer.Tokenize("A:B");
+    munit_assert_true(tokenizer.GetResult()[1].m_operator == Operator::None);
+  }
+
   // No errors so far
   munit_assert_uint32(s_loggingStats.numErrors, ==, 0);
 
@@ -126,6 +195,29 @@ MunitResult ToolsTests::TokenizerTest(const MunitParameter params[], void* fixtu
   munit_assert_true(ConfirmTokenTypes(tokenizer, {Type::BlockComment}));
   munit_assert_uint32(s_loggingStats.numErrors, ==, 0);
 
+  // Long runs, with the terminating character at every position relative to the vectorized scanning
+  for (uint32_t length = 0; length < 80; ++length)
+  {
+    const std::string padding(length, 'a');
+    const std::string spaces(length, ' ');
+
+    std::string input = "/*" + padding + "*/" + spaces + "B" + padding + ":\tC" + padding + "// " + padding + "\r\n";
+    tokenizer.Tokenize(input);
+    munit_assert_true(ConfirmTokenTypes(tokenizer, {Type::BlockComment, Type::Identifier, Type::NonIdentifier, Type::Identifier, Type::LineComment, Type::NewLine}));
+
+    const Hydra::Tools::TokenStream& tokens = tokenizer.GetResult();
+    munit_assert_size(tokens[0].m_token.size(), ==, length + 4);
+    munit_assert_size(tokens[1].m_token.size(), ==, length + 1);
+    munit_assert_size(tokens[4].m_token.size(), ==, length + 3);
+
+    // The closing '*' may not be shared with the opening '/*'
+    input = "/*" + padding + "*";
+    tokenizer.Tokenize(input);
+    munit_assert_true(ConfirmTokenTypes(tokenizer, {Type::BlockComment}));
+    munit_assert_size(tokenizer.GetResult()[0].m_token.size(), ==, input.size());
+  }
+  munit_assert_uint32(s_loggingStats.numErrors, ==, 0);
+
   return MUNIT_OK;
 }
 
@@ -197,8 +289,1690 @@ MunitResult ToolsTests::EvaluatorTest(const MunitParameter params[], void* fixtu
   munit_assert_true(EvaluateAndCheck("(A<B) || (C<D)", 1));
   munit_assert_true(EvaluateAndCheck("(A >= B) && (C > D)", 0));
   munit_assert_true(EvaluateAndCheck("Foo::Bar", 42));
+  munit_assert_true(EvaluateAndCheck("A << 3", 8));
+  munit_assert_true(EvaluateAndCheck("16>>B", 4));
+  munit_assert_true(EvaluateAndCheck("A != B", 1));
+  munit_assert_true(EvaluateAndCheck("A <= B", 1));
+  munit_assert_true(EvaluateAndCheck("A<B<<2", 1));
+  munit_assert_true(EvaluateAndCheck("3 & B | 4", 6));
+  munit_assert_true(EvaluateAndCheck("3 & B && 4", 1));
+  munit_assert_true(EvaluateAndCheck("!A || !!B", 1));
+  munit_assert_true(EvaluateAndCheck("A < < B", std::nullopt));
+  munit_assert_true(EvaluateAndCheck("A = B", std::nullopt));
+
+  // Symbol based lookups
+  {
+    Hydra::Runtime::SymbolTable symbols;
+    Hydra::Tools::Tokenizer tokenizer(&logger, &symbols);
+    tokenizer.Tokenize("Foo::Bar + A * 2 + (true && !false) // comment");
+
+    const Hydra::Tools::TokenStream& tokens = tokenizer.GetResult();
+    munit_assert_uint32(tokens[0].m_symbol, ==, symbols.Find("Foo::Bar"));
+    munit_assert_uint32(tokens[1].m_symbol, ==, Hydra::Runtime::INVALID_SYMBOL);
+    munit_assert_uint32(tokens[2].m_symbol, ==, symbols.Find("A"));
+    munit_assert_uint32(tokens[4].m_symbol, ==, Hydra::Runtime::INVALID_SYMBOL);
+    munit_assert_uint32(tokens[7].m_symbol, ==, Hydra::Runtime::SYMBOL_TRUE);
+
+    SymbolValueTable symbolValues;
+    symbolValues[symbols.Find("Foo::Bar")] = 42;
+    symbolValues[symbols.Find("A")] = 3;
+
+    int value = 0;
+    munit_assert_true(evaluator.EvaluateCondition(tokens, symbolValues, value).Succeeded());
+    munit_assert_int(value, ==, 49);
+
+    symbolValues.erase(symbols.Find("A"));
+    munit_assert_true(evaluator.EvaluateCondition(tokens, symbolValues, value).Failed());
+    munit_assert_true(evaluator.EvaluateCondition(tokens, symbolValues, value, Evaluator::Mode::Lenient).Succeeded());
+    munit_assert_int(value, ==, 43);
+  }
 
   // TODO: Used value evaluation
 
   return MUNIT_OK;
 }
+
+MunitResult ToolsTests::DerivedVariablesTest(const MunitParameter params[], void* fixture)
+{
+  TestLoggingImpl logger;
+
+  std::vector<std::pair<std::string, int>> qualityValues;
+  qualityValues.push_back({"LOW", 0});
+  qualityValues.push_back({"MEDIUM", 1});
+  qualityValues.push_back({"HIGH", 2});
+
+  std::vector<int> sampleValues = {4, 16};
+
+  Hydra::Runtime::PermutationManager permManager(&logger);
+  auto qualityVar = permManager.RegisterVariable("QUALITY", qualityValues, 1);
+  auto ssaoVar = permManager.RegisterVariable("USE_SSAO");
+  auto samplesVar = permManager.RegisterVariable("SHADOW_SAMPLES", sampleValues);
+
+  // Invalid expressions
+  ResetLoggingStats();
+  munit_assert_true(Hydra::Tools::RegisterDerivedVariable(permManager, "USE_SSAO", "UNKNOWN_VAR > 1", &logger).Failed());
+  munit_assert_true(Hydra::Tools::RegisterDerivedVariable(permManager, "USE_SSAO", "QUALITY::ULTRA", &logger).Failed());
+  munit_assert_true(Hydra::Tools::RegisterDerivedVariable(permManager, "USE_SSAO", "(QUALITY", &logger).Failed());
+  munit_assert_true(Hydra::Tools::RegisterDerivedVariable(permManager, "NOT_REGISTERED", "QUALITY", &logger).Failed());
+  munit_assert_uint32(s_loggingStats.numErrors, >=, 4);
+  munit_assert_false(permManager.IsDerivedVariable(*ssaoVar));
+
+  munit_assert_true(Hydra::Tools::RegisterDerivedVariable(permManager, "USE_SSAO", "QUALITY >= QUALITY::MEDIUM", &logger).Succeeded());
+  munit_assert_true(Hydra::Tools::RegisterDerivedVariable(permManager, "SHADOW_SAMPLES", "4 + (QUALITY == QUALITY::HIGH && USE_SSAO) * 12", &logger).Succeeded());
+  munit_assert_true(permManager.IsDerivedVariable(*ssaoVar));
+
+  Hydra::Runtime::PermutationVariableSet usedVarsSet;
+  usedVarsSet.AddVariable(*ssaoVar);
+  usedVarsSet.AddVariable(*samplesVar);
+
+  auto checkDerivedValues = [&](const Hydra::Runtime::PermutationVariableState& state, bool expectedSSAO, int expectedSamples)
+  {
+    Hydra::Runtime::PermutationVariableSelection selection;
+    munit_assert_true(permManager.FinalizeState(state, usedVarsSet, selection).Succeeded());
+
+    selection.Iterate([&](const Hydra::Runtime::PermutationVariableEntry& variable, int valueInt, const char* valueString)
+      {
+        if (&variable == ssaoVar)
+          munit_assert_int(valueInt, ==, expectedSSAO ? 1 : 0);
+        else if (&variable == samplesVar)
+          munit_assert_int(valueInt, ==, expectedSamples);
+        else
+          munit_assert_true(false); });
+  };
+
+  // Inputs come from the default value
+  Hydra::Runtime::PermutationVariableState state;
+  checkDerivedValues(state, true, 4);
+
+  munit_assert_true(state.SetVariable(*qualityVar, "LOW").Succeeded());
+  checkDerivedValues(state, false, 4);
+
+  // Values set for derived variables are overwritten
+  munit_assert_true(state.SetVariable(*qualityVar, "HIGH").Succeeded());
+  munit_assert_true(state.SetVariable(*ssaoVar, false).Succeeded());
+  checkDerivedValues(state, true, 16);
+
+  // Only the inputs are enumerated
+  munit_assert_uint32(permManager.EnumeratePermutations(usedVarsSet, nullptr), ==, 3);
+
+  // Derived variables that a set uses only indirectly are computed, but not added to the selection
+  {
+    Hydra::Runtime::PermutationVariableSet samplesSet;
+    samplesSet.AddVariable(*samplesVar);
+
+    Hydra::Runtime::PermutationVariableSelection selection;
+    munit_assert_true(permManager.FinalizeState(state, samplesSet, selection).Succeeded());
+
+    int value = 0;
+    munit_assert_false(selection.GetVariableValue(*ssaoVar, value));
+    munit_assert_true(selection.GetVariableValue(*samplesVar, value));
+    munit_assert_int(value, ==, 16);
+  }
+
+  // Derived variables that aren't used don't need their inputs
+  auto motionBlurVar = permManager.RegisterVariable("USE_MOTIONBLUR");
+  auto blurSamplesVar = permManager.RegisterVariable("BLUR_SAMPLES", sampleValues);
+  munit_assert_true(Hydra::Tools::RegisterDerivedVariable(permManager, "BLUR_SAMPLES", "4 + USE_MOTIONBLUR * 12", &logger).Succeeded());
+  checkDerivedValues(state, true, 16);
+
+  // Variables that are already inputs can't become derived later on, since they would be computed after the variables that use them
+  ResetLoggingStats();
+  munit_assert_true(Hydra::Tools::RegisterDerivedVariable(permManager, "USE_MOTIONBLUR", "QUALITY == QUALITY::HIGH", &logger).Failed());
+  munit_assert_uint32(s_loggingStats.numErrors, >=, 1);
+  munit_assert_false(permManager.IsDerivedVariable(*motionBlurVar));
+  munit_assert_true(permManager.IsDerivedVariable(*blurSamplesVar));
+  ResetLoggingStats();
+
+  // Sets that were built before one of their variables became derived are rejected instead of requiring a value for it
+  {
+    auto lateVar = permManager.RegisterVariable("LATE_DERIVED");
+
+    Hydra::Runtime::PermutationVariableSet staleSet;
+    staleSet.AddVariable(*lateVar);
+    munit_assert_true(Hydra::Tools::RegisterDerivedVariable(permManager, "LATE_DERIVED", "QUALITY == QUALITY::HIGH", &logger).Succeeded());
+
+    Hydra::Runtime::PermutationVariableSelection selection;
+    munit_assert_true(permManager.FinalizeState(state, staleSet, selection).Failed());
+    munit_assert_uint32(s_loggingStats.numErrors, ==, 1);
+    ResetLoggingStats();
+
+    Hydra::Runtime::PermutationVariableSet rebuiltSet;
+    rebuiltSet.AddVariable(*lateVar);
+    munit_assert_true(permManager.FinalizeState(state, rebuiltSet, selection).Succeeded());
+  }
+
+  return MUNIT_OK;
+}
+
+MunitResult ToolsTests::TokenizerPerformanceTest(const MunitParameter params[], void* fixture)
+{
+  TestLoggingImpl logger;
+  Hydra::Tools::Tokenizer tokenizer(&logger);
+
+  using Type = Hydra::Tools::Token::Type;
+
+  // Synthetic corpus with a known token layout, covering all token types and long whitespace runs
+  const std::string_view block = "  Identifier_1 A::B::C 0x1F 1234\t+ -(         )\n// line comment\n/* block */\r\n";
+  const std::vector<Type> blockTypes = {Type::Identifier, Type::Identifier, Type::Integer, Type::Integer, Type::NonIdentifier, Type::NonIdentifier, Type::NonIdentifier, Type::NonIdentifier, Type::NewLine, Type::LineComment, Type::NewLine, Type::BlockComment, Type::NewLine};
+
+  constexpr uint32_t numBlocks = 20000;
+  std::string syntheticCorpus;
+  syntheticCorpus.reserve(block.size() * numBlocks);
+  for (uint32_t i = 0; i < numBlocks; ++i)
+  {
+    syntheticCorpus += block;
+  }
+
+  tokenizer.Tokenize(syntheticCorpus);
+  {
+    const Hydra::Tools::TokenStream& tokens = tokenizer.GetResult();
+    munit_assert_size(tokens.size(), ==, blockTypes.size() * numBlocks);
+
+    for (size_t i = 0; i < tokens.size(); ++i)
+    {
+      munit_assert_true(tokens[i].m_type == blockTypes[i % blockTypes.size()]);
+    }
+
+    munit_assert_true(tokens[1].m_token == "A::B::C");
+    munit_assert_true(tokens[2].m_token == "0x1F");
+    munit_assert_true(tokens[11].m_token == "/* block */");
+  }
+
+  // Comment heavy corpus, like shader headers with long license and documentation blocks
+  std::string commentCorpus;
+  for (uint32_t i = 0; i < 2000; ++i)
+  {
+    commentCorpus += "/*\n";
+    for (uint32_t line = 0; line < 20; ++line)
+    {
+      commentCorpus += " * Permission is hereby granted, free of charge, to any person obtaining a copy of this software.\n";
+    }
+    commentCorpus += " */\n";
+    commentCorpus += "// Documentation for the following declaration, which is a rather long line comment.\n";
+    commentCorpus += "float4 VeryLongIdentifierName_UsedForSomeSpecificShaderPurpose = float4(0, 0, 0, 1);\n";
+  }
+
+  // Real world corpus from the sample shaders
+  std::string sampleCorpus;
+  for (const auto& entry : std::filesystem::directory_iterator(HYDRA_DIR "/sample/data"))
+  {
+    if (entry.path().extension() != ".hydra")
+      continue;
+
+    std::ifstream file(entry.path(), std::ios::binary);
+    std::stringstream content;
+    content << file.rdbuf();
+    sampleCorpus += content.str();
+    sampleCorpus += "\n";
+  }
+  munit_assert_false(sampleCorpus.empty());
+
+  auto Benchmark = [&](const char* corpusName, const std::string& corpus)
+  {
+    constexpr uint32_t numIterations = 10;
+
+    tokenizer.Tokenize(corpus);
+    const Hydra::Tools::TokenStream referenceTokens = tokenizer.GetResult();
+
+    auto startTime = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < numIterations; ++i)
+    {
+      tokenizer.Tokenize(corpus);
+    }
+    std::chrono::duration<double> duration = std::chrono::steady_clock::now() - startTime;
+
+    // Every run has to produce the exact same token stream
+    const Hydra::Tools::TokenStream& tokens = tokenizer.GetResult();
+    munit_assert_size(tokens.size(), ==, referenceTokens.size());
+    for (size_t i = 0; i < tokens.size(); ++i)
+    {
+      munit_assert_true(tokens[i].m_type == referenceTokens[i].m_type);
+      munit_assert_true(tokens[i].m_token == referenceTokens[i].m_token);
+    }
+
+    const double numMegaBytes = static_cast<double>(corpus.size()) * numIterations / (1024.0 * 1024.0);
+    munit_logf(MUNIT_LOG_INFO, "Tokenizer (%s): %.1f MB/s, %zu tokens per run", corpusName, numMegaBytes / duration.count(), tokens.size());
+  };
+
+  Benchmark("synthetic", syntheticCorpus);
+  Benchmark("comments", commentCorpus);
+  Benchmark("sample", sampleCorpus);
+
+  munit_assert_uint32(s_loggingStats.numErrors, ==, 0);
+
+  return MUNIT_OK;
+}
+
+MunitResult ToolsTests::PermutableTextAllocationsTest(const MunitParameter params[], void* fixture)
+{
+  TestLoggingImpl logger;
+
+  using namespace Hydra::Tools;
+
+  const std::string source =
+    "common\n"
+    "#[if QUALITY == 2 && USE_SSAO]\n"
+    "high quality ssao\n"
+    "#[elif QUALITY > 0 /* some comment */]\n"
+    "medium quality\n"
+    "  #[if (SAMPLES << 1) >= 0x10 || !USE_SSAO]\n"
+    "  many samples\n"
+    "  #[endif]\n"
+    "#[else]\n"
+    "low quality\n"
+    "#[endif]\n"
+    "end\n";
+
+  PermutableText text;
+  munit_assert_true(text.SetText(source).Succeeded());
+
+  std::vector<PermutationVariableValues> permutations;
+  for (int quality = 0; quality < 3; ++quality)
+  {
+    for (int ssao = 0; ssao < 2; ++ssao)
+    {
+      for (int samples : {4, 16})
+      {
+        permutations.push_back({{"QUALITY", quality}, {"USE_SSAO", ssao}, {"SAMPLES", samples}});
+      }
+    }
+  }
+
+  std::string output;
+  munit_assert_true(text.GenerateTextPermutation(permutations[0], output, &logger).Succeeded());
+  munit_assert_string_equal(output.c_str(), "common\nlow quality\nend\n");
+  munit_assert_true(text.GenerateTextPermutation(permutations[11], output, &logger).Succeeded());
+  munit_assert_string_equal(output.c_str(), "common\nhigh quality ssao\nend\n");
+  munit_assert_true(text.GenerateTextPermutation(permutations[4], output, &logger).Succeeded());
+  munit_assert_string_equal(output.c_str(), "common\nmedium quality\n  many samples\nend\n");
+
+  // Warm up the output string and the token storage of the evaluation context
+  for (const PermutationVariableValues& values : permutations)
+  {
+    munit_assert_true(text.GenerateTextPermutation(values, output, &logger).Succeeded());
+  }
+
+  // Once warmed up, generating permutations doesn't allocate at all
+  uint64_t numAllocationsBefore = s_numGlobalAllocations.load();
+  for (uint32_t i = 0; i < 10; ++i)
+  {
+    for (const PermutationVariableValues& values : permutations)
+    {
+      munit_assert_true(text.GenerateTextPermutation(values, output, &logger).Succeeded());
+    }
+  }
+  munit_assert_uint64(s_numGlobalAllocations.load() - numAllocationsBefore, ==, 0);
+
+  // When a new string is returned each time, that is the only allocation
+  numAllocationsBefore = s_numGlobalAllocations.load();
+  for (const PermutationVariableValues& values : permutations)
+  {
+    std::string permutation;
+    permutation.reserve(source.size());
+    munit_assert_true(text.GenerateTextPermutation(values, permutation, &logger).Succeeded());
+  }
+  munit_assert_uint64(s_numGlobalAllocations.load() - numAllocationsBefore, ==, permutations.size());
+
+  // The same holds for evaluating conditions given as text with a caller owned context
+  EvaluationContext context;
+  Evaluator evaluator(&logger, &context);
+  int value = 0;
+  munit_assert_true(evaluator.EvaluateCondition("QUALITY == 2 || (SAMPLES & 4)", permutations[1], value).Succeeded());
+
+  numAllocationsBefore = s_numGlobalAllocations.load();
+  for (const PermutationVariableValues& values : permutations)
+  {
+    munit_assert_true(evaluator.EvaluateCondition("QUALITY == 2 || (SAMPLES & 4)", values, value).Succeeded());
+  }
+  munit_assert_uint64(s_numGlobalAllocations.load() - numAllocationsBefore, ==, 0);
+
+  munit_assert_uint32(s_loggingStats.numErrors, ==, 0);
+
+  return MUNIT_OK;
+}
+
+MunitResult ToolsTests::CompiledConditionTest(const MunitParameter params[], void* fixture)
+{
+  TestLoggingImpl logger;
+
+  using namespace Hydra::Tools;
+
+  const std::vector<std::string_view> conditions = {
+    "true",
+    "false",
+    "0x20 | 1",
+    "-A",
+    "+-+B",
+    "~C & 0xFF",
+    "!A || !!B",
+    "A + B * C - D / 2 % 3",
+    "(A + B) * (C - D)",
+    "A << 4 >> B",
+    "A < B",
+    "A <= B",
+    "A > B",
+    "A >= B",
+    "A == B",
+    "A != B",
+    "A ^ B | C & D",
+    "A && B || C && !D",
+    "(A || B) && (C || D) // comment",
+    "/* comment */ Foo::Bar == 42\n",
+    "A == 1 && (B == 2 || (C == 3 && (D == 4 || (A + B + C + D) == 10)))",
+  };
+
+  std::vector<ValueTable> valueTables = {
+    {{"A", 1}, {"B", 2}, {"C", -3}, {"D", -4}, {"Foo::Bar", 42}},
+    {{"A", 0}, {"B", 0}, {"C", 0}, {"D", 1}, {"Foo::Bar", 0}},
+    {{"A", 7}, {"B", 1}, {"C", 255}, {"D", 3}, {"Foo::Bar", 42}},
+  };
+
+  // Same results as the Evaluator
+  Evaluator evaluator(&logger);
+  for (std::string_view condition : conditions)
+  {
+    CompiledCondition compiled;
+    munit_assert_true(compiled.Compile(condition, &logger).Succeeded());
+
+    for (const ValueTable& values : valueTables)
+    {
+      int expected = 0;
+      int value = 0;
+      munit_assert_true(evaluator.EvaluateCondition(condition, values, expected).Succeeded());
+      munit_assert_true(compiled.Evaluate(values, value).Succeeded());
+      munit_assert_int(value, ==, expected);
+    }
+  }
+  munit_assert_uint32(s_loggingStats.numErrors, ==, 0);
+
+  // Variables are recorded once, in order of use
+  {
+    CompiledCondition compiled;
+    munit_assert_true(compiled.Compile("B || A && B || true", &logger).Succeeded());
+    munit_assert_size(compiled.GetVariableNames().size(), ==, 2);
+    munit_assert_string_equal(compiled.GetVariableNames()[0].c_str(), "B");
+    munit_assert_string_equal(compiled.GetVariableNames()[1].c_str(), "A");
+  }
+
+  // Syntax errors are reported at compile time, with the same number of errors as the Evaluator
+  for (std::string_view condition : {"A +", "(A", "A B", "A < < B", "A = B", ")"})
+  {
+    int value = 0;
+    ResetLoggingStats();
+    munit_assert_true(evaluator.EvaluateCondition(condition, valueTables[0], value).Failed());
+    const uint32_t numEvaluatorErrors = s_loggingStats.numErrors;
+
+    CompiledCondition compiled;
+    ResetLoggingStats();
+    munit_assert_true(compiled.Compile(condition, &logger).Failed());
+    munit_assert_uint32(s_loggingStats.numErrors, ==, numEvaluatorErrors);
+    munit_assert_true(compiled.IsEmpty());
+  }
+
+  // Missing values, empty conditions and division by zero fail at evaluation time
+  {
+    CompiledCondition compiled;
+    int value = 0;
+
+    munit_assert_true(compiled.Compile("A + Unknown", &logger).Succeeded());
+    ResetLoggingStats();
+    munit_assert_true(compiled.Evaluate(valueTables[0], value, Evaluator::Mode::Strict, &logger).Failed());
+    munit_assert_uint32(s_loggingStats.numErrors, ==, 1);
+    munit_assert_true(compiled.Evaluate(valueTables[0], value, Evaluator::Mode::Lenient, &logger).Succeeded());
+    munit_assert_int(value, ==, 1);
+
+    munit_assert_true(compiled.Compile(" // only a comment", &logger).Succeeded());
+    munit_assert_true(compiled.IsEmpty());
+    munit_assert_true(compiled.Evaluate(valueTables[0], value, Evaluator::Mode::Strict, &logger).Failed());
+    munit_assert_true(compiled.Evaluate(valueTables[0], value, Evaluator::Mode::Lenient, &logger).Succeeded());
+    munit_assert_int(value, ==, 0);
+
+    munit_assert_true(compiled.Compile("B / (A - 1)", &logger).Succeeded());
+    ResetLoggingStats();
+    munit_assert_true(compiled.Evaluate(valueTables[0], value, Evaluator::Mode::Strict, &logger).Failed());
+    munit_assert_true(evaluator.EvaluateCondition("B % (A - 1)", valueTables[0], value).Failed());
+    munit_assert_uint32(s_loggingStats.numErrors, ==, 2);
+  }
+
+  // Deeply nested conditions need more than the inline stack
+  {
+    std::string deep;
+    for (int i = 0; i < 40; ++i)
+    {
+      deep += "(1 + ";
+    }
+    deep += "A";
+    for (int i = 0; i < 40; ++i)
+    {
+      deep += ")";
+    }
+
+    CompiledCondition compiled;
+    int value = 0;
+    munit_assert_true(compiled.Compile(deep, &logger).Succeeded());
+    munit_assert_true(compiled.Evaluate(valueTables[0], value).Succeeded());
+    munit_assert_int(value, ==, 41);
+  }
+
+  // PermutableText uses the compiled conditions, and falls back to the Evaluator for ones that don't compile
+  {
+    PermutableText text;
+    munit_assert_true(text.SetText("#[if A > B]\nA\n#[elif A +]\nB\n#[endif]\n").Succeeded());
+
+    std::string output;
+    munit_assert_true(text.GenerateTextPermutation(valueTables[2], output, &logger).Succeeded());
+    munit_assert_string_equal(output.c_str(), "A\n");
+
+    ResetLoggingStats();
+    munit_assert_true(text.GenerateTextPermutation(valueTables[0], output, &logger).Failed());
+    munit_assert_uint32(s_loggingStats.numErrors, >=, 1);
+  }
+
+  return MUNIT_OK;
+}
+
+MunitResult ToolsTests::BoundConditionTest(const MunitParameter params[], void* fixture)
+{
+  TestLoggingImpl logger;
+
+  using namespace Hydra::Tools;
+
+  std::vector<std::pair<std::string, int>> qualityValues = {{"LOW", 0}, {"MEDIUM", 1}, {"HIGH", 5}};
+
+  Hydra::Runtime::PermutationManager permManager(&logger);
+  auto qualityVar = permManager.RegisterVariable("QUALITY", qualityValues);
+  auto ssaoVar = permManager.RegisterVariable("USE_SSAO");
+
+  // Binding against a manager, enum values become constants
+  {
+    ConditionVariableSlots slots(&permManager);
+
+    CompiledCondition first;
+    munit_assert_true(first.Compile("USE_SSAO && QUALITY >= QUALITY::MEDIUM", &logger).Succeeded());
+    CompiledCondition second;
+    munit_assert_true(second.Compile("QUALITY == QUALITY::HIGH", &logger).Succeeded());
+
+    BoundCondition boundFirst;
+    BoundCondition boundSecond;
+    munit_assert_true(first.Bind(slots, boundFirst, &logger).Succeeded());
+    munit_assert_true(second.Bind(slots, boundSecond, &logger).Succeeded());
+
+    // Both conditions share the slots
+    munit_assert_uint32(slots.GetNumSlots(), ==, 2);
+    munit_assert_ptr_equal(slots.GetSlotVariable(slots.FindSlot("USE_SSAO").value()), ssaoVar);
+    munit_assert_ptr_equal(slots.GetSlotVariable(slots.FindSlot("QUALITY").value()), qualityVar);
+    munit_assert_false(slots.FindSlot("QUALITY::HIGH").has_value());
+    munit_assert_uint32(boundFirst.GetNumRequiredSlots(), ==, 2);
+    munit_assert_uint32(boundSecond.GetNumRequiredSlots(), ==, 2);
+
+    for (const auto& instruction : boundFirst.GetInstructions())
+    {
+      munit_assert_true(instruction.m_opCode != CompiledCondition::OpCode::PushVariable);
+    }
+
+    const uint32_t ssaoSlot = slots.FindSlot("USE_SSAO").value();
+    const uint32_t qualitySlot = slots.FindSlot("QUALITY").value();
+
+    for (int quality : {0, 1, 5})
+    {
+      for (int ssao : {0, 1})
+      {
+        int slotValues[2] = {};
+        slotValues[ssaoSlot] = ssao;
+        slotValues[qualitySlot] = quality;
+
+        ValueTable values = {{"USE_SSAO", ssao}, {"QUALITY", quality}, {"QUALITY::MEDIUM", 1}, {"QUALITY::HIGH", 5}};
+
+        int expected = 0;
+        int value = 0;
+        munit_assert_true(first.Evaluate(values, expected).Succeeded());
+        munit_assert_true(boundFirst.Evaluate(slotValues, value).Succeeded());
+        munit_assert_int(value, ==, expected);
+
+        munit_assert_true(second.Evaluate(values, expected).Succeeded());
+        munit_assert_true(boundSecond.Evaluate(slotValues, value).Succeeded());
+        munit_assert_int(value, ==, expected);
+      }
+    }
+
+    // Unknown identifiers and enum values can't be bound
+    CompiledCondition unknown;
+    BoundCondition boundUnknown;
+    ResetLoggingStats();
+    munit_assert_true(unknown.Compile("QUALITY == QUALITY::ULTRA", &logger).Succeeded());
+    munit_assert_true(unknown.Bind(slots, boundUnknown, &logger).Failed());
+    munit_assert_true(unknown.Compile("UNKNOWN_VAR", &logger).Succeeded());
+    munit_assert_true(unknown.Bind(slots, boundUnknown, &logger).Failed());
+    munit_assert_uint32(s_loggingStats.numErrors, ==, 2);
+  }
+
+  // Binding against a variable list of its own
+  {
+    ConditionVariableSlots slots;
+    munit_assert_uint32(slots.AddVariable("B"), ==, 0);
+
+    CompiledCondition condition;
+    munit_assert_true(condition.Compile("A * 10 + B", &logger).Succeeded());
+
+    BoundCondition bound;
+    munit_assert_true(condition.Bind(slots, bound, &logger).Succeeded());
+    munit_assert_uint32(slots.GetNumSlots(), ==, 2);
+    munit_assert_null(slots.GetSlotVariable(0));
+
+    const int slotValues[] = {3, 4};
+    int value = 0;
+    munit_assert_true(bound.Evaluate(slotValues, value).Succeeded());
+    munit_assert_int(value, ==, 43);
+  }
+
+  return MUNIT_OK;
+}
+
+MunitResult ToolsTests::SelectionTextPermutationTest(const MunitParameter params[], void* fixture)
+{
+  TestLoggingImpl logger;
+
+  using namespace Hydra::Tools;
+
+  std::vector<std::pair<std::string, int>> qualityValues = {{"LOW", 0}, {"MEDIUM", 1}, {"HIGH", 7}};
+  int sampleValues[] = {4, 16};
+
+  Hydra::Runtime::PermutationManager permManager(&logger);
+  auto qualityVar = permManager.RegisterVariable("QUALITY", qualityValues);
+  auto ssaoVar = permManager.RegisterVariable("USE_SSAO");
+  auto samplesVar = permManager.RegisterVariable("SAMPLES", std::span<int>(sampleValues));
+  auto unusedVar = permManager.RegisterVariable("UNUSED", false);
+
+  const std::string source =
+    "common\n"
+    "#[if QUALITY == QUALITY::HIGH && USE_SSAO]\n"
+    "high quality ssao\n"
+    "#[elif QUALITY != QUALITY::LOW]\n"
+    "medium quality\n"
+    "  #[if SAMPLES >= 16 || !USE_SSAO]\n"
+    "  many samples\n"
+    "  #[endif]\n"
+    "#[else]\n"
+    "low quality\n"
+    "#[endif]\n"
+    "end\n";
+
+  PermutableText text;
+  munit_assert_true(text.SetText(source).Succeeded());
+
+  ConditionVariableSlots slots(&permManager);
+  std::vector<BoundCondition> conditions;
+  munit_assert_true(text.BindConditions(slots, conditions, &logger).Succeeded());
+  munit_assert_uint32(slots.GetNumSlots(), ==, 3);
+
+  Hydra::Runtime::PermutationVariableSet usedVarsSet;
+  usedVarsSet.AddVariable(*qualityVar);
+  usedVarsSet.AddVariable(*ssaoVar);
+  usedVarsSet.AddVariable(*samplesVar);
+
+  std::vector<Hydra::Runtime::PermutationVariableSelection> selections;
+  munit_assert_uint32(permManager.EnumeratePermutations(usedVarsSet, [&](const Hydra::Runtime::PermutationVariableSelection& selection)
+                        { selections.push_back(selection); }),
+    ==, 12);
+
+  std::vector<int> slotValues(slots.GetNumSlots());
+  std::string expected;
+  std::string output;
+
+  for (const auto& selection : selections)
+  {
+    PermutationVariableValues values = {{"QUALITY::LOW", 0}, {"QUALITY::MEDIUM", 1}, {"QUALITY::HIGH", 7}};
+    selection.Iterate([&](const Hydra::Runtime::PermutationVariableEntry& var, int intValue, const char* value)
+      { values[var.m_name] = intValue; });
+
+    for (uint32_t slot = 0; slot < slots.GetNumSlots(); ++slot)
+    {
+      munit_assert_true(selection.GetVariableValue(*slots.GetSlotVariable(slot), slotValues[slot]));
+      munit_assert_int(slotValues[slot], ==, values[slots.GetSlotName(slot)]);
+    }
+
+    int unusedValue = 0;
+    munit_assert_false(selection.GetVariableValue(*unusedVar, unusedValue));
+
+    munit_assert_true(text.GenerateTextPermutation(values, expected, &logger).Succeeded());
+
+    output.clear();
+    munit_assert_true(text.AppendTextPermutation(conditions, slotValues, output, &logger).Succeeded());
+    munit_assert_string_equal(output.c_str(), expected.c_str());
+  }
+
+  // Decoding values and generating text doesn't allocate, once the output string is large enough
+  uint64_t numAllocationsBefore = s_numGlobalAllocations.load();
+  for (const auto& selection : selections)
+  {
+    for (uint32_t slot = 0; slot < slots.GetNumSlots(); ++slot)
+    {
+      munit_assert_true(selection.GetVariableValue(*slots.GetSlotVariable(slot), slotValues[slot]));
+    }
+
+    output.clear();
+    munit_assert_true(text.AppendTextPermutation(conditions, slotValues, output, &logger).Succeeded());
+  }
+  munit_assert_uint64(s_numGlobalAllocations.load() - numAllocationsBefore, ==, 0);
+
+  // Conditions that were bound for a different text are rejected
+  PermutableText otherText;
+  munit_assert_true(otherText.SetText("#[if USE_SSAO]\nssao\n#[endif]\n").Succeeded());
+  ResetLoggingStats();
+  munit_assert_true(otherText.AppendTextPermutation(conditions, slotValues, output, &logger).Failed());
+  munit_assert_uint32(s_loggingStats.numErrors, ==, 1);
+
+  // Unknown identifiers can't be bound
+  PermutableText unknownText;
+  munit_assert_true(unknownText.SetText("#[if QUALITY == QUALITY::ULTRA]\nultra\n#[endif]\n").Succeeded());
+  munit_assert_true(unknownText.BindConditions(slots, conditions, &logger).Failed());
+
+  return MUNIT_OK;
+}
+
+MunitResult ToolsTests::PartialEvaluationTest(const MunitParameter params[], void* fixture)
+{
+  TestLoggingImpl logger;
+
+  using namespace Hydra::Tools;
+
+  // Folded conditions evaluate to the same values as the original ones
+  {
+    const char* conditions[] = {
+      "A && B",
+      "B && A",
+      "A || B",
+      "!A || (B && C)",
+      "(A + 1) * B - C",
+      "A == 2 || B << A > C",
+      "(A << 40) >> 38",
+      "-~A | B ^ C & 3",
+    };
+
+    for (const char* text : conditions)
+    {
+      CompiledCondition condition;
+      munit_assert_true(condition.Compile(text, &logger).Succeeded());
+
+      for (int a = 0; a < 3; ++a)
+      {
+        CompiledCondition folded = condition;
+        folded.PartiallyEvaluate({{"A", a}});
+
+        for (const std::string& name : folded.GetVariableNames())
+        {
+          munit_assert_string_not_equal(name.c_str(), "A");
+        }
+
+        for (int b = 0; b < 3; ++b)
+        {
+          for (int c = 0; c < 3; ++c)
+          {
+            int expected = 0;
+            int value = 0;
+            munit_assert_true(condition.Evaluate({{"A", a}, {"B", b}, {"C", c}}, expected).Succeeded());
+            munit_assert_true(folded.Evaluate({{"B", b}, {"C", c}}, value).Succeeded());
+            munit_assert_int(value, ==, expected);
+          }
+        }
+      }
+    }
+  }
+
+  // Decided conditions become constants
+  {
+    CompiledCondition condition;
+    munit_assert_true(condition.Compile("USE_FOG && QUALITY >= 2", &logger).Succeeded());
+    munit_assert_false(condition.GetConstantValue().has_value());
+
+    CompiledCondition folded = condition;
+    folded.PartiallyEvaluate({{"USE_FOG", 0}});
+    munit_assert_int(folded.GetConstantValue().value_or(-1), ==, 0);
+    munit_assert_true(folded.GetVariableNames().empty());
+
+    folded = condition;
+    folded.PartiallyEvaluate({{"USE_FOG", 1}});
+    munit_assert_false(folded.GetConstantValue().has_value());
+    munit_assert_size(folded.GetVariableNames().size(), ==, 1);
+
+    folded = condition;
+    folded.PartiallyEvaluate({{"QUALITY", 3}});
+    munit_assert_false(folded.GetConstantValue().has_value());
+    munit_assert_string_equal(folded.GetVariableNames()[0].c_str(), "USE_FOG");
+
+    folded.PartiallyEvaluate({{"USE_FOG", 5}});
+    munit_assert_int(folded.GetConstantValue().value_or(-1), ==, 1);
+
+    // Divisions by zero are kept, so that they are still reported
+    munit_assert_true(condition.Compile("A / B", &logger).Succeeded());
+    condition.PartiallyEvaluate({{"A", 1}, {"B", 0}});
+    munit_assert_false(condition.GetConstantValue().has_value());
+
+    int value = 0;
+    ResetLoggingStats();
+    munit_assert_true(condition.Evaluate({}, value, Evaluator::Mode::Strict, &logger).Failed());
+    munit_assert_uint32(s_loggingStats.numErrors, ==, 1);
+
+    // '&&' and '||' don't drop a left operand that can fail, even if the right one decides the result
+    const char* fallibleConditions[] = {"A / B && 0", "(A / B) || 1", "MISSING && 0"};
+    const ValueTable knownValues = {{"A", 1}, {"B", 0}};
+
+    for (const char* text : fallibleConditions)
+    {
+      CompiledCondition fallible;
+      munit_assert_true(fallible.Compile(text, &logger).Succeeded());
+      fallible.PartiallyEvaluate(knownValues);
+      munit_assert_false(fallible.GetConstantValue().has_value());
+
+      Evaluator evaluator(&logger);
+      munit_assert_true(evaluator.EvaluateCondition(text, knownValues, value).Failed());
+      munit_assert_true(fallible.Evaluate(knownValues, value, Evaluator::Mode::Strict, &logger).Failed());
+    }
+
+    ResetLoggingStats();
+  }
+
+  // Pruning decided branches
+  {
+    const std::string source =
+      "common\n"
+      "#[if USE_MOTIONBLUR]\n"
+      "motion blur\n"
+      "#[elif QUALITY == 2 && USE_SSAO]\n"
+      "high quality ssao\n"
+      "#[elif QUALITY > 0]\n"
+      "medium quality\n"
+      "  #[if !USE_MOTIONBLUR || USE_SSAO]\n"
+      "  no blur\n"
+      "  #[endif]\n"
+      "#[else]\n"
+      "low quality\n"
+      "#[endif]\n"
+      "end\n";
+
+    PermutableText original;
+    munit_assert_true(original.SetText(source).Succeeded());
+
+    PermutableText pruned;
+    munit_assert_true(pruned.SetText(source).Succeeded());
+    munit_assert_true(pruned.PruneDecidedBranches({{"USE_MOTIONBLUR", 0}}, &logger).Succeeded());
+
+    std::vector<std::string> usedVars;
+    munit_assert_true(pruned.DetermineUsedPermutationVariables(usedVars, &logger).Succeeded());
+    munit_assert_size(usedVars.size(), ==, 2);
+    munit_assert_true(std::find(usedVars.begin(), usedVars.end(), "USE_MOTIONBLUR") == usedVars.end());
+
+    std::string expected;
+    std::string output;
+    for (int quality = 0; quality < 3; ++quality)
+    {
+      for (int ssao = 0; ssao < 2; ++ssao)
+      {
+        munit_assert_true(original.GenerateTextPermutation({{"QUALITY", quality}, {"USE_SSAO", ssao}, {"USE_MOTIONBLUR", 0}}, expected, &logger).Succeeded());
+        munit_assert_true(pruned.GenerateTextPermutation({{"QUALITY", quality}, {"USE_SSAO", ssao}}, output, &logger).Succeeded());
+        munit_assert_string_equal(output.c_str(), expected.c_str());
+      }
+    }
+
+    // A branch that is known to be taken becomes unconditional
+    PermutableText decided;
+    munit_assert_true(decided.SetText(source).Succeeded());
+    munit_assert_true(decided.PruneDecidedBranches({{"USE_MOTIONBLUR", 0}, {"QUALITY", 1}}, &logger).Succeeded());
+    munit_assert_true(decided.GenerateTextPermutation({{"USE_SSAO", 0}}, output, &logger).Succeeded());
+    munit_assert_string_equal(output.c_str(), "common\nmedium quality\n  no blur\nend\n");
+
+    usedVars.clear();
+    munit_assert_true(decided.DetermineUsedPermutationVariables(usedVars, &logger).Succeeded());
+    munit_assert_size(usedVars.size(), ==, 0);
+
+    munit_assert_true(decided.PruneDecidedBranches({}, &logger).Succeeded());
+    munit_assert_true(decided.GenerateTextPermutation({}, output, &logger).Succeeded());
+    munit_assert_string_equal(output.c_str(), "common\nmedium quality\n  no blur\nend\n");
+
+    // A decided branch after undecided ones becomes their 'else'
+    PermutableText elseText;
+    munit_assert_true(elseText.SetText(source).Succeeded());
+    munit_assert_true(elseText.PruneDecidedBranches({{"USE_MOTIONBLUR", 0}, {"USE_SSAO", 0}, {"QUALITY", 2}}, &logger).Succeeded());
+    munit_assert_true(elseText.GenerateTextPermutation({}, output, &logger).Succeeded());
+    munit_assert_string_equal(output.c_str(), "common\nmedium quality\n  no blur\nend\n");
+
+    // Malformed structures are left unchanged
+    PermutableText malformed;
+    munit_assert_true(malformed.SetText("#[if A]\na\n#[else]\nb\n", &logger).Failed());
+    ResetLoggingStats();
+    munit_assert_true(malformed.PruneDecidedBranches({{"A", 1}}, &logger).Failed());
+    munit_assert_uint32(s_loggingStats.numErrors, ==, 1);
+  }
+
+  return MUNIT_OK;
+}
+
+MunitResult ToolsTests::ShortCircuitTest(const MunitParameter params[], void* fixture)
+{
+  TestLoggingImpl logger;
+
+  using namespace Hydra::Tools;
+
+  struct TestCase
+  {
+    const char* m_condition;
+    bool m_succeeds;
+    int m_result;
+  };
+
+  // UNSET has no value and B is 0
+  const TestCase testCases[] = {
+    {"1 || UNSET", true, 1},
+    {"0 && UNSET", true, 0},
+    {"A || UNSET", true, 1},
+    {"B && UNSET", true, 0},
+    {"B && 1 / B", true, 0},
+    {"A || 1 % B", true, 1},
+    {"B && (UNSET || UNSET)", true, 0},
+    {"B && UNSET || A", true, 1},
+    {"A || UNSET && UNSET", true, 1},
+    {"(A || UNSET) && (B || A)", true, 1},
+    {"A && 5", true, 1},
+    {"B || 5", true, 1},
+    {"0 || UNSET", false, 0},
+    {"A && UNSET", false, 0},
+    {"B || 1 / B", false, 0},
+    {"UNSET && 0", false, 0},
+    {"1 / B || 1", false, 0},
+    {"A || (", false, 0},
+    {"B && )", false, 0},
+  };
+
+  const ValueTable values = {{"A", 1}, {"B", 0}};
+
+  Evaluator evaluator(&logger);
+  for (const TestCase& testCase : testCases)
+  {
+    int result = -1;
+    ValueList usedValues;
+    munit_assert_int(evaluator.EvaluateCondition(testCase.m_condition, values, result, Evaluator::Mode::Strict, &usedValues).Succeeded(), ==, testCase.m_succeeds);
+
+    CompiledCondition condition;
+    if (condition.Compile(testCase.m_condition, &logger).Failed())
+    {
+      munit_assert_false(testCase.m_succeeds);
+      continue;
+    }
+
+    int compiledResult = -1;
+    munit_assert_int(condition.Evaluate(values, compiledResult, Evaluator::Mode::Strict, &logger).Succeeded(), ==, testCase.m_succeeds);
+
+    // folding the known values keeps every operand that is evaluated and can fail
+    CompiledCondition folded = condition;
+    folded.PartiallyEvaluate(values);
+    int foldedResult = -1;
+    munit_assert_int(folded.Evaluate(values, foldedResult, Evaluator::Mode::Strict, &logger).Succeeded(), ==, testCase.m_succeeds);
+    munit_assert_int(foldedResult, ==, compiledResult);
+
+    ConditionVariableSlots slots;
+    slots.AddVariable("A");
+    slots.AddVariable("B");
+    BoundCondition bound;
+    munit_assert_true(condition.Bind(slots, bound, &logger).Succeeded());
+
+    if (testCase.m_succeeds)
+    {
+      munit_assert_int(result, ==, testCase.m_result);
+      munit_assert_int(compiledResult, ==, testCase.m_result);
+
+      // skipped operands still count as used
+      if (std::string_view(testCase.m_condition).find("UNSET") != std::string_view::npos)
+      {
+        munit_assert_true(usedValues.contains("UNSET"));
+      }
+
+      // the bound condition only short-circuits the same way, if UNSET gets a slot value that doesn't decide anything
+      int slotValues[] = {1, 0, 0};
+      int boundResult = -1;
+      munit_assert_true(bound.Evaluate(std::span<const int>(slotValues, slots.GetNumSlots()), boundResult, &logger).Succeeded());
+      munit_assert_int(boundResult, ==, testCase.m_result);
+    }
+  }
+
+  // Compiled conditions skip the right operand with a jump
+  {
+    CompiledCondition condition;
+    munit_assert_true(condition.Compile("A || B || C", &logger).Succeeded());
+
+    uint32_t numJumps = 0;
+    for (const auto& instruction : condition.GetInstructions())
+    {
+      if (instruction.m_opCode == CompiledCondition::OpCode::JumpIfTrue)
+        ++numJumps;
+    }
+    munit_assert_uint32(numJumps, ==, 2);
+  }
+
+  // Short-circuiting gives the same results as evaluating everything
+  {
+    const char* conditions[] = {
+      "A && B || C",
+      "A || B && C",
+      "!(A && (B || C)) && (C || A)",
+      "(A || B) + (B && C) * 2",
+      "A && B && C || !A && !B",
+      "(A << 2 || B) == (C && 3)",
+    };
+
+    for (size_t conditionIdx = 0; conditionIdx < std::size(conditions); ++conditionIdx)
+    {
+      const char* text = conditions[conditionIdx];
+
+      CompiledCondition condition;
+      munit_assert_true(condition.Compile(text, &logger).Succeeded());
+
+      for (int a = 0; a < 3; ++a)
+      {
+        for (int b = 0; b < 3; ++b)
+        {
+          for (int c = 0; c < 3; ++c)
+          {
+            const ValueTable abc = {{"A", a}, {"B", b}, {"C", c}};
+            const bool av = a != 0, bv = b != 0, cv = c != 0;
+
+            int expected = 0;
+            switch (conditionIdx)
+            {
+              case 0:
+                expected = (av && bv) || cv;
+                break;
+              case 1:
+                expected = av || (bv && cv);
+                break;
+              case 2:
+                expected = !(av && (bv || cv)) && (cv || av);
+                break;
+              case 3:
+                expected = (av || bv) + (bv && cv) * 2;
+                break;
+              case 4:
+                expected = (av && bv && cv) || (!av && !bv);
+                break;
+              case 5:
+                expected = (((a << 2) != 0) || bv) == (cv && true);
+                break;
+            }
+
+            int value = 0;
+            munit_assert_true(evaluator.EvaluateCondition(text, abc, value).Succeeded());
+            munit_assert_int(value, ==, expected);
+            munit_assert_true(condition.Evaluate(abc, value).Succeeded());
+            munit_assert_int(value, ==, expected);
+
+            CompiledCondition folded = condition;
+            folded.PartiallyEvaluate({{"B", b}});
+            munit_assert_true(folded.Evaluate(abc, value).Succeeded());
+            munit_assert_int(value, ==, expected);
+          }
+        }
+      }
+    }
+  }
+
+  return MUNIT_OK;
+}
+
+MunitResult ToolsTests::BitSlicedEvaluationTest(const MunitParameter params[], void* fixture)
+{
+  TestLoggingImpl logger;
+
+  using namespace Hydra::Tools;
+
+  std::vector<std::pair<std::string, int>> qualityValues = {{"LOW", 0}, {"MEDIUM", 1}, {"HIGH", 7}};
+  int sampleValues[] = {-3, 0, 4, 16, 100000};
+
+  Hydra::Runtime::PermutationManager permManager(&logger);
+  permManager.RegisterVariable("QUALITY", qualityValues);
+  permManager.RegisterVariable("USE_SSAO");
+  permManager.RegisterVariable("USE_FOG");
+  permManager.RegisterVariable("SAMPLES", std::span<int>(sampleValues));
+
+  PermutationSpace space;
+  space.AddVariable(*permManager.GetVariable("QUALITY"));
+  space.AddVariable(*permManager.GetVariable("USE_SSAO"));
+  space.AddVariable(*permManager.GetVariable("USE_FOG"));
+  space.AddVariable(*permManager.GetVariable("SAMPLES"));
+  space.AddVariable("OFFSET", {-70000, -1, 0, 1, 2, 31, 1 << 30});
+
+  // 3 * 2 * 2 * 5 * 7, so the last block is only partially used
+  munit_assert_uint64(space.GetNumPermutations(), ==, 420);
+
+  // Every condition has to give the same result for every permutation as the scalar evaluation
+  const char* conditions[] = {
+    "QUALITY == QUALITY::HIGH && USE_SSAO",
+    "QUALITY != QUALITY::LOW || !USE_FOG",
+    "SAMPLES >= 16 || USE_SSAO && !USE_FOG",
+    "SAMPLES + OFFSET > 4",
+    "SAMPLES - OFFSET <= -2",
+    "-SAMPLES < OFFSET",
+    "(SAMPLES & 12) == 4 || (OFFSET | 1) == 3 || (OFFSET ^ SAMPLES) > 100",
+    "~OFFSET < 0",
+    "(OFFSET << 3) > SAMPLES",
+    "(OFFSET >> 2) == 0",
+    "OFFSET >= 0 && OFFSET < 32 && (SAMPLES << OFFSET) > 0",
+    "SAMPLES * OFFSET > 1000",
+    "SAMPLES != 0 && OFFSET / SAMPLES == 0",
+    "SAMPLES == 0 || OFFSET % SAMPLES == 1",
+    "OFFSET * 4",
+    "(OFFSET << 2) && 1",
+    "QUALITY",
+    "1",
+    "0",
+  };
+
+  for (const char* text : conditions)
+  {
+    CompiledCondition condition;
+    munit_assert_true(condition.Compile(text, &logger).Succeeded());
+
+    std::vector<uint64_t> mask;
+    munit_assert_true(space.EvaluateCondition(condition, mask, &logger).Succeeded());
+    munit_assert_size(mask.size(), ==, 7);
+
+    for (uint64_t permutation = 0; permutation < space.GetNumPermutations(); ++permutation)
+    {
+      ValueTable values;
+      space.GetPermutationValues(permutation, values);
+
+      int expected = 0;
+      munit_assert_true(condition.Evaluate(values, expected, Evaluator::Mode::Strict, &logger).Succeeded());
+
+      const bool isSet = (mask[permutation / 64] >> (permutation % 64)) & 1;
+      munit_assert_int(isSet, ==, expected != 0);
+    }
+
+    // the unused lanes of the last block are never set
+    munit_assert_uint64(mask.back() >> (420 % 64), ==, 0);
+  }
+
+  // Errors are only reported for lanes that are evaluated
+  {
+    BitSlicedEvaluator evaluator;
+    int divisors[] = {1, 2, 0, 4};
+    evaluator.SetVariable("D", divisors);
+
+    CompiledCondition condition;
+    munit_assert_true(condition.Compile("8 / D == 4", &logger).Succeeded());
+
+    BitSlicedEvaluator::LaneMask trueLanes = 0;
+    ResetLoggingStats();
+    munit_assert_true(evaluator.Evaluate(condition, trueLanes, 0b1011, &logger).Succeeded());
+    munit_assert_uint64(trueLanes, ==, 0b10);
+
+    munit_assert_true(evaluator.Evaluate(condition, trueLanes, 0b1111, &logger).Failed());
+    munit_assert_int(s_loggingStats.numErrors, ==, 1);
+
+    CompiledCondition unset;
+    munit_assert_true(unset.Compile("D > 0 || UNSET", &logger).Succeeded());
+    munit_assert_true(evaluator.Evaluate(unset, trueLanes, 0b1011, &logger).Succeeded());
+    munit_assert_uint64(trueLanes, ==, 0b1011);
+    munit_assert_true(evaluator.Evaluate(unset, trueLanes, 0b0100, &logger).Failed());
+    munit_assert_int(s_loggingStats.numErrors, ==, 2);
+    ResetLoggingStats();
+  }
+
+  // Compare the speed with evaluating every permutation on its own
+  {
+    CompiledCondition condition;
+    munit_assert_true(condition.Compile("(QUALITY == QUALITY::HIGH || SAMPLES > 4) && USE_SSAO && !USE_FOG && SAMPLES + OFFSET != 6", &logger).Succeeded());
+
+    constexpr uint32_t numRuns = 200;
+    std::vector<uint64_t> mask;
+
+    auto startTime = std::chrono::steady_clock::now();
+    for (uint32_t run = 0; run < numRuns; ++run)
+    {
+      munit_assert_true(space.EvaluateCondition(condition, mask, &logger).Succeeded());
+    }
+    std::chrono::duration<double> bitSlicedDuration = std::chrono::steady_clock::now() - startTime;
+
+    uint64_t numTrue = 0;
+    startTime = std::chrono::steady_clock::now();
+    for (uint32_t run = 0; run < numRuns; ++run)
+    {
+      ValueTable values;
+      for (uint64_t permutation = 0; permutation < space.GetNumPermutations(); ++permutation)
+      {
+        space.GetPermutationValues(permutation, values);
+
+        int result = 0;
+        munit_assert_true(condition.Evaluate(values, result, Evaluator::Mode::Strict, &logger).Succeeded());
+        numTrue += (result != 0) ? 1 : 0;
+      }
+    }
+    std::chrono::duration<double> scalarDuration = std::chrono::steady_clock::now() - startTime;
+
+    uint64_t numSet = 0;
+    for (uint64_t block : mask)
+    {
+      numSet += std::popcount(block);
+    }
+    munit_assert_uint64(numSet * numRuns, ==, numTrue);
+
+    munit_logf(MUNIT_LOG_INFO, "Bit-sliced evaluation: %.2f us, one permutation at a time: %.2f us", bitSlicedDuration.count() * 1e6 / numRuns, scalarDuration.count() * 1e6 / numRuns);
+  }
+
+  return MUNIT_OK;
+}
+
+MunitResult ToolsTests::BddTest(const MunitParameter params[], void* fixture)
+{
+  TestLoggingImpl logger;
+
+  using namespace Hydra::Tools;
+  using Node = BddManager::Node;
+
+  std::vector<std::pair<std::string, int>> qualityValues = {{"LOW", 0}, {"MEDIUM", 1}, {"HIGH", 7}};
+  int sampleValues[] = {-3, 0, 4, 16, 100};
+
+  Hydra::Runtime::PermutationManager permManager(&logger);
+  const Hydra::Runtime::PermutationVariableEntry* variables[] = {
+    permManager.RegisterVariable("QUALITY", qualityValues),
+    permManager.RegisterVariable("USE_SSAO"),
+    permManager.RegisterVariable("USE_FOG"),
+    permManager.RegisterVariable("SAMPLES", std::span<int>(sampleValues)),
+  };
+
+  BddManager bdd;
+
+  Node domain = BddManager::TRUE_NODE;
+  for (auto variable : variables)
+  {
+    domain = bdd.And(domain, bdd.GetDomainConstraint(*variable));
+  }
+
+  // 3 * 2 * 2 * 5 allowed permutations, QUALITY and SAMPLES use 2 and 3 bits
+  munit_assert_double(bdd.SatCount(domain, variables), ==, 60.0);
+  munit_assert_double(bdd.SatCount(BddManager::TRUE_NODE, variables), ==, 128.0);
+
+  // Every condition has to be true for exactly the permutations, for which the compiled condition evaluates to true
+  const char* conditions[] = {
+    "QUALITY == QUALITY::HIGH && USE_SSAO",
+    "QUALITY != QUALITY::LOW || !USE_FOG",
+    "SAMPLES >= 16 || USE_SSAO && !USE_FOG",
+    "SAMPLES + QUALITY > 4",
+    "-SAMPLES < QUALITY * 2",
+    "(SAMPLES & 12) == 4 || (QUALITY | 1) == 3",
+    "(SAMPLES << QUALITY) > 64",
+    "SAMPLES != 0 && QUALITY / SAMPLES == 0",
+    "SAMPLES == 0 || 100 % SAMPLES == 0",
+    "QUALITY - QUALITY",
+    "USE_SSAO || !USE_SSAO || UNSET",
+    "1",
+  };
+
+  for (const char* text : conditions)
+  {
+    CompiledCondition condition;
+    munit_assert_true(condition.Compile(text, &logger).Succeeded());
+
+    Node node = BddManager::FALSE_NODE;
+    munit_assert_true(bdd.ConvertCondition(condition, permManager, node, &logger).Succeeded());
+
+    // the result never contains bit patterns that aren't allowed values of the variables that the condition reads
+    Node usedDomain = BddManager::TRUE_NODE;
+    for (const std::string& name : condition.GetVariableNames())
+    {
+      if (auto variable = permManager.GetVariable(name.c_str()))
+        usedDomain = bdd.And(usedDomain, bdd.GetDomainConstraint(*variable));
+    }
+    munit_assert_uint32(bdd.And(node, bdd.Not(usedDomain)), ==, BddManager::FALSE_NODE);
+
+    uint32_t numTrue = 0;
+    for (uint32_t quality = 0; quality < 3; ++quality)
+    {
+      for (uint32_t ssao = 0; ssao < 2; ++ssao)
+      {
+        for (uint32_t fog = 0; fog < 2; ++fog)
+        {
+          for (uint32_t samples = 0; samples < 5; ++samples)
+          {
+            ValueTable values = {
+              {"QUALITY", qualityValues[quality].second},
+              {"QUALITY::LOW", 0},
+              {"QUALITY::MEDIUM", 1},
+              {"QUALITY::HIGH", 7},
+              {"USE_SSAO", ssao},
+              {"USE_FOG", fog},
+              {"SAMPLES", sampleValues[samples]},
+            };
+
+            int expected = 0;
+            munit_assert_true(condition.Evaluate(values, expected, Evaluator::Mode::Strict, &logger).Succeeded());
+            numTrue += (expected != 0) ? 1 : 0;
+
+            Node restricted = node;
+            restricted = bdd.Restrict(restricted, *variables[0], quality);
+            restricted = bdd.Restrict(restricted, *variables[1], ssao);
+            restricted = bdd.Restrict(restricted, *variables[2], fog);
+            restricted = bdd.Restrict(restricted, *variables[3], samples);
+            munit_assert_uint32(restricted, ==, (expected != 0) ? BddManager::TRUE_NODE : BddManager::FALSE_NODE);
+          }
+        }
+      }
+    }
+
+    munit_assert_double(bdd.SatCount(bdd.And(node, domain), variables), ==, numTrue);
+  }
+
+  // Equivalent conditions give the same node
+  {
+    auto convert = [&](const char* text)
+    {
+      CompiledCondition condition;
+      munit_assert_true(condition.Compile(text, &logger).Succeeded());
+
+      Node node = BddManager::FALSE_NODE;
+      munit_assert_true(bdd.ConvertCondition(condition, permManager, node, &logger).Succeeded());
+      return node;
+    };
+
+    munit_assert_uint32(convert("USE_SSAO && USE_FOG"), ==, convert("!(!USE_FOG || !USE_SSAO)"));
+    munit_assert_uint32(convert("QUALITY > QUALITY::LOW"), ==, convert("QUALITY == 1 || QUALITY == 7"));
+    munit_assert_uint32(convert("SAMPLES * 2 > 10"), ==, convert("SAMPLES >= 16"));
+
+    // always true for the allowed values
+    const Node notNegativeQuality = convert("QUALITY >= 0");
+    munit_assert_uint32(notNegativeQuality, ==, bdd.GetDomainConstraint(*variables[0]));
+
+    // branches that are never taken together
+    const Node high = convert("QUALITY == QUALITY::HIGH");
+    const Node low = convert("QUALITY < 1");
+    munit_assert_uint32(bdd.And(high, low), ==, BddManager::FALSE_NODE);
+    munit_assert_uint32(bdd.Restrict(bdd.Or(high, low), *variables[0], 1), ==, BddManager::FALSE_NODE);
+  }
+
+  // Errors are only reported if they can happen for an allowed permutation
+  {
+    const char* failingConditions[] = {
+      "USE_SSAO && UNSET",
+      "QUALITY / SAMPLES",
+      "USE_SSAO || 1 % (QUALITY - 1)",
+      "QUALITY::ULTRA",
+    };
+
+    for (const char* text : failingConditions)
+    {
+      CompiledCondition condition;
+      munit_assert_true(condition.Compile(text, &logger).Succeeded());
+
+      ResetLoggingStats();
+      Node node = BddManager::FALSE_NODE;
+      munit_assert_true(bdd.ConvertCondition(condition, permManager, node, &logger).Failed());
+      munit_assert_int(s_loggingStats.numErrors, ==, 1);
+    }
+
+    ResetLoggingStats();
+  }
+
+  // Tens of variables are no problem, even though there are far too many permutations to enumerate them
+  {
+    Hydra::Runtime::PermutationManager largeManager(&logger);
+    std::vector<const Hydra::Runtime::PermutationVariableEntry*> largeVariables;
+    std::string text;
+
+    for (uint32_t i = 0; i < 60; ++i)
+    {
+      const std::string name = "FEATURE_" + std::to_string(i);
+      largeVariables.push_back(largeManager.RegisterVariable(name.c_str()));
+
+      if (i % 2 == 0)
+        text += (i == 0 ? "(" : " || (") + name + " && FEATURE_" + std::to_string(i + 1) + ")";
+    }
+
+    CompiledCondition condition;
+    munit_assert_true(condition.Compile(text.c_str(), &logger).Succeeded());
+
+    const uint32_t numNodesBefore = bdd.GetNumNodes();
+    Node node = BddManager::FALSE_NODE;
+    munit_assert_true(bdd.ConvertCondition(condition, largeManager, node, &logger).Succeeded());
+
+    // the BDDs grow linearly with the number of pairs, including all intermediate results
+    munit_assert_uint32(bdd.GetNumNodes() - numNodesBefore, <, 10000);
+
+    // 30 pairs, the condition is false if no pair has both bits set, which is the case for 3 of the 4 values of each pair
+    const double expected = std::ldexp(1.0, 60) - std::pow(3.0, 30);
+    munit_assert_double(bdd.SatCount(node, largeVariables), ==, expected);
+  }
+
+  return MUNIT_OK;
+}
+
+MunitResult ToolsTests::ConditionCacheTest(const MunitParameter params[], void* fixture)
+{
+  TestLoggingImpl logger;
+
+  using namespace Hydra::Tools;
+
+  ConditionCache cache;
+
+  // Texts are normalized and conditions are deduplicated by their program
+  auto condition = cache.GetCondition("A && B");
+  munit_assert_not_null(condition.get());
+  munit_assert_ptr_equal(cache.GetCondition("  A   &&\tB ").get(), condition.get());
+  munit_assert_ptr_equal(cache.GetCondition("(A) && (B)").get(), condition.get());
+  munit_assert_ptr_not_equal(cache.GetCondition("A || B").get(), condition.get());
+  munit_assert_null(cache.GetCondition("A &&").get());
+  munit_assert_size(cache.GetNumConditions(), ==, 2);
+
+  // Texts share the conditions of the cache
+  {
+    PermutableText text1;
+    munit_assert_true(text1.SetText("#[if A && B]\nboth\n#[endif]\n", &logger, &cache).Succeeded());
+
+    PermutableText text2;
+    munit_assert_true(text2.SetText("#[if A&&B]\nalso both\n#[elif C]\nonly C\n#[endif]\n", &logger, &cache).Succeeded());
+
+    for (int c = 0; c < 4; ++c)
+    {
+      for (int a = 0; a < 2; ++a)
+      {
+        const PermutationVariableValues values = {{"A", a}, {"B", 1}, {"C", c}};
+
+        auto result1 = text1.GenerateTextPermutation(values, &logger);
+        auto result2 = text2.GenerateTextPermutation(values, &logger);
+        munit_assert_true(result1.has_value() && result2.has_value());
+        munit_assert_string_equal(result1->c_str(), a ? "both\n" : "");
+        munit_assert_string_equal(result2->c_str(), a ? "also both\n" : (c ? "only C\n" : ""));
+      }
+    }
+
+    munit_assert_size(cache.GetNumConditions(), ==, 3);
+  }
+
+  // Conditions handed in from outside are deduplicated by their program
+  {
+    auto compiled = std::make_shared<CompiledCondition>();
+    munit_assert_true(compiled->Compile("(A) && (B)", &logger).Succeeded());
+    munit_assert_ptr_equal(cache.GetCondition(compiled).get(), cache.GetCondition("A && B").get());
+    munit_assert_size(cache.GetNumConditions(), ==, 3);
+  }
+
+  // Concurrent use from many threads
+  {
+    ConditionCache sharedCache;
+    std::atomic<uint32_t> numWrongResults = 0;
+    std::vector<std::thread> threads;
+
+    for (int threadIdx = 0; threadIdx < 8; ++threadIdx)
+    {
+      threads.emplace_back([&, threadIdx]()
+        {
+          for (int i = 0; i < 200; ++i)
+          {
+            const std::string text = "X + " + std::to_string(i % 10) + " > Y";
+            auto sharedCondition = sharedCache.GetCondition(text);
+
+            const ValueTable values = {{"X", i % 7}, {"Y", threadIdx}};
+            int result = -1;
+            if (sharedCondition->Evaluate(values, result).Failed() || result != ((i % 7 + i % 10 > threadIdx) ? 1 : 0))
+            {
+              numWrongResults.fetch_add(1);
+            }
+          }
+        });
+    }
+
+    for (std::thread& thread : threads)
+    {
+      thread.join();
+    }
+
+    munit_assert_uint32(numWrongResults.load(), ==, 0);
+    munit_assert_size(sharedCache.GetNumConditions(), ==, 10);
+  }
+
+  return MUNIT_OK;
+}
+
+MunitResult ToolsTests::DeadBranchesTest(const MunitParameter params[], void* fixture)
+{
+  TestLoggingImpl logger;
+
+  using namespace Hydra::Tools;
+
+  std::vector<std::pair<std::string, int>> qualityValues = {{"LOW", 0}, {"MEDIUM", 1}, {"HIGH", 7}};
+  int sampleValues[] = {4, 16};
+
+  Hydra::Runtime::PermutationManager permManager(&logger);
+  const Hydra::Runtime::PermutationVariableEntry* qualityVar = permManager.RegisterVariable("QUALITY", qualityValues);
+  const Hydra::Runtime::PermutationVariableEntry* ssaoVar = permManager.RegisterVariable("USE_SSAO");
+  const Hydra::Runtime::PermutationVariableEntry* samplesVar = permManager.RegisterVariable("SAMPLES", std::span<int>(sampleValues));
+
+  const std::string source =
+    "common\n"
+    "#[if QUALITY == 5 && DEBUG]\n"
+    "never\n"
+    "#[endif]\n"
+    "#[if USE_SSAO]\n"
+    "ssao\n"
+    "  #[if !USE_SSAO]\n"
+    "  contradiction\n"
+    "    #[if SAMPLES > 4]\n"
+    "    unreachable\n"
+    "    #[endif]\n"
+    "  #[elif SAMPLES >= 4]\n"
+    "  always samples\n"
+    "  #[endif]\n"
+    "#[elif !USE_SSAO]\n"
+    "no ssao\n"
+    "#[else]\n"
+    "dead else\n"
+    "#[endif]\n"
+    "#[if UNKNOWN]\n"
+    "unknown\n"
+    "#[endif]\n"
+    "#[if SAMPLES == 16 && QUALITY != QUALITY::LOW]\n"
+    "live\n"
+    "#[endif]\n"
+    "end\n";
+
+  PermutableText original;
+  munit_assert_true(original.SetText(source).Succeeded());
+
+  PermutableText text;
+  munit_assert_true(text.SetText(source).Succeeded());
+
+  BddManager bdd;
+  const BddManager::Node validPermutations = bdd.And(bdd.And(bdd.GetDomainConstraint(*qualityVar), bdd.GetDomainConstraint(*ssaoVar)), bdd.GetDomainConstraint(*samplesVar));
+
+  std::vector<BranchLiveness> liveness;
+  munit_assert_true(text.ClassifyBranches(bdd, permManager, validPermutations, liveness).Succeeded());
+
+  auto countLiveness = [&](BranchLiveness value)
+  {
+    return std::count(liveness.begin(), liveness.end(), value);
+  };
+
+  // 'QUALITY == 5 && DEBUG', '!USE_SSAO' and the #[else] are never taken, 'SAMPLES >= 4' and '!USE_SSAO' always
+  munit_assert_int(countLiveness(BranchLiveness::NeverTaken), ==, 3);
+  munit_assert_int(countLiveness(BranchLiveness::AlwaysTaken), ==, 2);
+  munit_assert_int(countLiveness(BranchLiveness::Unreachable), ==, 1);
+
+  ResetLoggingStats();
+  munit_assert_true(text.RemoveDeadBranches(liveness, &logger).Succeeded());
+  munit_assert_int(s_loggingStats.numWarnings, ==, 5);
+  munit_assert_int(s_loggingStats.numErrors, ==, 0);
+  ResetLoggingStats();
+
+  // all allowed permutations still generate the same text
+  for (const auto& quality : qualityValues)
+  {
+    for (int ssao = 0; ssao < 2; ++ssao)
+    {
+      for (int samples : sampleValues)
+      {
+        for (int unknown = 0; unknown < 2; ++unknown)
+        {
+          const PermutationVariableValues values = {{"QUALITY", quality.second}, {"QUALITY::LOW", 0}, {"USE_SSAO", ssao}, {"SAMPLES", samples}, {"UNKNOWN", unknown}};
+
+          auto expected = original.GenerateTextPermutation(values, &logger);
+          auto result = text.GenerateTextPermutation(values, &logger);
+          munit_assert_true(expected.has_value() && result.has_value());
+          munit_assert_string_equal(result->c_str(), expected->c_str());
+        }
+      }
+    }
+  }
+
+  // DEBUG was only read by a branch that is never taken
+  {
+    std::vector<std::string> originalUsedVariables;
+    munit_assert_true(original.DetermineUsedPermutationVariables(originalUsedVariables, &logger).Succeeded());
+    munit_assert_size(originalUsedVariables.size(), ==, 6);
+
+    const PermutationVariableValues values = {{"QUALITY", 7}, {"QUALITY::LOW", 0}, {"USE_SSAO", 1}, {"SAMPLES", 16}, {"UNKNOWN", 0}};
+    auto result = text.GenerateTextPermutation(values, &logger);
+    munit_assert_true(result.has_value());
+    munit_assert_string_equal(result->c_str(), "common\nssao\n  always samples\nlive\nend\n");
+
+    std::vector<std::string> usedVariables;
+    munit_assert_true(text.DetermineUsedPermutationVariables(usedVariables, &logger).Succeeded());
+    munit_assert_size(usedVariables.size(), ==, 5);
+  }
+
+  // Fixed values decide branches as well
+  {
+    PermutableText fixedText;
+    munit_assert_true(fixedText.SetText(source).Succeeded());
+
+    uint32_t encodedHigh = 0;
+    munit_assert_true(qualityVar->GetEncodedValue(7, encodedHigh).Succeeded());
+    const BddManager::Node highQuality = bdd.And(validPermutations, bdd.GetValueCondition(*qualityVar, encodedHigh));
+
+    munit_assert_true(fixedText.ClassifyBranches(bdd, permManager, highQuality, liveness).Succeeded());
+
+    // 'SAMPLES == 16 && QUALITY != QUALITY::LOW' is still live, since SAMPLES isn't fixed
+    munit_assert_int(countLiveness(BranchLiveness::NeverTaken), ==, 3);
+    munit_assert_int(countLiveness(BranchLiveness::AlwaysTaken), ==, 2);
+
+    munit_assert_true(fixedText.ClassifyBranches(bdd, permManager, bdd.And(highQuality, bdd.GetValueCondition(*samplesVar, 1)), liveness).Succeeded());
+    munit_assert_int(countLiveness(BranchLiveness::AlwaysTaken), ==, 3);
+  }
+
+  // Malformed texts can't be classified
+  {
+    PermutableText malformed;
+    munit_assert_true(malformed.SetText("#[if USE_SSAO]\na\n#[else]\nb\n", &logger).Failed());
+    munit_assert_true(malformed.ClassifyBranches(bdd, permManager, validPermutations, liveness).Failed());
+  }
+
+  return MUNIT_OK;
+}
+
+MunitResult ToolsTests::PermutableTextStructureTest(const MunitParameter params[], void* fixture)
+{
+  TestLoggingImpl logger;
+
+  using namespace Hydra::Tools;
+
+  // Nested branches are walked through their jump targets
+  {
+    const std::string source =
+      "begin\n"
+      "#[if A == 0]\n"
+      "a0\n"
+      "  #[if B]\n"
+      "  a0 b\n"
+      "  #[else]\n"
+      "  a0 !b\n"
+      "  #[endif]\n"
+      "#[elif A == 1]\n"
+      "a1\n"
+      "#[elif A == 2]\n"
+      "  #[if B]\n"
+      "  a2 b\n"
+      "  #[endif]\n"
+      "#[endif]\n"
+      "#[if B]\n"
+      "b\n"
+      "#[endif]\n"
+      "end\n";
+
+    PermutableText text;
+    munit_assert_true(text.SetText(source, &logger).Succeeded());
+
+    const char* expected[4][2] = {
+      {"begin\na0\n  a0 !b\nend\n", "begin\na0\n  a0 b\nb\nend\n"},
+      {"begin\na1\nend\n", "begin\na1\nb\nend\n"},
+      {"begin\nend\n", "begin\n  a2 b\nb\nend\n"},
+      {"begin\nend\n", "begin\nb\nend\n"},
+    };
+
+    std::string output;
+    for (int a = 0; a < 4; ++a)
+    {
+      for (int b = 0; b < 2; ++b)
+      {
+        munit_assert_true(text.GenerateTextPermutation({{"A", a}, {"B", b}}, output, &logger).Succeeded());
+        munit_assert_string_equal(output.c_str(), expected[a][b]);
+      }
+    }
+
+    // after pruning, the jump targets are set up again
+    munit_assert_true(text.PruneDecidedBranches({{"A", 2}}, &logger).Succeeded());
+    munit_assert_true(text.GenerateTextPermutation({{"B", 1}}, output, &logger).Succeeded());
+    munit_assert_string_equal(output.c_str(), "begin\n  a2 b\nb\nend\n");
+  }
+
+  // Whitespace around keywords is allowed
+  {
+    PermutableText text;
+    munit_assert_true(text.SetText("#[ if\tA ]\na\n#[ else ]\nb\n#[endif   ]\n", &logger).Succeeded());
+
+    std::string output;
+    munit_assert_true(text.GenerateTextPermutation({{"A", 0}}, output, &logger).Succeeded());
+    munit_assert_string_equal(output.c_str(), "b\n");
+  }
+
+  // The condition may directly follow the keyword
+  {
+    PermutableText text;
+    munit_assert_true(text.SetText("#[if(A)]\na\n#[elif(B)]\nb\n#[endif]\n#[if!A]\nnot a\n#[endif]\n", &logger).Succeeded());
+
+    std::string output;
+    munit_assert_true(text.GenerateTextPermutation({{"A", 1}, {"B", 0}}, output, &logger).Succeeded());
+    munit_assert_string_equal(output.c_str(), "a\n");
+    munit_assert_true(text.GenerateTextPermutation({{"A", 0}, {"B", 1}}, output, &logger).Succeeded());
+    munit_assert_string_equal(output.c_str(), "b\nnot a\n");
+  }
+
+  // Malformed texts are rejected once by SetText(), and generating them fails instead of producing wrong text
+  {
+    const char* malformedSources[] = {
+      "#[if A\na\n#[endif]\n",
+      "a\n#[endif]\nb\n",
+      "#[else]\na\n",
+      "#[if A]\na\n#[else]\nb\n#[elif B]\nc\n#[endif]\n",
+      "#[if A]\na\n#[if B]\nb\n#[endif]\n",
+      "#[if A]\na\n#[elseif B]\nb\n#[endif]\n",
+      "a\n#[foo bar]\nb\n",
+      "#[ifdef A]\na\n#[endif]\n",
+      "#[if A]\na\n#[endif A == 2]\n",
+      "#[if A]\na\n#[else x]\nb\n#[endif]\n",
+      "#[if A]\na\n#[else(x)]\nb\n#[endif]\n",
+    };
+
+    for (const char* source : malformedSources)
+    {
+      PermutableText text;
+
+      ResetLoggingStats();
+      munit_assert_true(text.SetText(source, &logger).Failed());
+      munit_assert_int(s_loggingStats.numErrors, ==, 1);
+      munit_assert_true(text.GetOriginalText() == source);
+
+      std::string output;
+      munit_assert_true(text.GenerateTextPermutation({{"A", 1}, {"B", 1}}, output, &logger).Failed());
+    }
+
+    ResetLoggingStats();
+  }
+
+  return MUNIT_OK;
+}
@@ -6,10 +6,36 @@ namespace ToolsTests
 {
   MunitResult TokenizerTest(const MunitParameter params[], void* fixture);
   MunitResult EvaluatorTest(const MunitParameter params[], void* fixture);
+  MunitResult DerivedVariablesTest(const MunitParameter params[], void* fixture);
+  MunitResult TokenizerPerformanceTest(const MunitParameter params[], void* fixture);
+  MunitResult PermutableTextAllocationsTest(const MunitParameter params[], void* fixture);
+  MunitResult CompiledConditionTest(const MunitParameter params[], void* fixture);
+  MunitResult BoundConditionTest(const MunitParameter params[], void* fixture);
+  MunitResult SelectionTextPermutationTest(const MunitParameter params[], void* fixture);
+  MunitResult PartialEvaluationTest(const MunitParameter params[], void* fixture);
+  MunitResult ShortCircuitTest(const MunitParameter params[], void* fixture);
+  MunitResult BitSlicedEvaluationTest(const MunitParameter params[], void* fixture);
+  MunitResult BddTest(const MunitParameter params[], void* fixture);
+  MunitResult ConditionCacheTest(const MunitParameter params[], void* fixture);
+  MunitResult DeadBranchesTest(const MunitParameter params[], void* fixture);
+  MunitResult PermutableTextStructureTest(const MunitParameter params[], void* fixture);
 
   static MunitTest tests[] = {
     {.name = "/Tokenizer", .test = &TokenizerTest},
     {.name = "/Evaluator", .test = &EvaluatorTest},
+    {.name = "/DerivedVariables", .test = &DerivedVariablesTest},
+    {.name = "/TokenizerPerformance", .test = &TokenizerPerformanceTest},
+    {.name = "/PermutableTextAllocations", .test = &PermutableTextAllocationsTest},
+    {.name = "/CompiledCondition", .test = &CompiledConditionTest},
+    {.name = "/BoundCondition", .test = &BoundConditionTest},
+    {.name = "/SelectionTextPermutation", .test = &SelectionTextPermutationTest},
+    {.name = "/PartialEvaluation", .test = &PartialEvaluationTest},
+    {.name = "/ShortCircuit", .test = &ShortCircuitTest},
+    {.name = "/BitSlicedEvaluation", .test = &BitSlicedEvaluationTest},
+    {.name = "/Bdd", .test = &BddTest},
+    {.name = "/ConditionCache", .test = &ConditionCacheTest},
+    {.name = "/DeadBranches", .test = &DeadBranchesTest},
+    {.name = "/PermutableTextStructure", .test = &PermutableTextStructureTest},
     {.test = nullptr},
   };
 